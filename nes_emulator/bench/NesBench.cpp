@@ -0,0 +1,478 @@
+/*
+Description:
+	Microbenchmarks for the cpu core, the rom loader and the disassembler.
+
+	usage: nes_bench [--quick] [--out <file.json>] [--commit <id>]
+
+	- cpu:          synthetic opcode mixes (alu, branch heavy, memory heavy, read-modify-write)
+	                looping in a rom bank, reported as instructions per second and emulated MHz
+	- rom_load:     NesCartridge::LoadFromFile on generated .nes files of several sizes
+	- disassemble:  Mos6502CPU::PrintProgram to the null device, in rom bytes per second
+	- apu:          all five channels playing, frames of apu emulation plus 48kHz synthesis, as
+	                time per frame and as a share of a real time (60Hz) frame
+	- blip:         BlipBuffer synthesis of a frame with many deltas for each instruction set,
+	                with the largest sample difference from the scalar reference
+
+	every benchmark is run several times and the fastest run is reported. Results are printed
+	and written as JSON so they can be compared between commits.
+*/
+
+#include "Mos6502CPU.h"
+#include "NesApu.h"
+#include "NesRom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	static const char *NullDevice = "NUL";
+#else
+	static const char *NullDevice = "/dev/null";
+#endif
+
+struct BenchMetric
+{
+	const char	*name;
+	double		 value;
+};
+
+struct BenchResult
+{
+	std::string					name;
+	std::vector<BenchMetric>	metrics;
+};
+
+static std::vector<BenchResult> s_results;
+
+static void AddResult(const std::string &name, std::initializer_list<BenchMetric> metrics)
+{
+	BenchResult result;
+	result.name = name;
+	result.metrics = metrics;
+	s_results.push_back(result);
+
+	printf("%-24s", name.c_str());
+	for (const BenchMetric &metric : metrics)
+		printf("  %s %.4g", metric.name, metric.value);
+	printf("\n");
+}
+
+// seconds taken by the fastest of 'runs' calls to 'function'
+template<typename Function>
+static double BestSeconds(int runs, Function function)
+{
+	double best = 1e30;
+	for (int i = 0; i < runs; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (seconds < best)
+			best = seconds;
+	}
+	return best;
+}
+
+//=============================================================================
+// CPU
+//=============================================================================
+struct CpuMix
+{
+	const char		*name;
+	const uint8_t	*code;
+	uint32_t		 size;
+};
+
+// each mix is assembled at $8000 and loops forever
+static const uint8_t s_aluMix[] =
+{
+	0xA9, 0x35,			// LDA #$35
+	0x69, 0x17,			// ADC #$17
+	0x29, 0xF0,			// AND #$F0
+	0x09, 0x0F,			// ORA #$0F
+	0x49, 0xAA,			// EOR #$AA
+	0xC9, 0x40,			// CMP #$40
+	0x0A,				// ASL A
+	0x6A,				// ROR A
+	0xE8,				// INX
+	0x88,				// DEY
+	0x18,				// CLC
+	0xE9, 0x01,			// SBC #$01
+	0xAA,				// TAX
+	0x98,				// TYA
+	0x4C, 0x00, 0x80,	// JMP $8000
+};
+
+static const uint8_t s_branchMix[] =
+{
+	0xA2, 0x10,			// $8000  LDX #$10
+	0xCA,				// $8002  DEX
+	0xF0, 0x02,			// $8003  BEQ $8007
+	0xD0, 0xFB,			// $8005  BNE $8002
+	0x30, 0x00,			// $8007  BMI $8009 (not taken)
+	0x10, 0x00,			// $8009  BPL $800B
+	0x4C, 0x00, 0x80,	// $800B  JMP $8000
+};
+
+static const uint8_t s_memoryMix[] =
+{
+	0xA9, 0x00,			// $8000  LDA #$00
+	0x85, 0x20,			// $8002  STA $20
+	0xA9, 0x03,			// $8004  LDA #$03
+	0x85, 0x21,			// $8006  STA $21
+	0xA5, 0x10,			// $8008  LDA $10
+	0x9D, 0x00, 0x02,	// $800A  STA $0200,X
+	0xB1, 0x20,			// $800D  LDA ($20),Y
+	0x95, 0x30,			// $800F  STA $30,X
+	0xB9, 0x00, 0x03,	// $8011  LDA $0300,Y
+	0x85, 0x11,			// $8014  STA $11
+	0xBD, 0x00, 0x02,	// $8016  LDA $0200,X
+	0x91, 0x20,			// $8019  STA ($20),Y
+	0xE8,				// $801B  INX
+	0xC8,				// $801C  INY
+	0x4C, 0x08, 0x80,	// $801D  JMP $8008
+};
+
+static const uint8_t s_rmwMix[] =
+{
+	0xE6, 0x10,			// INC $10
+	0xDE, 0x00, 0x02,	// DEC $0200,X
+	0x06, 0x11,			// ASL $11
+	0x6E, 0x00, 0x03,	// ROR $0300
+	0x56, 0x12,			// LSR $12,X
+	0x2E, 0x01, 0x03,	// ROL $0301
+	0xFE, 0x00, 0x04,	// INC $0400,X
+	0xE8,				// INX
+	0x4C, 0x00, 0x80,	// JMP $8000
+};
+
+static void BenchCpu(uint64_t numInstructions, int runs)
+{
+	static const CpuMix mixes[] =
+	{
+		{ "cpu_alu", s_aluMix, sizeof(s_aluMix) },
+		{ "cpu_branch", s_branchMix, sizeof(s_branchMix) },
+		{ "cpu_memory", s_memoryMix, sizeof(s_memoryMix) },
+		{ "cpu_rmw", s_rmwMix, sizeof(s_rmwMix) },
+	};
+
+	RomBankMem *bank = new RomBankMem;
+	Mos6502CPU *cpu = new Mos6502CPU;
+
+	for (const CpuMix &mix : mixes)
+	{
+		// a single bank shows at both $8000 and $C000, all vectors point at the mix
+		memset(bank->data, 0xEA, sizeof(bank->data));
+		memcpy(bank->data, mix.code, mix.size);
+		for (uint32_t vector = 0x3FFA; vector < 0x4000; vector += 2)
+		{
+			bank->data[vector] = 0x00;
+			bank->data[vector + 1] = 0x80;
+		}
+
+		cpu->SetRomData(bank, 1);
+
+		uint64_t cycles = 0;
+		double seconds = BestSeconds(runs, [&]()
+		{
+			cpu->Reset();
+			uint64_t firstCycle = cpu->GetCycles();
+			for (uint64_t i = 0; i < numInstructions; i++)
+				cpu->Tick();
+			cycles = cpu->GetCycles() - firstCycle;
+		});
+
+		AddResult(mix.name, {
+			{ "instructions_per_sec", numInstructions / seconds },
+			{ "emulated_mhz", cycles / seconds / 1000000.0 },
+			{ "seconds", seconds },
+		});
+	}
+
+	delete cpu;
+	delete bank;
+}
+
+//=============================================================================
+// ROM loader
+//=============================================================================
+static void FillPseudoRandom(uint8_t *data, size_t size, uint32_t seed)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		data[i] = (uint8_t)(seed >> 24);
+	}
+}
+
+static bool WriteTestRom(const char *filename, uint8_t numRomBanks, uint8_t numVRomBanks)
+{
+	NesRomFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.ext, "NES\x1A", 4);
+	header.num16kbRomBanks = numRomBanks;
+	header.num8kbVRomBanks = numVRomBanks;
+
+	std::vector<uint8_t> banks((size_t)numRomBanks * sizeof(RomBankMem) + (size_t)numVRomBanks * sizeof(VRomBankMem));
+	FillPseudoRandom(banks.data(), banks.size(), numRomBanks);
+
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(banks.data(), 1, banks.size(), file) == banks.size();
+	return fclose(file) == 0 && ok;
+}
+
+static void BenchRomLoad(int iterations, int runs)
+{
+	struct RomSize { uint8_t romBanks, vromBanks; };
+	static const RomSize sizes[] = { { 2, 1 }, { 16, 16 }, { 32, 64 }, { 128, 128 } };
+
+	for (const RomSize &size : sizes)
+	{
+		const char *filename = "nes_bench_rom.nes";
+		if (!WriteTestRom(filename, size.romBanks, size.vromBanks))
+		{
+			printf("failed to write %s\n", filename);
+			return;
+		}
+
+		uint64_t fileSize = sizeof(NesRomFileHeader) + size.romBanks * sizeof(RomBankMem) + size.vromBanks * sizeof(VRomBankMem);
+		double seconds = BestSeconds(runs, [&]()
+		{
+			for (int i = 0; i < iterations; i++)
+			{
+				NesCartridge cartridge;
+				cartridge.LoadFromFile(filename);
+			}
+		}) / iterations;
+
+		remove(filename);
+
+		AddResult("rom_load_" + std::to_string(fileSize / 1024) + "kb", {
+			{ "microseconds", seconds * 1000000.0 },
+			{ "mb_per_sec", fileSize / seconds / (1024.0 * 1024.0) },
+		});
+	}
+}
+
+//=============================================================================
+// Disassembler
+//=============================================================================
+static void BenchDisassembly(int runs)
+{
+	static const uint8_t bankCounts[] = { 2, 32 };
+
+	Mos6502CPU *cpu = new Mos6502CPU;
+	for (uint8_t numBanks : bankCounts)
+	{
+		std::vector<RomBankMem> banks(numBanks);
+		FillPseudoRandom(banks[0].data, numBanks * sizeof(RomBankMem), 1234);
+		cpu->SetRomData(banks.data(), numBanks);
+
+		FILE *output = fopen(NullDevice, "wb");
+		if (output == nullptr)
+		{
+			printf("failed to open %s\n", NullDevice);
+			break;
+		}
+
+		double seconds = BestSeconds(runs, [&]() { cpu->PrintProgram(output); });
+		fclose(output);
+
+		uint64_t romSize = numBanks * sizeof(RomBankMem);
+		AddResult("disassemble_" + std::to_string(romSize / 1024) + "kb", {
+			{ "milliseconds", seconds * 1000.0 },
+			{ "mb_per_sec", romSize / seconds / (1024.0 * 1024.0) },
+		});
+	}
+
+	delete cpu;
+}
+
+//=============================================================================
+// APU
+//=============================================================================
+static uint8_t BenchDmcRead(void *context, uint16_t address)
+{
+	return (uint8_t)(address * 0x9D);
+}
+
+static void BenchApu(int numFrames, int runs)
+{
+	// register writes for a busy frame: both pulses with sweep, triangle, fast noise and a looping dmc sample
+	static const uint16_t writes[][2] =
+	{
+		{ 0x4015, 0x1F },
+		{ 0x4000, 0xBF }, { 0x4001, 0x9A }, { 0x4002, 0xFD }, { 0x4003, 0x00 },
+		{ 0x4004, 0x7F }, { 0x4005, 0x00 }, { 0x4006, 0x7E }, { 0x4007, 0x00 },
+		{ 0x4008, 0xFF }, { 0x400A, 0x3F }, { 0x400B, 0x00 },
+		{ 0x400C, 0x3F }, { 0x400E, 0x03 }, { 0x400F, 0x00 },
+		{ 0x4010, 0x4F }, { 0x4012, 0x00 }, { 0x4013, 0xFF },
+		{ 0x4015, 0x1F },
+	};
+
+	static const uint32_t CyclesPerFrame = 29781;
+
+	NesApu *apu = new NesApu;
+	apu->SetMemoryReader(BenchDmcRead, nullptr);
+	apu->SetSampleRate(48000);
+
+	uint64_t numSamples = 0;
+	double seconds = BestSeconds(runs, [&]()
+	{
+		apu->Reset(0);
+		numSamples = 0;
+
+		uint64_t cycle = 0;
+		for (int frame = 0; frame < numFrames; frame++)
+		{
+			// the notes are restarted every frame like a music driver would
+			apu->Run(cycle + 100);
+			for (const auto &write : writes)
+				apu->WriteRegister(write[0], (uint8_t)write[1]);
+
+			cycle += CyclesPerFrame;
+			apu->EndFrame(cycle);
+			numSamples += apu->GetSamples().size();
+		}
+	});
+
+	double frameSeconds = seconds / numFrames;
+	AddResult("apu_all_channels", {
+		{ "microseconds_per_frame", frameSeconds * 1000000.0 },
+		{ "percent_of_realtime_frame", frameSeconds * 100.0 * NesApu::CpuClockRate / CyclesPerFrame },
+		{ "samples_per_frame", (double)numSamples / numFrames },
+	});
+
+	delete apu;
+}
+
+//=============================================================================
+// Band limited synthesis
+//=============================================================================
+static void BenchBlip(int numFrames, int runs)
+{
+	static const uint32_t CyclesPerFrame = 29781;
+	static const uint32_t DeltasPerFrame = 4096;
+
+	// a noise channel at its highest rate makes about this many changes per frame
+	std::vector<BlipDelta> deltas(DeltasPerFrame);
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < DeltasPerFrame; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		deltas[i].time = (uint32_t)((uint64_t)i * CyclesPerFrame / DeltasPerFrame);
+		deltas[i].delta = (int32_t)(seed >> 22) - 512;
+	}
+
+	std::vector<int16_t> reference;
+	for (int simd = BLIP_SIMD_SCALAR; simd <= BlipBuffer::GetBestSimd(); simd++)
+	{
+		BlipBuffer *blip = new BlipBuffer;
+		blip->SetSimd((BlipBufferSimd)simd);
+		blip->SetRates(NesApu::CpuClockRate, 48000);
+
+		// the output of every run is compared to the scalar run, sample by sample
+		std::vector<int16_t> output;
+		double seconds = BestSeconds(runs, [&]()
+		{
+			blip->Clear();
+			output.clear();
+			for (int frame = 0; frame < numFrames; frame++)
+			{
+				for (const BlipDelta &delta : deltas)
+					blip->AddDelta(delta.time, delta.delta);
+				blip->EndFrame(CyclesPerFrame);
+				output.insert(output.end(), blip->GetSamples().begin(), blip->GetSamples().end());
+			}
+		});
+
+		if (simd == BLIP_SIMD_SCALAR)
+			reference = output;
+
+		int maxError = 0;
+		for (size_t i = 0; i < output.size() && i < reference.size(); i++)
+			maxError = std::max(maxError, abs(output[i] - reference[i]));
+
+		AddResult(std::string("blip_") + BlipBuffer::GetSimdName((BlipBufferSimd)simd), {
+			{ "microseconds_per_frame", seconds / numFrames * 1000000.0 },
+			{ "deltas_per_sec", (double)DeltasPerFrame * numFrames / seconds },
+			{ "max_error_vs_scalar", (double)maxError },
+		});
+
+		delete blip;
+	}
+}
+
+//=============================================================================
+// Output
+//=============================================================================
+static bool WriteJson(const char *filename, const char *commit, bool quick)
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"commit\": \"%s\",\n", commit);
+	fprintf(file, "  \"quick\": %s,\n", quick ? "true" : "false");
+	fprintf(file, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < s_results.size(); i++)
+	{
+		const BenchResult &result = s_results[i];
+		fprintf(file, "    { \"name\": \"%s\"", result.name.c_str());
+		for (const BenchMetric &metric : result.metrics)
+			fprintf(file, ", \"%s\": %.6g", metric.name, metric.value);
+		fprintf(file, " }%s\n", i + 1 < s_results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+
+	return fclose(file) == 0;
+}
+
+int main(int argc, char **argv)
+{
+	bool quick = false;
+	const char *outputFile = "nes_bench.json";
+	const char *commit = "";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outputFile = argv[++i];
+		else if (strcmp(argv[i], "--commit") == 0 && i + 1 < argc)
+			commit = argv[++i];
+		else
+		{
+			printf("usage: nes_bench [--quick] [--out <file.json>] [--commit <id>]\n");
+			return 1;
+		}
+	}
+
+	// --quick is a smoke run, the numbers are too short lived to compare
+	int runs = quick ? 1 : 5;
+	BenchCpu(quick ? 1000000 : 20000000, runs);
+	BenchRomLoad(quick ? 2 : 20, runs);
+	BenchDisassembly(runs);
+	BenchApu(quick ? 60 : 1200, runs);
+	BenchBlip(quick ? 60 : 1200, runs);
+
+	if (!WriteJson(outputFile, commit, quick))
+	{
+		printf("failed to write %s\n", outputFile);
+		return 1;
+	}
+
+	printf("results -> %s\n", outputFile);
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+Description:
+	libFuzzer entry point for NesCartridge::LoadFromBytes.
+
+	the input is copied into a buffer of exactly its size so AddressSanitizer catches any read past
+	the end. A cartridge that loads has every bank read back, then runs for a few hundred
+	instructions on the console to exercise the bus mapping of its banks.
+*/
+
+#include "NesConsole.h"
+#include "NesRom.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	std::vector<uint8_t> buffer(data, data + size);
+
+	NesCartridge cartridge;
+	if (!cartridge.LoadFromBytes(buffer.data(), (unsigned int)buffer.size()))
+	{
+		// a failed load has nothing to map
+		if (cartridge.GetRomBankCount() != 0 || cartridge.GetVRomBankCount() != 0)
+			abort();
+		return 0;
+	}
+
+	// everything the header describes has to be inside the buffer, the first and last byte of each bank is touched
+	volatile uint8_t sink = 0;
+	for (uint32_t bank = 0; bank < cartridge.GetRomBankCount(); bank++)
+		sink ^= cartridge.GetRomBanks()[bank].data[0] ^ cartridge.GetRomBanks()[bank].data[sizeof(RomBankMem) - 1];
+	for (uint32_t bank = 0; bank < cartridge.GetVRomBankCount(); bank++)
+		sink ^= cartridge.GetVRomBanks()[bank].data[0] ^ cartridge.GetVRomBanks()[bank].data[sizeof(VRomBankMem) - 1];
+	(void)sink;
+
+	static NesConsole *console = new NesConsole;
+	console->LoadCartridge(cartridge);
+	console->Reset();
+	for (int i = 0; i < 256; i++)
+		console->Step();
+
+	return 0;
+}
@@ -0,0 +1,181 @@
+/*
+Description:
+	libFuzzer entry point for single instruction execution in Mos6502CPU.
+
+	input:	a, x, y, sp, p, pc lo, pc hi, 3 instruction bytes, then up to 16 x (address lo, address hi, value)
+			patches over a fixed pseudo random memory image
+
+	the instruction is executed once by Mos6502CPU and once by Mos6502Reference, each with its own
+	copy of memory. Registers, flags, pc, cycles and every memory write (address, value and order)
+	have to match, a difference aborts with both states printed.
+*/
+
+#include "Mos6502CPU.h"
+#include "Mos6502Reference.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct FuzzMemory
+{
+	uint8_t		data[0x10000];
+
+	// writes of the current instruction, BRK / JSR write at most 3
+	uint16_t	writeAddress[8];
+	uint8_t		writeValue[8];
+	uint32_t	numWrites;
+};
+
+static uint8_t FillByte(uint32_t address)
+{
+	return (uint8_t)((address * 2654435761u) >> 24);
+}
+
+static uint8_t FuzzRead(void *context, uint16_t address)
+{
+	return ((FuzzMemory *)context)->data[address];
+}
+
+static void FuzzWrite(void *context, uint16_t address, uint8_t value)
+{
+	FuzzMemory *memory = (FuzzMemory *)context;
+	if (memory->numWrites < 8)
+	{
+		memory->writeAddress[memory->numWrites] = address;
+		memory->writeValue[memory->numWrites] = value;
+	}
+	memory->numWrites++;
+	memory->data[address] = value;
+}
+
+static void Restore(FuzzMemory &memory, uint16_t address)
+{
+	memory.data[address] = FillByte(address);
+}
+
+static void Report(const char *what, const uint8_t *input, size_t size, const Mos6502CPU &cpu, const Mos6502RefState &reference,
+	uint64_t cpuCycles, const FuzzMemory &cpuMemory, const FuzzMemory &refMemory)
+{
+	printf("mismatch: %s\n", what);
+	printf("  input:");
+	for (size_t i = 0; i < size; i++)
+		printf(" %02X", input[i]);
+	printf("\n");
+
+	printf("  cpu:       PC:%04X A:%02X X:%02X Y:%02X P:%02X SP:%02X cycles %llu, writes", cpu.GetPC(), cpu.GetA(), cpu.GetX(),
+		cpu.GetY(), cpu.GetStatus(), cpu.GetSP(), (unsigned long long)cpuCycles);
+	for (uint32_t i = 0; i < cpuMemory.numWrites && i < 8; i++)
+		printf(" $%04X=%02X", cpuMemory.writeAddress[i], cpuMemory.writeValue[i]);
+
+	printf("\n  reference: PC:%04X A:%02X X:%02X Y:%02X P:%02X SP:%02X cycles %llu, writes", reference.pc, reference.a, reference.x,
+		reference.y, reference.p, reference.sp, (unsigned long long)reference.cycles);
+	for (uint32_t i = 0; i < refMemory.numWrites && i < 8; i++)
+		printf(" $%04X=%02X", refMemory.writeAddress[i], refMemory.writeValue[i]);
+	printf("\n");
+
+	fflush(stdout);
+	abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static const size_t HeaderSize = 10;
+	static const uint32_t MaxPatches = 16;
+
+	static FuzzMemory *cpuMemory = nullptr;
+	static FuzzMemory *refMemory = nullptr;
+	static Mos6502CPU *cpu = nullptr;
+
+	if (cpu == nullptr)
+	{
+		cpuMemory = new FuzzMemory;
+		refMemory = new FuzzMemory;
+		for (uint32_t address = 0; address < 0x10000; address++)
+			cpuMemory->data[address] = refMemory->data[address] = FillByte(address);
+
+		// every page goes through the handlers so the writes can be logged
+		cpu = new Mos6502CPU;
+		cpu->GetBus().MapHandlers(0x00, 256, FuzzRead, FuzzWrite, cpuMemory);
+	}
+
+	if (size < HeaderSize)
+		return 0;
+
+	uint16_t pc = (uint16_t)(data[5] | (data[6] << 8));
+	uint32_t numPatches = (uint32_t)((size - HeaderSize) / 3);
+	if (numPatches > MaxPatches)
+		numPatches = MaxPatches;
+
+	// instruction bytes first, patches can still overwrite them
+	uint16_t patched[3 + MaxPatches];
+	uint32_t numPatched = 0;
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		uint16_t address = (uint16_t)(pc + i);
+		cpuMemory->data[address] = refMemory->data[address] = data[7 + i];
+		patched[numPatched++] = address;
+	}
+	for (uint32_t i = 0; i < numPatches; i++)
+	{
+		const uint8_t *patch = data + HeaderSize + i * 3;
+		uint16_t address = (uint16_t)(patch[0] | (patch[1] << 8));
+		cpuMemory->data[address] = refMemory->data[address] = patch[2];
+		patched[numPatched++] = address;
+	}
+
+	Mos6502RefState reference;
+	reference.pc = pc;
+	reference.a = data[0];
+	reference.x = data[1];
+	reference.y = data[2];
+	reference.sp = data[3];
+	reference.p = (uint8_t)((data[4] & 0xCF) | 0x20);
+	reference.cycles = 0;
+
+	cpuMemory->numWrites = 0;
+	refMemory->numWrites = 0;
+
+	Mos6502Reference model(FuzzRead, FuzzWrite, refMemory);
+	bool modelled = model.Step(reference);
+
+	if (modelled)
+	{
+		cpu->SetRegisters(data[0], data[1], data[2], data[3], data[4]);
+		cpu->SetPC(pc);
+		uint64_t firstCycle = cpu->GetCycles();
+		cpu->Tick();
+		uint64_t cycles = cpu->GetCycles() - firstCycle;
+
+		if (cpu->GetPC() != reference.pc || cpu->GetA() != reference.a || cpu->GetX() != reference.x ||
+			cpu->GetY() != reference.y || cpu->GetSP() != reference.sp || cpu->GetStatus() != reference.p)
+		{
+			Report("registers", data, size, *cpu, reference, cycles, *cpuMemory, *refMemory);
+		}
+
+		if (cycles != reference.cycles)
+			Report("cycles", data, size, *cpu, reference, cycles, *cpuMemory, *refMemory);
+
+		bool writesMatch = cpuMemory->numWrites == refMemory->numWrites && cpuMemory->numWrites <= 8;
+		for (uint32_t i = 0; writesMatch && i < cpuMemory->numWrites; i++)
+		{
+			writesMatch = cpuMemory->writeAddress[i] == refMemory->writeAddress[i] &&
+				cpuMemory->writeValue[i] == refMemory->writeValue[i];
+		}
+		if (!writesMatch)
+			Report("memory writes", data, size, *cpu, reference, cycles, *cpuMemory, *refMemory);
+	}
+
+	// back to the fixed image for the next input
+	for (uint32_t i = 0; i < numPatched; i++)
+	{
+		Restore(*cpuMemory, patched[i]);
+		Restore(*refMemory, patched[i]);
+	}
+	for (uint32_t i = 0; i < cpuMemory->numWrites && i < 8; i++)
+		Restore(*cpuMemory, cpuMemory->writeAddress[i]);
+	for (uint32_t i = 0; i < refMemory->numWrites && i < 8; i++)
+		Restore(*refMemory, refMemory->writeAddress[i]);
+
+	return 0;
+}
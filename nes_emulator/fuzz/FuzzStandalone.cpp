@@ -0,0 +1,111 @@
+/*
+Description:
+	main() for the fuzz targets when libFuzzer is not available (gcc, msvc).
+
+	usage: nes_fuzz_<target> [corpus files...] [-runs=<n>] [-seed=<n>] [-max_len=<n>]
+
+	every corpus file is run once. With -runs, n more inputs are run: byte level mutations of a
+	random corpus file, or random bytes without a corpus. This is a smoke test and a way to
+	replay crashes, the coverage guided search needs a clang build with libFuzzer.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint64_t s_random = 0x9E3779B97F4A7C15ull;
+
+static uint32_t Random()
+{
+	// xorshift64*
+	s_random ^= s_random >> 12;
+	s_random ^= s_random << 25;
+	s_random ^= s_random >> 27;
+	return (uint32_t)((s_random * 2685821657736338717ull) >> 32);
+}
+
+static bool ReadFile(const char *filename, std::vector<uint8_t> &data)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+		return false;
+
+	uint8_t block[4096];
+	size_t size;
+	while ((size = fread(block, 1, sizeof(block), file)) > 0)
+		data.insert(data.end(), block, block + size);
+
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t runs = 0;
+	size_t maxLength = 64;
+	std::vector<std::vector<uint8_t>> corpus;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "-runs=", 6) == 0)
+			runs = strtoull(argv[i] + 6, nullptr, 10);
+		else if (strncmp(argv[i], "-seed=", 6) == 0)
+			s_random = strtoull(argv[i] + 6, nullptr, 10) | 1;
+		else if (strncmp(argv[i], "-max_len=", 9) == 0)
+			maxLength = (size_t)strtoull(argv[i] + 9, nullptr, 10);
+		else
+		{
+			std::vector<uint8_t> data;
+			if (!ReadFile(argv[i], data))
+			{
+				printf("failed to open %s\n", argv[i]);
+				return 1;
+			}
+			corpus.push_back(data);
+		}
+	}
+
+	for (const std::vector<uint8_t> &data : corpus)
+		LLVMFuzzerTestOneInput(data.data(), data.size());
+
+	std::vector<uint8_t> input;
+	auto startTime = std::chrono::steady_clock::now();
+
+	for (uint64_t run = 0; run < runs; run++)
+	{
+		if (!corpus.empty())
+		{
+			// a handful of byte flips, overwrites or truncations of a corpus entry
+			input = corpus[Random() % corpus.size()];
+			uint32_t numMutations = 1 + Random() % 4;
+			for (uint32_t i = 0; i < numMutations && !input.empty(); i++)
+			{
+				size_t position = Random() % input.size();
+				switch (Random() % 3)
+				{
+				case 0: input[position] ^= (uint8_t)(1 << (Random() % 8)); break;
+				case 1: input[position] = (uint8_t)Random(); break;
+				default: input.resize(position); break;
+				}
+			}
+		}
+		else
+		{
+			input.resize(Random() % (maxLength + 1));
+			for (uint8_t &byte : input)
+				byte = (uint8_t)Random();
+		}
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	printf("%zu corpus files, %llu runs in %.2f seconds (%.0f execs/s)\n", corpus.size(), (unsigned long long)runs, seconds,
+		seconds > 0.0 ? runs / seconds : 0.0);
+	return 0;
+}
@@ -0,0 +1,436 @@
+#include "Mos6502Reference.h"
+#include "Mos6502OpCodes.h"
+
+#include <string.h>
+
+enum Mnemonic
+{
+	ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+	CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+	JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+	RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+	// unofficial
+	ALR, ANC, ANE, ARR, DCP, ISC, JAM, LAS, LAX, LXA, RLA, RRA, SAX, SBX,
+	SHA, SHX, SHY, SLO, SRE, TAS,
+	NUM_MNEMONICS, UNKNOWN = NUM_MNEMONICS
+};
+
+static const char *s_mnemonicNames[NUM_MNEMONICS] =
+{
+	"ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL", "BRK", "BVC", "BVS", "CLC",
+	"CLD", "CLI", "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR", "INC", "INX", "INY", "JMP",
+	"JSR", "LDA", "LDX", "LDY", "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL", "ROR", "RTI",
+	"RTS", "SBC", "SEC", "SED", "SEI", "STA", "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS", "TYA",
+	"ALR", "ANC", "ANE", "ARR", "DCP", "ISC", "JAM", "LAS", "LAX", "LXA", "RLA", "RRA", "SAX", "SBX",
+	"SHA", "SHX", "SHY", "SLO", "SRE", "TAS",
+};
+
+static Mnemonic MnemonicOf(uint8_t opCode)
+{
+	// looked up by name once, the opcode table only supplies the name, mode and base cycles
+	static Mnemonic mnemonics[256];
+	static bool initialized = false;
+	if (!initialized)
+	{
+		for (int op = 0; op < 256; op++)
+		{
+			mnemonics[op] = UNKNOWN;
+			const char *name = Mos6502OpCodeTable[op].mnemonic;
+			for (int i = 0; name != nullptr && i < NUM_MNEMONICS; i++)
+			{
+				if (strcmp(name, s_mnemonicNames[i]) == 0)
+					mnemonics[op] = (Mnemonic)i;
+			}
+		}
+		initialized = true;
+	}
+	return mnemonics[opCode];
+}
+
+Mos6502Reference::Mos6502Reference(ReadFunction read, WriteFunction write, void *context)
+	: m_read(read)
+	, m_write(write)
+	, m_context(context)
+{
+
+}
+
+void Mos6502Reference::SetFlag(Mos6502RefState &state, uint8_t flag, bool set)
+{
+	state.p = set ? (uint8_t)(state.p | flag) : (uint8_t)(state.p & ~flag);
+}
+
+void Mos6502Reference::SetZN(Mos6502RefState &state, uint8_t value)
+{
+	SetFlag(state, FLAG_Z, value == 0);
+	SetFlag(state, FLAG_N, (value & 0x80) != 0);
+}
+
+void Mos6502Reference::Add(Mos6502RefState &state, uint8_t value)
+{
+	int sum = state.a + value + (state.p & FLAG_C);
+	bool overflow = ((state.a ^ sum) & (value ^ sum) & 0x80) != 0;
+	SetFlag(state, FLAG_C, sum > 0xFF);
+	SetFlag(state, FLAG_V, overflow);
+	state.a = (uint8_t)sum;
+	SetZN(state, state.a);
+}
+
+void Mos6502Reference::Subtract(Mos6502RefState &state, uint8_t value)
+{
+	int difference = state.a - value - ((state.p & FLAG_C) ? 0 : 1);
+	bool overflow = ((state.a ^ value) & (state.a ^ difference) & 0x80) != 0;
+	SetFlag(state, FLAG_C, difference >= 0);
+	SetFlag(state, FLAG_V, overflow);
+	state.a = (uint8_t)difference;
+	SetZN(state, state.a);
+}
+
+void Mos6502Reference::Push(Mos6502RefState &state, uint8_t value)
+{
+	Write((uint16_t)(0x0100 + state.sp), value);
+	state.sp = (uint8_t)(state.sp - 1);
+}
+
+uint8_t Mos6502Reference::Pull(Mos6502RefState &state)
+{
+	state.sp = (uint8_t)(state.sp + 1);
+	return Read((uint16_t)(0x0100 + state.sp));
+}
+
+bool Mos6502Reference::Step(Mos6502RefState &state)
+{
+	uint8_t opCode = Read(state.pc);
+	Mnemonic mnemonic = MnemonicOf(opCode);
+	if (mnemonic == UNKNOWN)
+		return false;
+
+	const Mos6502OpCode &info = Mos6502OpCodeTable[opCode];
+	uint16_t pc = state.pc;
+	uint16_t next = (uint16_t)(pc + info.bytes);
+	uint8_t operand = Read((uint16_t)(pc + 1));
+	uint16_t operand16 = (uint16_t)(operand | (Read((uint16_t)(pc + 2)) << 8));
+
+	// effective address, and whether indexing crossed into another page
+	uint16_t address = 0;
+	bool pageCrossed = false;
+
+	switch (info.mode)
+	{
+	case ADDR_IMMEDIATE:	address = (uint16_t)(pc + 1); break;
+	case ADDR_ZEROPAGE:		address = operand; break;
+	case ADDR_ZEROPAGE_X:	address = (uint8_t)(operand + state.x); break;
+	case ADDR_ZEROPAGE_Y:	address = (uint8_t)(operand + state.y); break;
+	case ADDR_RELATIVE:		address = (uint16_t)(next + (int8_t)operand); break;
+	case ADDR_ABSOLUTE:		address = operand16; break;
+
+	case ADDR_ABSOLUTE_X:
+		address = (uint16_t)(operand16 + state.x);
+		pageCrossed = (address >> 8) != (operand16 >> 8);
+		break;
+
+	case ADDR_ABSOLUTE_Y:
+		address = (uint16_t)(operand16 + state.y);
+		pageCrossed = (address >> 8) != (operand16 >> 8);
+		break;
+
+	case ADDR_INDIRECT:
+		// the pointer's high byte comes from the same page: JMP ($10FF) reads $10FF and $1000
+		address = (uint16_t)(Read(operand16) | (Read((uint16_t)((operand16 & 0xFF00) | ((operand16 + 1) & 0xFF))) << 8));
+		break;
+
+	case ADDR_INDIRECT_X:
+	{
+		uint8_t pointer = (uint8_t)(operand + state.x);
+		address = (uint16_t)(Read(pointer) | (Read((uint8_t)(pointer + 1)) << 8));
+	}
+	break;
+
+	case ADDR_INDIRECT_Y:
+	{
+		uint16_t base = (uint16_t)(Read(operand) | (Read((uint8_t)(operand + 1)) << 8));
+		address = (uint16_t)(base + state.y);
+		pageCrossed = (address >> 8) != (base >> 8);
+	}
+	break;
+
+	default:
+		break;
+	}
+
+	state.pc = next;
+	state.cycles += info.cycles;
+
+	bool accumulator = info.mode == ADDR_ACCUMULATOR;
+
+	switch (mnemonic)
+	{
+	// loads, stores and transfers
+	case LDA: state.a = Read(address); SetZN(state, state.a); break;
+	case LDX: state.x = Read(address); SetZN(state, state.x); break;
+	case LDY: state.y = Read(address); SetZN(state, state.y); break;
+	case STA: Write(address, state.a); break;
+	case STX: Write(address, state.x); break;
+	case STY: Write(address, state.y); break;
+	case TAX: state.x = state.a; SetZN(state, state.x); break;
+	case TAY: state.y = state.a; SetZN(state, state.y); break;
+	case TXA: state.a = state.x; SetZN(state, state.a); break;
+	case TYA: state.a = state.y; SetZN(state, state.a); break;
+	case TSX: state.x = state.sp; SetZN(state, state.x); break;
+	case TXS: state.sp = state.x; break;
+
+	// arithmetic
+	case ADC: Add(state, Read(address)); break;
+	case SBC: Subtract(state, Read(address)); break;
+
+	case CMP:
+	case CPX:
+	case CPY:
+	{
+		uint8_t reg = mnemonic == CMP ? state.a : mnemonic == CPX ? state.x : state.y;
+		uint8_t value = Read(address);
+		SetFlag(state, FLAG_C, reg >= value);
+		SetZN(state, (uint8_t)(reg - value));
+	}
+	break;
+
+	// logic
+	case AND: state.a &= Read(address); SetZN(state, state.a); break;
+	case ORA: state.a |= Read(address); SetZN(state, state.a); break;
+	case EOR: state.a ^= Read(address); SetZN(state, state.a); break;
+
+	case BIT:
+	{
+		uint8_t value = Read(address);
+		SetFlag(state, FLAG_Z, (state.a & value) == 0);
+		SetFlag(state, FLAG_V, (value & 0x40) != 0);
+		SetFlag(state, FLAG_N, (value & 0x80) != 0);
+	}
+	break;
+
+	// read-modify-write
+	case ASL:
+	case LSR:
+	case ROL:
+	case ROR:
+	case INC:
+	case DEC:
+	{
+		uint8_t value = accumulator ? state.a : Read(address);
+		uint8_t result = 0;
+		bool carryIn = (state.p & FLAG_C) != 0;
+
+		switch (mnemonic)
+		{
+		case ASL: result = (uint8_t)(value << 1); SetFlag(state, FLAG_C, (value & 0x80) != 0); break;
+		case LSR: result = (uint8_t)(value >> 1); SetFlag(state, FLAG_C, (value & 0x01) != 0); break;
+		case ROL: result = (uint8_t)((value << 1) | (carryIn ? 0x01 : 0)); SetFlag(state, FLAG_C, (value & 0x80) != 0); break;
+		case ROR: result = (uint8_t)((value >> 1) | (carryIn ? 0x80 : 0)); SetFlag(state, FLAG_C, (value & 0x01) != 0); break;
+		case INC: result = (uint8_t)(value + 1); break;
+		default:  result = (uint8_t)(value - 1); break;
+		}
+
+		SetZN(state, result);
+		if (accumulator)
+			state.a = result;
+		else
+			Write(address, result);
+	}
+	break;
+
+	case INX: state.x++; SetZN(state, state.x); break;
+	case INY: state.y++; SetZN(state, state.y); break;
+	case DEX: state.x--; SetZN(state, state.x); break;
+	case DEY: state.y--; SetZN(state, state.y); break;
+
+	// branches, +1 cycle when taken and +1 more when the target is on another page
+	case BCC:
+	case BCS:
+	case BEQ:
+	case BNE:
+	case BMI:
+	case BPL:
+	case BVC:
+	case BVS:
+	{
+		bool taken = false;
+		switch (mnemonic)
+		{
+		case BCC: taken = !(state.p & FLAG_C); break;
+		case BCS: taken = (state.p & FLAG_C) != 0; break;
+		case BNE: taken = !(state.p & FLAG_Z); break;
+		case BEQ: taken = (state.p & FLAG_Z) != 0; break;
+		case BPL: taken = !(state.p & FLAG_N); break;
+		case BMI: taken = (state.p & FLAG_N) != 0; break;
+		case BVC: taken = !(state.p & FLAG_V); break;
+		default:  taken = (state.p & FLAG_V) != 0; break;
+		}
+
+		if (taken)
+		{
+			state.cycles += (address >> 8) != (next >> 8) ? 2 : 1;
+			state.pc = address;
+		}
+	}
+	break;
+
+	// jumps, calls and returns
+	case JMP: state.pc = address; break;
+
+	case JSR:
+	{
+		// the return address pushed is the last byte of the JSR
+		uint16_t last = (uint16_t)(next - 1);
+		Push(state, (uint8_t)(last >> 8));
+		Push(state, (uint8_t)last);
+		state.pc = address;
+	}
+	break;
+
+	case RTS:
+	{
+		uint8_t lo = Pull(state);
+		uint8_t hi = Pull(state);
+		state.pc = (uint16_t)(((hi << 8) | lo) + 1);
+	}
+	break;
+
+	case BRK:
+	{
+		// BRK skips a padding byte, the pushed status has the break bit set
+		uint16_t returnAddress = (uint16_t)(pc + 2);
+		Push(state, (uint8_t)(returnAddress >> 8));
+		Push(state, (uint8_t)returnAddress);
+		Push(state, (uint8_t)(state.p | FLAG_B | FLAG_U));
+		SetFlag(state, FLAG_I, true);
+		state.pc = (uint16_t)(Read(0xFFFE) | (Read(0xFFFF) << 8));
+	}
+	break;
+
+	case RTI:
+	{
+		state.p = (uint8_t)((Pull(state) & ~FLAG_B) | FLAG_U);
+		uint8_t lo = Pull(state);
+		uint8_t hi = Pull(state);
+		state.pc = (uint16_t)((hi << 8) | lo);
+	}
+	break;
+
+	// stack
+	case PHA: Push(state, state.a); break;
+	case PHP: Push(state, (uint8_t)(state.p | FLAG_B | FLAG_U)); break;
+	case PLA: state.a = Pull(state); SetZN(state, state.a); break;
+	case PLP: state.p = (uint8_t)((Pull(state) & ~FLAG_B) | FLAG_U); break;
+
+	// flags
+	case CLC: SetFlag(state, FLAG_C, false); break;
+	case SEC: SetFlag(state, FLAG_C, true); break;
+	case CLI: SetFlag(state, FLAG_I, false); break;
+	case SEI: SetFlag(state, FLAG_I, true); break;
+	case CLD: SetFlag(state, FLAG_D, false); break;
+	case SED: SetFlag(state, FLAG_D, true); break;
+	case CLV: SetFlag(state, FLAG_V, false); break;
+
+	// unofficial read-modify-write: the memory operation, then the accumulator operation on the new value
+	case SLO:
+	case RLA:
+	case SRE:
+	case RRA:
+	case DCP:
+	case ISC:
+	{
+		uint8_t value = Read(address);
+		uint8_t result = 0;
+		bool carryIn = (state.p & FLAG_C) != 0;
+
+		switch (mnemonic)
+		{
+		case SLO: result = (uint8_t)(value << 1); SetFlag(state, FLAG_C, (value & 0x80) != 0); state.a |= result; SetZN(state, state.a); break;
+		case RLA: result = (uint8_t)((value << 1) | (carryIn ? 0x01 : 0)); SetFlag(state, FLAG_C, (value & 0x80) != 0); state.a &= result; SetZN(state, state.a); break;
+		case SRE: result = (uint8_t)(value >> 1); SetFlag(state, FLAG_C, (value & 0x01) != 0); state.a ^= result; SetZN(state, state.a); break;
+		case RRA: result = (uint8_t)((value >> 1) | (carryIn ? 0x80 : 0)); SetFlag(state, FLAG_C, (value & 0x01) != 0); Add(state, result); break;
+		case DCP: result = (uint8_t)(value - 1); SetFlag(state, FLAG_C, state.a >= result); SetZN(state, (uint8_t)(state.a - result)); break;
+		default:  result = (uint8_t)(value + 1); Subtract(state, result); break;
+		}
+
+		Write(address, result);
+	}
+	break;
+
+	case SAX: Write(address, state.a & state.x); break;
+	case LAX: state.a = state.x = Read(address); SetZN(state, state.a); break;
+	case LXA: state.a = state.x = Read(address); SetZN(state, state.a); break;
+	case ANE: state.a = (uint8_t)((state.a | 0xEE) & state.x & Read(address)); SetZN(state, state.a); break;
+	case ANC: state.a &= Read(address); SetZN(state, state.a); SetFlag(state, FLAG_C, (state.a & 0x80) != 0); break;
+
+	case ALR:
+	{
+		uint8_t value = state.a & Read(address);
+		SetFlag(state, FLAG_C, (value & 0x01) != 0);
+		state.a = (uint8_t)(value >> 1);
+		SetZN(state, state.a);
+	}
+	break;
+
+	case ARR:
+	{
+		uint8_t value = state.a & Read(address);
+		state.a = (uint8_t)((value >> 1) | ((state.p & FLAG_C) ? 0x80 : 0));
+		SetZN(state, state.a);
+		SetFlag(state, FLAG_C, (state.a & 0x40) != 0);
+		SetFlag(state, FLAG_V, ((state.a & 0x40) != 0) != ((state.a & 0x20) != 0));
+	}
+	break;
+
+	case SBX:
+	{
+		uint8_t value = Read(address);
+		int difference = (state.a & state.x) - value;
+		SetFlag(state, FLAG_C, difference >= 0);
+		state.x = (uint8_t)difference;
+		SetZN(state, state.x);
+	}
+	break;
+
+	case LAS:
+		state.a = state.x = state.sp = Read(address) & state.sp;
+		SetZN(state, state.a);
+		break;
+
+	// the stored value is ANDed with the high byte of the unindexed address + 1, which also
+	// becomes the high byte of the address when indexing crossed a page
+	case SHA:
+	case SHX:
+	case SHY:
+	case TAS:
+	{
+		uint8_t index = mnemonic == SHY ? state.x : state.y;
+		uint16_t base = (uint16_t)(address - index);
+		if (mnemonic == TAS)
+			state.sp = state.a & state.x;
+
+		uint8_t value = mnemonic == SHA ? (uint8_t)(state.a & state.x) : mnemonic == SHX ? state.x : mnemonic == SHY ? state.y : state.sp;
+		value &= (uint8_t)((base >> 8) + 1);
+		if (pageCrossed)
+			address = (uint16_t)((value << 8) | (address & 0xFF));
+		Write(address, value);
+	}
+	break;
+
+	// stays on the opcode
+	case JAM: state.pc = pc; break;
+
+	case NOP:
+	default:
+		break;
+	}
+
+	// reads that index across a page take an extra cycle, stores and read-modify-write always pay it
+	bool isRead = mnemonic == LDA || mnemonic == LDX || mnemonic == LDY || mnemonic == ADC || mnemonic == SBC ||
+		mnemonic == AND || mnemonic == ORA || mnemonic == EOR || mnemonic == CMP || mnemonic == LAX ||
+		mnemonic == LAS || (mnemonic == NOP && info.mode == ADDR_ABSOLUTE_X);
+	if (isRead && pageCrossed)
+		state.cycles++;
+
+	return true;
+}
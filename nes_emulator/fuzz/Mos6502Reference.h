@@ -0,0 +1,67 @@
+/*
+Description:
+	A deliberately plain 6502 model to check Mos6502CPU against when fuzzing.
+
+	It is written for readability, not speed: every instruction is decoded from its mnemonic and
+	addressing mode, operands are worked out in full and flags are computed from their textbook
+	definitions (eg. SBC as a real subtraction rather than ADC of the complement). All 256
+	opcodes are modelled, the unofficial ones from their descriptions on the nesdev wiki.
+	Decimal mode is ignored, as on the 2A03.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+struct Mos6502RefState
+{
+	uint16_t	pc;
+	uint8_t		a, x, y, sp, p;
+	uint64_t	cycles;
+};
+
+class Mos6502Reference
+{
+public:
+
+	typedef uint8_t (*ReadFunction)(void *context, uint16_t address);
+	typedef void (*WriteFunction)(void *context, uint16_t address, uint8_t value);
+
+	Mos6502Reference(ReadFunction read, WriteFunction write, void *context);
+
+	// executes the instruction at state.pc, false when the opcode is not modelled
+	bool Step(Mos6502RefState &state);
+
+protected:
+
+	enum Flag : uint8_t
+	{
+		FLAG_C = 0x01,
+		FLAG_Z = 0x02,
+		FLAG_I = 0x04,
+		FLAG_D = 0x08,
+		FLAG_B = 0x10,
+		FLAG_U = 0x20,
+		FLAG_V = 0x40,
+		FLAG_N = 0x80,
+	};
+
+	uint8_t Read(uint16_t address) { return m_read(m_context, address); }
+	void Write(uint16_t address, uint8_t value) { m_write(m_context, address, value); }
+
+	static void SetFlag(Mos6502RefState &state, uint8_t flag, bool set);
+	static void SetZN(Mos6502RefState &state, uint8_t value);
+
+	// ADC and SBC, also used by RRA and ISC
+	static void Add(Mos6502RefState &state, uint8_t value);
+	static void Subtract(Mos6502RefState &state, uint8_t value);
+
+	void Push(Mos6502RefState &state, uint8_t value);
+	uint8_t Pull(Mos6502RefState &state);
+
+	ReadFunction	 m_read;
+	WriteFunction	 m_write;
+	void			*m_context;
+
+private:
+};
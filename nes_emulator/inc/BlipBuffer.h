@@ -0,0 +1,108 @@
+/*
+Description:
+	Band limited step synthesis, converts amplitude changes at clock rate into samples at an
+	audio sample rate.
+
+	A source never generates samples itself. It only records each change of its output level as a
+	(clock time, delta) pair, which costs a store per change instead of work per clock. EndFrame()
+	then turns all the deltas of a frame into samples in one batch: every delta adds a windowed
+	sinc step, picked from a table by its fractional sample position, into an accumulation buffer,
+	and a running sum over that buffer gives the band limited output. A one pole high pass removes
+	the dc offset, like the output stage of the console.
+
+	Sample positions are 32.32 fixed point, the fraction left over at the end of a frame carries
+	into the next one so frame lengths do not need to be a whole number of samples.
+
+	The step table is a polyphase FIR: filtering the clock rate step signal down to the sample
+	rate only needs one 16 tap phase per delta. Adding the steps is vectorized, AVX2 + FMA (2 x 8
+	floats per step) or SSE2 (4 x 4), picked at run time with a scalar fallback. The scalar version
+	is the reference the others are benchmarked and checked against.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+enum BlipBufferSimd
+{
+	BLIP_SIMD_SCALAR,
+	BLIP_SIMD_SSE2,
+	BLIP_SIMD_AVX2,
+};
+
+struct BlipDelta
+{
+	uint32_t	time;
+	int32_t		delta;
+};
+
+class BlipBuffer
+{
+public:
+
+	// fractional sample positions are rounded to 1 / Phases, each step is Taps samples long
+	static const uint32_t Phases = 32;
+	static const uint32_t Taps = 16;
+
+	BlipBuffer();
+	~BlipBuffer();
+
+	// the best instruction set this cpu supports, used by default
+	static BlipBufferSimd GetBestSimd();
+	static const char *GetSimdName(BlipBufferSimd simd);
+
+	// false when the cpu does not support 'simd'
+	bool SetSimd(BlipBufferSimd simd);
+
+	// 'sampleRate' 0 disables the buffer, AddDelta() then ignores everything
+	void SetRates(double clockRate, uint32_t sampleRate);
+	uint32_t GetSampleRate() const { return m_sampleRate; }
+	bool IsEnabled() const { return m_sampleRate != 0; }
+
+	// scales the output rate by 'ratio' from the next EndFrame() on without a discontinuity,
+	// used to keep an output buffer at its target fill. 1.0 is the rate given to SetRates()
+	void SetRateAdjust(double ratio);
+
+	// clears pending deltas, output and filter state
+	void Clear();
+
+	// 'clockTime' counts clocks from the start of the current frame
+	void AddDelta(uint32_t clockTime, int32_t delta)
+	{
+		if (m_sampleRate != 0 && delta != 0)
+			m_deltas.push_back(BlipDelta{ clockTime, delta });
+	}
+
+	// synthesizes the 'frameClocks' long frame, the samples replace the previous frame's.
+	// deltas must not be later than 'frameClocks', which is the start of the next frame
+	void EndFrame(uint32_t frameClocks);
+
+	const std::vector<int16_t> &GetSamples() const { return m_samples; }
+
+protected:
+
+	typedef void (*AddStepsFunction)(float *accumulator, const float (*kernel)[Taps], const BlipDelta *deltas, size_t count,
+		uint64_t offset, uint64_t clockFactor);
+
+	void BuildKernel();
+
+	uint32_t				m_sampleRate = 0;
+	double					m_clockRate = 0.0;
+	uint64_t				m_clockFactor = 0;		// samples per clock, 32.32
+	uint64_t				m_offset = 0;			// sample position of the frame start, 32.32
+
+	std::vector<BlipDelta>	m_deltas;
+	AddStepsFunction		m_addSteps;
+	std::vector<float>		m_accumulator;			// sample deltas, running sum is the output
+	std::vector<int16_t>	m_samples;
+
+	float					m_integrator = 0.0f;
+	float					m_highPass = 0.0f;
+	float					m_highPassFactor = 0.0f;
+
+	alignas(32) float		m_kernel[Phases][Taps];
+
+private:
+};
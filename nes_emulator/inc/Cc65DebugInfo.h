@@ -0,0 +1,82 @@
+/*
+Description:
+	Reader for the debug info files written by ld65 (--dbgfile, format version 2).
+	Maps cpu addresses back to C / asm source lines and to the function or label they belong to.
+
+	The file is line based, each line is a record type followed by key=value attributes:
+		file	id=0,name="hello.c",size=1520,mtime=0x5A5E0C41,mod=0
+		seg		id=0,name="CODE",start=0x008000,size=0x0A34,addrsize=absolute,type=ro,oname="hello.nes",ooffs=16
+		span	id=3,seg=0,start=18,size=3
+		line	id=7,file=0,line=12,type=1,span=3+4
+		scope	id=1,name="_main",mod=0,type=scope,size=42,parent=0,span=3
+		sym		id=5,name="_main",addrsize=absolute,scope=0,def=2,val=0x8012,seg=0,type=lab
+
+	Segments are mapped at their run address, which is enough for roms without bank switching.
+
+	https://cc65.github.io/doc/ld65.html#s5
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct Cc65SourceLine
+{
+	uint32_t	file;		// index into the file names
+	uint32_t	line;		// 1 based
+	uint8_t		type;		// Cc65LineType
+};
+
+enum Cc65LineType : uint8_t
+{
+	CC65_LINE_ASM		= 0,
+	CC65_LINE_C			= 1,
+	CC65_LINE_MACRO		= 2,
+};
+
+class Cc65DebugInfo
+{
+public:
+
+	Cc65DebugInfo();
+	~Cc65DebugInfo();
+
+	// replaces any previously loaded info, prints the reason and returns false on failure
+	bool Load(const char *filename);
+
+	bool IsLoaded() const { return m_loaded; }
+
+	// the source line the byte at 'address' was generated from, nullptr if unknown.
+	// C lines are preferred over the asm lines cc65 generated for them
+	const Cc65SourceLine *FindLine(uint16_t address) const;
+
+	// the function (.proc scope) containing 'address', or the nearest label before it
+	const char *FindFunction(uint16_t address) const;
+
+	// a label or function defined exactly at 'address'
+	const char *FindSymbol(uint16_t address) const;
+
+	size_t GetFileCount() const { return m_files.size(); }
+	const char *GetFileName(uint32_t file) const { return m_files[file].c_str(); }
+
+	// directory of the .dbg file, source file names are relative to the build directory
+	const std::string &GetDirectory() const { return m_directory; }
+
+protected:
+
+	std::vector<std::string>		m_files;
+	std::vector<Cc65SourceLine>		m_lines;
+	std::vector<std::string>		m_names;			// functions and labels
+
+	// per cpu address indices into m_lines / m_names, -1 when unknown
+	std::vector<int32_t>			m_addressLine;
+	std::vector<int32_t>			m_addressFunction;
+	std::vector<int32_t>			m_addressSymbol;
+
+	std::string		m_directory;
+	bool			m_loaded = false;
+
+private:
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Cc65DebugInfo.h"
+#include "Mos6502Profiler.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Per function and per source line cycle totals, built from the per PC cycles of a
+// Mos6502Profiler and the address to source mapping of a cc65 debug info file.
+// Times are reported in cycles per frame against the frame budget of the console's region.
+class Cc65SourceProfile
+{
+public:
+
+	Cc65SourceProfile();
+	~Cc65SourceProfile();
+
+	void Build(const Cc65DebugInfo &debugInfo, const Mos6502Profiler &profiler);
+
+	// the hottest 'numEntries' functions and source lines, with the line text when the source can be found.
+	// 'cyclesPerFrame' is the budget the percentages are against, NesCyclesPerFrame() of the region
+	void WriteReport(FILE *output, uint64_t numFrames, double cyclesPerFrame, uint32_t numEntries = 32) const;
+
+protected:
+
+	struct Entry
+	{
+		std::string	name;
+		uint32_t	file;		// source lines only
+		uint32_t	line;
+		uint64_t	cycles;
+	};
+
+	std::string ReadSourceLine(uint32_t file, uint32_t line) const;
+
+	const Cc65DebugInfo		*m_debugInfo = nullptr;
+
+	std::vector<Entry>		m_functions;
+	std::vector<Entry>		m_lines;
+	uint64_t				m_totalCycles = 0;
+	uint64_t				m_unknownCycles = 0;		// pcs with no debug info
+
+	// source files are loaded on demand for the report
+	mutable std::vector<std::vector<std::string>>	m_sources;
+	mutable std::vector<bool>						m_sourceLoaded;
+
+private:
+};
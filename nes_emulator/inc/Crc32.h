@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// standard CRC32 (zlib / No-Intro), used to identify rom data
+uint32_t Crc32(const uint8_t *data, size_t length);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Read only view of a file mapped into memory.
+// Used to open index files written by a previous run without reading
+// them into a buffer first. Windows and posix versions live in MappedFile.cpp
+class MappedFile
+{
+public:
+
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	// returns false if the file does not exist, is empty or could not be mapped
+	bool Open(const char *filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+
+	const uint8_t *GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+protected:
+
+	const uint8_t	*m_data = nullptr;
+	size_t			 m_size = 0;
+
+#ifdef _WIN32
+	void			*m_fileHandle = nullptr;
+	void			*m_mappingHandle = nullptr;
+#else
+	int				 m_fileDescriptor = -1;
+#endif
+
+private:
+};
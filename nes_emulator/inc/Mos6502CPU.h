@@ -2,26 +2,325 @@
 
 
 #include "NesMemory.h"
+#include "NesCpuBus.h"
+#include "Mos6502OpCodes.h"
+#include "Mos6502Profiler.h"
+#include "NesStateHash.h"
+#include <stdio.h>
 
-class Mos6502CPU
+// notified when the cpu enters or leaves a subroutine or interrupt handler
+class Mos6502CallObserver
 {
 public:
+	virtual ~Mos6502CallObserver() {}
 
-	Mos6502CPU();
-	~Mos6502CPU();
+	// JSR, 'sp' is the stack pointer after the return address has been pushed
+	virtual void OnCall(uint16_t target, uint8_t sp) = 0;
+
+	// NMI, IRQ or BRK. 'vector' is $FFFA or $FFFE, 'sp' is after PC and status have been pushed
+	virtual void OnInterrupt(uint16_t vector, uint16_t target, uint8_t sp, bool isBreak) = 0;
+
+	// RTS or RTI, 'sp' is after the return address has been pulled
+	virtual void OnReturn(uint8_t sp) = 0;
+
+	// TXS, the program moved the stack pointer itself (eg. LDX #$FF TXS at reset)
+	virtual void OnStackReset(uint8_t sp) = 0;
+};
+
+// cpu variants, the template parameter of Mos6502Core. Paths a variant does not have are
+// compiled out of its instantiation
+struct Ricoh2A03
+{
+	// the NES cpu, decimal mode was cut from the die. The D flag is stored but ignored
+	static const bool HasDecimalMode = false;
+	static constexpr const char *Name = "2A03";
+};
+
+struct Nmos6502
+{
+	// ADC / SBC work in BCD while D is set, N V Z are the NMOS ones (from the binary sum)
+	static const bool HasDecimalMode = true;
+	static constexpr const char *Name = "6502";
+};
+
+template<typename Variant>
+class Mos6502Core
+{
+public:
+
+	Mos6502Core();
+	~Mos6502Core();
 
 	void SetRomData(const RomBankMem *romMemory, uint8_t numRomBanks);
 
+	// puts the registers in their power-on state and loads PC from the reset vector at $FFFC
+	void Reset();
+
 	// Processes a single instruction and increments the Program Counter
+	// a pending NMI or IRQ is serviced instead of the next instruction
 	void Tick();
 
-	void PrintProgram();
+	// Tick() for the console's plain loop, common instruction pairs run as one superinstruction:
+	// DEX / DEY, CMP #, INC zp followed by BEQ / BNE and LDA #, zp, abs followed by STA zp, abs.
+	// 'cycleLimit' is the first cycle an interrupt or the end of the frame can happen at, the second
+	// instruction only joins when the first one ends before it, so nothing can tell the pair apart
+	// from two Tick() calls
+	void TickFused(uint64_t cycleLimit);
+
+	// instruction pairs TickFused() ran as one
+	uint64_t GetFusedCount() const { return m_fusedCount; }
+
+	// NMI is edge triggered, it is serviced once per call.
+	// IRQ is level triggered, it is serviced while the line is held and the I flag is clear
+	void TriggerNMI() { m_nmiPending = true; }
+	void SetIRQLine(bool active) { m_irqLine = active; }
+
+	// writes a disassembly of the rom banks to 'output'
+	void PrintProgram(FILE *output = stdout);
+
+	NesCpuBus &GetBus() { return m_bus; }
+
+	uint64_t GetCycles() const { return m_cycles; }
+
+	// true when the next Tick() services an interrupt instead of executing an instruction
+	bool IsInterruptPending() const { return m_nmiPending || (m_irqLine && !SR.I); }
+
+	// cycles the cpu is halted for, eg. OAM DMA
+	void AddCycles(uint32_t cycles) { m_cycles += cycles; }
+
+	uint16_t GetPC() const { return PC; }
+	void SetPC(uint16_t pc) { PC = pc; }
+	uint8_t GetSP() const { return SP; }
+	uint8_t GetA() const { return A; }
+	uint8_t GetX() const { return X; }
+	uint8_t GetY() const { return Y; }
+	uint8_t GetStatus() const { return SR.value; }
+
+	// test harnesses set up registers directly. the break bit is dropped and the unused bit set,
+	// as they are on the real status register
+	void SetRegisters(uint8_t a, uint8_t x, uint8_t y, uint8_t sp, uint8_t status)
+	{
+		A = a;
+		X = x;
+		Y = y;
+		SP = sp;
+		SR.value = (uint8_t)((status & 0xCF) | 0x20);
+	}
+
+	void SetCallObserver(Mos6502CallObserver *observer) { m_callObserver = observer; }
+
+	// registers, interrupt lines and cycle count. 'includeRam' adds the 2kb work ram and cartridge ram
+	void HashState(NesStateHasher &hasher, bool includeRam);
+
+#if NES_CPU_PROFILER
+	// counters are only collected when built with NES_CPU_PROFILER=1
+	void SetProfiler(Mos6502Profiler *profiler) { m_profiler = profiler; }
+#endif
 
 protected:
 
-	// pointer to rom banks - this is where the cpu instructions are fetched from.
-	const RomBankMem *m_rom;
-	uint8_t m_numRomBanks;
+	// Tick() and TickFused(), 'Fuse' compiles the superinstruction tails in
+	template<bool Fuse>
+	void Execute(uint64_t cycleLimit);
+
+	// superinstruction tails, run the next instruction as part of the current one when it is a
+	// BEQ / BNE (a STA to plain memory) and the current instruction ended before 'cycleLimit'
+	void FuseBranch(uint64_t cycleLimit)
+	{
+		const uint8_t *next = m_bus.GetReadPointer(PC);
+		if (m_cycles >= cycleLimit || next == nullptr || (*next != 0xF0 && *next != 0xD0))
+			return;
+
+		PC++;
+		m_cycles += 2;
+		m_fusedCount++;
+		Branch(*next == 0xF0 ? SR.Z : !SR.Z);
+	}
+	void FuseStore(uint64_t cycleLimit);
+
+	uint8_t Read(uint16_t address) { return m_bus.Read(address); }
+	void Write(uint16_t address, uint8_t value) { m_bus.Write(address, value); }
+	uint16_t Read16(uint16_t address) { return (uint16_t)(Read(address) | (Read((uint16_t)(address + 1)) << 8)); }
+
+	// zero page and stack accesses, 'address' is below $0200. They go straight to memory when the bus
+	// has pages 0 and 1 in plain memory (the NES work ram), only debugger traps and test harnesses
+	// send them through the page table
+	uint8_t ReadLow(uint16_t address)
+	{
+		const uint8_t *low = m_bus.GetLowPages();
+		return low != nullptr ? low[address] : Read(address);
+	}
+	void WriteLow(uint16_t address, uint8_t value)
+	{
+		uint8_t *low = m_bus.GetLowPages();
+		if (low != nullptr)
+			low[address] = value;
+		else
+			Write(address, value);
+	}
+
+	// 16 bit pointer in the zero page, the high byte wraps around to $00
+	uint16_t ReadPointer(uint8_t pointer)
+	{
+		const uint8_t *low = m_bus.GetLowPages();
+		if (low != nullptr)
+			return (uint16_t)(low[pointer] | (low[(uint8_t)(pointer + 1)] << 8));
+		return (uint16_t)(Read(pointer) | (Read((uint8_t)(pointer + 1)) << 8));
+	}
+
+	void Push(uint8_t value) { WriteLow(0x0100 | SP--, value); }
+	uint8_t Pull() { return ReadLow(0x0100 | ++SP); }
+	void Push16(uint16_t value) { Push((uint8_t)(value >> 8)); Push((uint8_t)value); }
+	uint16_t Pull16() { uint8_t lo = Pull(); return (uint16_t)(lo | (Pull() << 8)); }
+
+	// Addressing modes
+	// every operation is written once against Operand() / Store() / Modify(), which are instantiated
+	// per addressing mode so the effective address logic and the zero page fast path compile into each case
+	static constexpr bool IsZeroPage(Mos6502AddressingMode mode)
+	{
+		return mode == ADDR_ZEROPAGE || mode == ADDR_ZEROPAGE_X || mode == ADDR_ZEROPAGE_Y;
+	}
+
+	// returns the effective address and moves PC past the operand. 'PagePenalty' takes the extra cycle
+	// of read instructions when indexing crosses a page, stores and read-modify-writes always pay it
+	// in their base cycle count
+	template<Mos6502AddressingMode Mode, bool PagePenalty = false>
+	uint16_t Address()
+	{
+		static_assert(Mode >= ADDR_IMMEDIATE && Mode != ADDR_RELATIVE && Mode != ADDR_INDIRECT, "no operand address");
+
+		switch (Mode)
+		{
+		case ADDR_IMMEDIATE:	return PC++;
+		case ADDR_ZEROPAGE:		return Read(PC++);
+		case ADDR_ZEROPAGE_X:	return (uint8_t)(Read(PC++) + X);
+		case ADDR_ZEROPAGE_Y:	return (uint8_t)(Read(PC++) + Y);
+		case ADDR_ABSOLUTE:		{ uint16_t address = Read16(PC); PC += 2; return address; }
+		case ADDR_ABSOLUTE_X:	return AddIndex<PagePenalty>(Address<ADDR_ABSOLUTE>(), X);
+		case ADDR_ABSOLUTE_Y:	return AddIndex<PagePenalty>(Address<ADDR_ABSOLUTE>(), Y);
+		case ADDR_INDIRECT_X:	return ReadPointer((uint8_t)(Read(PC++) + X));
+		case ADDR_INDIRECT_Y:	return AddIndex<PagePenalty>(ReadPointer(Read(PC++)), Y);
+		default:				return 0;
+		}
+	}
+
+	template<bool PagePenalty>
+	uint16_t AddIndex(uint16_t base, uint8_t index)
+	{
+		uint16_t address = (uint16_t)(base + index);
+		if (PagePenalty && ((base ^ address) & 0xFF00))
+			m_cycles++;
+		return address;
+	}
+
+	// the operand of a read instruction
+	template<Mos6502AddressingMode Mode>
+	uint8_t Operand()
+	{
+		if (IsZeroPage(Mode))
+			return ReadLow(Address<Mode>());
+		return Read(Address<Mode, true>());
+	}
+
+	template<Mos6502AddressingMode Mode>
+	void Store(uint8_t value)
+	{
+		if (IsZeroPage(Mode))
+			WriteLow(Address<Mode>(), value);
+		else
+			Write(Address<Mode>(), value);
+	}
+
+	// read-modify-write, 'Operation' is one of the shifts, INC / DEC or their unofficial combinations
+	template<Mos6502AddressingMode Mode, uint8_t (Mos6502Core::*Operation)(uint8_t)>
+	void Modify()
+	{
+		uint16_t address = Address<Mode>();
+		if (IsZeroPage(Mode))
+			WriteLow(address, (this->*Operation)(ReadLow(address)));
+		else
+			Write(address, (this->*Operation)(Read(address)));
+	}
+
+	uint16_t ReadIndirectJumpTarget(uint16_t pointer);
+
+	// Operations, see the instruction set comments in Tick()
+	void ADC(uint8_t value)
+	{
+		if (Variant::HasDecimalMode && SR.D)
+			AddDecimal(value);
+		else
+			AddBinary(value);
+	}
+	void SBC(uint8_t value)
+	{
+		if (Variant::HasDecimalMode && SR.D)
+			SubtractDecimal(value);
+		else
+			AddBinary((uint8_t)~value);
+	}
+	void AddBinary(uint8_t value);
+	void AddDecimal(uint8_t value);
+	void SubtractDecimal(uint8_t value);
+	void AND(uint8_t value) { A &= value; SetZN(A); }
+	void EOR(uint8_t value) { A ^= value; SetZN(A); }
+	void ORA(uint8_t value) { A |= value; SetZN(A); }
+	void BIT(uint8_t value);
+	void Compare(uint8_t reg, uint8_t value);
+	void Branch(bool condition);
+	uint8_t ASL(uint8_t value);
+	uint8_t LSR(uint8_t value);
+	uint8_t ROL(uint8_t value);
+	uint8_t ROR(uint8_t value);
+	uint8_t INC(uint8_t value) { return Load((uint8_t)(value + 1)); }
+	uint8_t DEC(uint8_t value) { return Load((uint8_t)(value - 1)); }
+	uint8_t Load(uint8_t value) { SetZN(value); return value; }
+
+	// Unofficial operations, see the unofficial opcode comments in Tick().
+	// the read-modify-write ones are an official shift / increment followed by an official operation on A
+	uint8_t SLO(uint8_t value) { value = ASL(value); ORA(value); return value; }
+	uint8_t RLA(uint8_t value) { value = ROL(value); AND(value); return value; }
+	uint8_t SRE(uint8_t value) { value = LSR(value); EOR(value); return value; }
+	uint8_t RRA(uint8_t value) { value = ROR(value); ADC(value); return value; }
+	uint8_t DCP(uint8_t value) { value = (uint8_t)(value - 1); Compare(A, value); return value; }
+	uint8_t ISC(uint8_t value) { value = (uint8_t)(value + 1); SBC(value); return value; }
+	void LAX(uint8_t value) { A = X = Load(value); }
+	void ANC(uint8_t value) { AND(value); SR.C = SR.N; }
+	void ALR(uint8_t value) { A = LSR(A & value); }
+	void ARR(uint8_t value);
+	void SBX(uint8_t value) { uint8_t ax = A & X; SR.C = ax >= value; X = Load((uint8_t)(ax - value)); }
+	void LAS(uint8_t value) { A = X = SP = Load(value & SP); }
+	// SHA, SHX, SHY and TAS store 'value' AND the high byte of 'base' + 1. When indexing crosses
+	// a page the stored value replaces the high byte of the address as well
+	void StoreHighAnd(uint16_t base, uint8_t index, uint8_t value);
+
+	void SetZN(uint8_t value) { SR.Z = value == 0; SR.N = value >> 7; }
+
+	// pushes PC and the status register then jumps through 'vector'
+	void Interrupt(uint16_t vector, bool isBreak);
+
+	// the break flag and unused bit only exist on the stack copy of the status register
+	void PushStatus(bool isBreak) { Push((uint8_t)(SR.value | 0x20 | (isBreak ? 0x10 : 0x00))); }
+	void PullStatus() { SR.value = (uint8_t)((Pull() & 0xCF) | 0x20); }
+
+	// pointer to rom banks - mapped into the cpu address space by m_bus
+	const RomBankMem *m_rom = nullptr;
+	uint8_t m_numRomBanks = 0;
+
+	// all memory accesses go through the bus page table
+	NesCpuBus m_bus;
+
+	uint64_t m_cycles = 0;
+	uint64_t m_fusedCount = 0;
+	bool m_nmiPending = false;
+	bool m_irqLine = false;
+
+	// only checked by JSR, RTS, RTI and interrupts
+	Mos6502CallObserver *m_callObserver = nullptr;
+
+#if NES_CPU_PROFILER
+	Mos6502Profiler *m_profiler = nullptr;
+#endif
 
 	uint16_t PC;	// Program Counter
 	uint8_t SP;		// stack pointer
@@ -58,8 +357,13 @@ protected:
 			uint8_t V	: 1;
 			uint8_t N	: 1;
 		};
+
+		uint8_t value;
 	} SR;
 	
 
 private:
-};
\ No newline at end of file
+};
+
+// the NES build, the tools that only ever deal with NES code use this
+typedef Mos6502Core<Ricoh2A03> Mos6502CPU;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Mos6502CPU.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <unordered_map>
+
+// Tracks the guest call stack from JSR / RTS / RTI and interrupt entry and counts samples
+// against the current stack. Samples are taken by the caller every N cpu cycles, so each
+// sample is worth N cycles of the frame budget.
+//
+// Output is the folded stack format read by flamegraph.pl and speedscope:
+//	RESET_8000;L_80A2;L_8123 42
+class Mos6502CallStackProfiler : public Mos6502CallObserver
+{
+public:
+
+	// returns a name for a routine address or nullptr to use the default L_XXXX label
+	typedef const char *(*SymbolResolver)(void *context, uint16_t address);
+
+	enum FrameKind : uint8_t
+	{
+		FRAME_RESET,
+		FRAME_CALL,
+		FRAME_NMI,
+		FRAME_IRQ,
+		FRAME_BRK,
+	};
+
+	Mos6502CallStackProfiler();
+	~Mos6502CallStackProfiler();
+
+	// clears all samples and starts a new stack rooted at the reset entry point
+	void Reset(uint16_t entryPoint, uint8_t sp);
+
+	// counts one sample against the current stack
+	void Sample(uint8_t sp)
+	{
+		// frames left by stack manipulation rather than RTS / RTI
+		if (m_stack.size() > 1 && m_stack.back().depth > GetStackDepth(sp))
+			PopFrames(sp);
+
+		m_nodes[m_stack.back().node].samples++;
+		m_totalSamples++;
+	}
+
+	void OnCall(uint16_t target, uint8_t sp) override;
+	void OnInterrupt(uint16_t vector, uint16_t target, uint8_t sp, bool isBreak) override;
+	void OnReturn(uint8_t sp) override;
+	void OnStackReset(uint8_t sp) override;
+
+	void SetSymbolResolver(SymbolResolver resolver, void *context) { m_resolver = resolver; m_resolverContext = context; }
+
+	uint64_t GetTotalSamples() const { return m_totalSamples; }
+	size_t GetDepth() const { return m_stack.size(); }
+
+	// one line per distinct stack: frames separated by ';' followed by the sample count
+	bool WriteFolded(const char *filename) const;
+	void WriteFolded(FILE *output) const;
+
+protected:
+
+	struct Node
+	{
+		uint32_t	parent;
+		uint16_t	address;
+		uint8_t		kind;
+		uint64_t	samples;
+	};
+
+	struct Frame
+	{
+		uint32_t	node;
+		uint8_t		depth;	// GetStackDepth() on entry, the frame is live while the depth is at least this
+	};
+
+	// bytes pushed since the root frame. The stack pointer wraps, programs commonly start it at $00
+	// or $FF with TXS, so raw stack pointers can not be compared
+	uint8_t GetStackDepth(uint8_t sp) const { return (uint8_t)(m_rootSp - sp); }
+
+	void PushFrame(uint16_t address, uint8_t kind, uint8_t sp);
+	void PopFrames(uint8_t sp);
+	void FormatFrame(const Node &node, char *text, size_t size) const;
+
+	// the call tree, children are found by (parent node << 24 | kind << 16 | address)
+	std::vector<Node>						m_nodes;
+	std::unordered_map<uint64_t, uint32_t>	m_children;
+	std::vector<Frame>						m_stack;
+	uint8_t									m_rootSp = 0xFD;	// stack pointer of the root frame
+
+	uint64_t m_totalSamples = 0;
+
+	SymbolResolver	 m_resolver = nullptr;
+	void			*m_resolverContext = nullptr;
+
+private:
+};
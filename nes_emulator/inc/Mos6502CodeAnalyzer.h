@@ -0,0 +1,67 @@
+#pragma once
+
+#include "NesMemory.h"
+#include <vector>
+
+class Mos6502Disassembler;
+
+// Separates code from data in the rom banks by following control flow.
+// Starts at the NMI, RESET and IRQ vectors at the end of the last bank and walks
+// every branch, JMP and JSR target with a worklist. Bytes reached this way are marked
+// as code in a bitmap, everything else is treated as data.
+//
+// Addresses are resolved using the power-on layout: the first bank at $8000 and the
+// last bank at $C000. A single bank rom is mirrored into both.
+class Mos6502CodeAnalyzer
+{
+public:
+
+	Mos6502CodeAnalyzer();
+	~Mos6502CodeAnalyzer();
+
+	void Analyze(const RomBankMem *romBanks, uint8_t numRomBanks);
+
+	// listing of the analyzed banks with labels on every jump and branch target
+	void WriteListing(Mos6502Disassembler &disassembler) const;
+
+	bool IsCode(uint32_t prgOffset) const { return TestBit(m_codeBits, prgOffset); }
+	bool IsInstructionStart(uint32_t prgOffset) const { return TestBit(m_instructionBits, prgOffset); }
+	bool HasLabel(uint16_t cpuAddress) const { return TestBit(m_labelBits, cpuAddress); }
+
+	const uint8_t *GetPrg() const { return m_prg; }
+	uint32_t GetCodeByteCount() const { return m_numCodeBytes; }
+	uint32_t GetPrgSize() const { return m_prgSize; }
+
+	uint16_t GetNmiVector() const { return m_nmiVector; }
+	uint16_t GetResetVector() const { return m_resetVector; }
+	uint16_t GetIrqVector() const { return m_irqVector; }
+
+	// -1 when the address is not mapped to the rom
+	int32_t CpuToPrgOffset(uint16_t cpuAddress) const;
+	uint16_t PrgOffsetToCpu(uint32_t prgOffset) const;
+
+protected:
+
+	static bool TestBit(const std::vector<uint8_t> &bits, uint32_t index) { return (bits[index >> 3] >> (index & 7)) & 1; }
+	static void SetBit(std::vector<uint8_t> &bits, uint32_t index) { bits[index >> 3] |= (uint8_t)(1 << (index & 7)); }
+
+	void AddEntryPoint(uint16_t cpuAddress);
+	void TraceFrom(uint16_t cpuAddress);
+
+	const uint8_t	*m_prg = nullptr;
+	uint32_t		 m_prgSize = 0;
+	uint8_t			 m_numRomBanks = 0;
+
+	uint16_t m_nmiVector = 0;
+	uint16_t m_resetVector = 0;
+	uint16_t m_irqVector = 0;
+
+	std::vector<uint8_t> m_codeBits;			// 1 bit per prg byte, set for every byte of a decoded instruction
+	std::vector<uint8_t> m_instructionBits;		// 1 bit per prg byte, set on the opcode byte
+	std::vector<uint8_t> m_labelBits;			// 1 bit per cpu address, set on jump and branch targets
+	std::vector<uint16_t> m_worklist;
+
+	uint32_t m_numCodeBytes = 0;
+
+private:
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "NesMemory.h"
+#include <stdio.h>
+#include <vector>
+
+// Table driven 6502 disassembler.
+// Lines are formatted into a reusable text buffer, eg:
+//		C000  4C F5 C5  JMP $C5F5
+// When an output file is set the buffer is written out in bulk each time it fills,
+// otherwise it grows and the text can be read back with GetText()
+class Mos6502Disassembler
+{
+public:
+
+	Mos6502Disassembler(size_t bufferSize = 1 << 20);
+	~Mos6502Disassembler();
+
+	void SetOutput(FILE *output) { m_output = output; }
+
+	// linear sweep over 'length' bytes, the first byte is mapped to cpuAddress
+	void Disassemble(const uint8_t *data, uint32_t length, uint16_t cpuAddress);
+
+	// disassembles each 16kb bank at the cpu address it maps to, banks are split across
+	// worker threads and merged back in bank order. numThreads of 0 uses the hardware thread count
+	void DisassembleBanks(const RomBankMem *romBanks, uint32_t numRomBanks, unsigned int numThreads = 0);
+
+	// formats a single instruction and returns the number of bytes consumed.
+	// 'available' limits how many bytes can be read, truncated instructions are output as data.
+	// endLine = false leaves the line open so more columns can be appended
+	uint32_t FormatInstruction(const uint8_t *data, uint32_t available, uint16_t cpuAddress, bool endLine = true);
+
+	// data bytes as ".db" lines, 8 bytes per line
+	void FormatData(const uint8_t *data, uint32_t count, uint16_t cpuAddress);
+
+	// "L_C123:" line
+	void FormatLabel(uint16_t cpuAddress);
+
+	void AppendText(const char *text);
+	void AppendText(const char *text, size_t length);
+
+	// optional 64k bit set of cpu addresses that have labels. jump, call and branch
+	// operands that hit a label are printed as L_XXXX instead of $XXXX
+	void SetLabels(const std::vector<uint8_t> *labelBits) { m_labelBits = labelBits; }
+
+	// writes anything buffered to the output file
+	void Flush();
+
+	// clears the buffer without writing it
+	void Clear() { m_length = 0; }
+
+	const char *GetText() const { return m_buffer.data(); }
+	size_t GetLength() const { return m_length; }
+
+protected:
+
+	// makes sure at least 'bytes' can be appended
+	void Reserve(size_t bytes);
+
+	void AppendHex8(uint8_t value);
+	void AppendHex16(uint16_t value);
+	void AppendChar(char c) { m_buffer[m_length++] = c; }
+	void AppendTarget(uint16_t address);
+
+	std::vector<char>	m_buffer;
+	size_t				m_length = 0;
+	FILE				*m_output = nullptr;
+
+	const std::vector<uint8_t> *m_labelBits = nullptr;
+
+private:
+};
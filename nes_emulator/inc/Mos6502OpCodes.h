@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+// Addressing modes, see the opcode comments in Mos6502CPU.cpp
+enum Mos6502AddressingMode : uint8_t
+{
+	ADDR_IMPLIED,
+	ADDR_ACCUMULATOR,
+	ADDR_IMMEDIATE,
+	ADDR_ZEROPAGE,
+	ADDR_ZEROPAGE_X,
+	ADDR_ZEROPAGE_Y,
+	ADDR_RELATIVE,
+	ADDR_ABSOLUTE,
+	ADDR_ABSOLUTE_X,
+	ADDR_ABSOLUTE_Y,
+	ADDR_INDIRECT,
+	ADDR_INDIRECT_X,
+	ADDR_INDIRECT_Y,
+};
+
+enum Mos6502OpCodeFlags : uint16_t
+{
+	OPCODE_READ			= 1 << 0,	// reads the operand from memory
+	OPCODE_WRITE		= 1 << 1,	// writes the result to memory
+	OPCODE_BRANCH		= 1 << 2,	// conditional relative branch
+	OPCODE_JUMP			= 1 << 3,	// JMP
+	OPCODE_CALL			= 1 << 4,	// JSR
+	OPCODE_RETURN		= 1 << 5,	// RTS, RTI
+	OPCODE_BREAK		= 1 << 6,	// BRK
+	OPCODE_PAGE_PENALTY	= 1 << 7,	// +1 cycle when the indexed address crosses a page
+	OPCODE_HALT			= 1 << 8,	// JAM, locks up the cpu
+	OPCODE_UNOFFICIAL	= 1 << 9,	// undocumented opcode, nestest style listings mark it with '*'
+
+	// anything that transfers control ends a basic block
+	OPCODE_BLOCK_END	= OPCODE_BRANCH | OPCODE_JUMP | OPCODE_CALL | OPCODE_RETURN | OPCODE_BREAK | OPCODE_HALT,
+};
+
+struct Mos6502OpCode
+{
+	const char *mnemonic;		// nullptr for opcodes that are not decoded
+	uint8_t mode;				// Mos6502AddressingMode
+	uint8_t bytes;				// instruction length including the opcode
+	uint8_t cycles;				// base cycle count
+	uint16_t flags;				// Mos6502OpCodeFlags
+};
+
+// indexed by opcode
+extern const Mos6502OpCode Mos6502OpCodeTable[256];
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Per opcode and per PC execution / cycle counters.
+// The CPU only records into a profiler when built with NES_CPU_PROFILER=1, in the default
+// build the hook is compiled out of Tick() entirely.
+#ifndef NES_CPU_PROFILER
+	#define NES_CPU_PROFILER 0
+#endif
+
+class Mos6502Profiler
+{
+public:
+
+	Mos6502Profiler();
+	~Mos6502Profiler();
+
+	void Reset();
+
+	void Record(uint16_t pc, uint8_t opCode, uint32_t cycles)
+	{
+		m_opCount[opCode]++;
+		m_opCycles[opCode] += cycles;
+		m_pcCount[pc]++;
+		m_pcCycles[pc] += cycles;
+	}
+
+	uint64_t GetOpCount(uint8_t opCode) const { return m_opCount[opCode]; }
+	uint64_t GetOpCycles(uint8_t opCode) const { return m_opCycles[opCode]; }
+	uint64_t GetPCCount(uint16_t pc) const { return m_pcCount[pc]; }
+	uint64_t GetPCCycles(uint16_t pc) const { return m_pcCycles[pc]; }
+
+	uint64_t GetTotalInstructions() const;
+	uint64_t GetTotalCycles() const;
+
+	// opcodes, addressing modes and the hottest 'numAddresses' PCs, sorted by cycles
+	void WriteReport(FILE *output, uint32_t numAddresses = 32) const;
+
+	// one row per executed opcode followed by one row per executed PC
+	bool WriteCsv(const char *filename) const;
+
+protected:
+
+	uint64_t m_opCount[256];
+	uint64_t m_opCycles[256];
+
+	std::vector<uint64_t> m_pcCount;
+	std::vector<uint64_t> m_pcCycles;
+
+private:
+};
@@ -0,0 +1,88 @@
+/*
+Description:
+	Headless cpu conformance runs, a quick correctness check after changes to the cpu core.
+
+	- flat binaries (eg. Klaus Dormann's 6502_functional_test.bin) are loaded into a flat 64kb
+	  address space and run until they trap: an instruction that jumps or branches to itself.
+	  The test passed when it trapped at the success address. The 2A03 has no decimal mode,
+	  the functional test needs to be assembled with disable_decimal = 1 unless it runs on
+	  the NMOS 6502 variant (decimalMode).
+	- .nes roms (eg. nestest.nes) run on the console, so the ppu position and cycle counts
+	  match nestest.log.
+
+	Either can be checked against a golden log in nestest.log format, the pc, registers and
+	cycle count of every instruction are compared and the first difference stops the run.
+*/
+
+#pragma once
+
+#include "Mos6502CPU.h"
+#include "NesRom.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct Mos6502TraceEntry;
+
+struct Mos6502TestOptions
+{
+	uint16_t	loadAddress = 0x0000;			// flat binaries
+	int32_t		startPc = -1;					// -1 starts at the golden log's first pc, or the reset vector
+	int32_t		successPc = -1;					// flat binaries, trapping here means the test passed
+	bool		decimalMode = false;			// flat binaries, run on the NMOS 6502 with BCD instead of the 2A03
+	uint64_t	maxInstructions = 200000000;
+};
+
+struct Mos6502TestResult
+{
+	bool		passed = false;
+	uint64_t	instructions = 0;
+	uint64_t	cycles = 0;
+	double		seconds = 0.0;
+	uint16_t	stopPc = 0;
+	std::string	message;						// why the run stopped
+};
+
+class Mos6502TestRunner
+{
+public:
+
+	Mos6502TestRunner();
+	~Mos6502TestRunner();
+
+	// nestest.log format, only the pc, registers and CYC: are compared
+	bool LoadGoldenLog(const char *filename);
+	bool HasGoldenLog() const { return !m_golden.empty(); }
+
+	// false when the binary can not be loaded, otherwise 'result' holds the verdict
+	bool RunFlatBinary(const char *filename, const Mos6502TestOptions &options, Mos6502TestResult &result);
+
+	// runs until the golden log is used up, the rom traps or 'maxInstructions'. Without a golden
+	// log the nestest result codes at $02 / $03 decide the verdict
+	bool RunNesRom(NesCartridge &rom, const Mos6502TestOptions &options, Mos6502TestResult &result);
+
+protected:
+
+	struct GoldenLine
+	{
+		uint16_t	pc;
+		uint8_t		a, x, y, p, sp;
+		bool		hasCycles;
+		uint64_t	cycles;
+		std::string	text;
+	};
+
+	static bool ParseGoldenLine(const char *text, GoldenLine &line);
+
+	// RunFlatBinary() once 'memory' holds the binary
+	template<typename Variant>
+	void RunFlatMemory(std::vector<uint8_t> &memory, const Mos6502TestOptions &options, Mos6502TestResult &result);
+
+	// true when 'entry' matches golden line 'index', otherwise describes the difference in 'result'
+	bool CheckGolden(size_t index, const Mos6502TraceEntry &entry, Mos6502TestResult &result);
+
+	std::vector<GoldenLine>	m_golden;
+
+private:
+};
@@ -0,0 +1,148 @@
+/*
+Description:
+	Binary execution trace, one fixed size entry per instruction.
+
+	The emulation thread pushes entries into a lock free ring, a background thread drains it,
+	delta compresses the entries in chunks and writes them to disk. Formatting text is left to
+	the reader, which can convert a trace to the nestest.log format:
+		C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+
+	File layout:
+		TraceFileHeader
+		{ TraceChunkHeader, compressed entries }[]
+
+	Chunks are compressed independently so a reader can skip whole chunks.
+	Each entry is encoded against the previous one as a change mask followed by the changed fields,
+	the pc is predicted from the previous instruction length, the opcode bytes from the last
+	instruction at the same pc and the ppu position from the cycle delta.
+*/
+
+#pragma once
+
+#include "SpscRing.h"
+
+class Mos6502Disassembler;
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#pragma pack(push, 1)
+struct Mos6502TraceEntry
+{
+	uint64_t cycles;						// cpu cycle count before the instruction
+	uint16_t pc;
+	uint8_t bytes[3];						// opcode and operand bytes, unused bytes are whatever follows
+	uint8_t a;
+	uint8_t x;
+	uint8_t y;
+	uint8_t p;
+	uint8_t sp;
+	uint16_t scanline;
+	uint16_t dot;
+	uint8_t reserved[2];
+};
+
+struct TraceFileHeader
+{
+	char magic[4];							// "NTRC"
+	uint32_t version;
+	uint32_t entrySize;
+	uint32_t reserved;
+};
+
+struct TraceChunkHeader
+{
+	uint32_t numEntries;
+	uint32_t compressedSize;
+};
+#pragma pack(pop)
+
+class Mos6502TraceWriter
+{
+public:
+
+	static const uint32_t TraceVersion = 1;
+	static const uint32_t ChunkEntries = 1 << 16;
+
+	Mos6502TraceWriter();
+	~Mos6502TraceWriter();
+
+	// starts the writer thread. 'ringEntries' is how far emulation can run ahead of the disk
+	bool Open(const char *filename, size_t ringEntries = 1 << 20);
+
+	// writes out everything recorded so far and stops the writer thread
+	bool Close();
+
+	void Record(const Mos6502TraceEntry &entry)
+	{
+		if (!m_ring.TryPush(entry))
+			RecordFull(entry);
+	}
+
+	uint64_t GetEntryCount() const { return m_entryCount; }
+	uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+protected:
+
+	// the writer has fallen behind, waits for space rather than dropping entries
+	void RecordFull(const Mos6502TraceEntry &entry);
+
+	void WriterThread();
+
+	SpscRing<Mos6502TraceEntry>	m_ring;
+	std::thread					m_thread;
+	std::atomic<bool>			m_stop;
+	bool						m_writeFailed = false;
+
+	FILE		*m_file = nullptr;
+	uint64_t	 m_entryCount = 0;
+	uint64_t	 m_bytesWritten = 0;
+
+private:
+};
+
+class Mos6502TraceReader
+{
+public:
+
+	Mos6502TraceReader();
+	~Mos6502TraceReader();
+
+	bool Open(const char *filename);
+	void Close();
+
+	// false at the end of the trace or on a damaged chunk, HasFailed() tells them apart
+	bool Next(Mos6502TraceEntry &entry)
+	{
+		if (m_position == m_entries.size() && !ReadChunk())
+			return false;
+
+		entry = m_entries[m_position++];
+		return true;
+	}
+
+	// true once a chunk was damaged or cut short, the entries before it are still returned
+	bool HasFailed() const { return m_failed; }
+
+	// writes every remaining entry as a nestest.log line, false when the output could not be
+	// written or the trace is damaged
+	bool WriteNestestLog(FILE *output);
+
+	// replaces the text in 'line' with the nestest.log line for 'entry'
+	static void FormatNestestLine(const Mos6502TraceEntry &entry, Mos6502Disassembler &line);
+
+protected:
+
+	bool ReadChunk();
+
+	FILE								*m_file = nullptr;
+	std::vector<Mos6502TraceEntry>		 m_entries;
+	std::vector<uint8_t>				 m_compressed;
+	size_t								 m_position = 0;
+	bool								 m_failed = false;
+
+private:
+};
@@ -0,0 +1,90 @@
+/*
+Description:
+	Cross reference index of the traced code in a rom.
+	For every address: the JSR, JMP and branch instructions that target it and the
+	instructions that read or write it.
+
+	File layout:
+		XRefFileHeader
+		XRefEntry[numEntries]		sorted by target then source, searched in place once mapped
+
+	The header stores the CRC32 of the PRG data so a saved index is only reused for the same rom.
+*/
+
+#pragma once
+
+#include "NesMemory.h"
+#include "MappedFile.h"
+
+#include <utility>
+#include <vector>
+
+class Mos6502CodeAnalyzer;
+
+enum XRefKind : uint8_t
+{
+	XREF_CALL	= 1 << 0,	// JSR
+	XREF_JUMP	= 1 << 1,	// JMP
+	XREF_BRANCH	= 1 << 2,	// Bxx
+	XREF_READ	= 1 << 3,	// load, compare, arithmetic, read-modify-write, JMP ($xxxx) pointer
+	XREF_WRITE	= 1 << 4,	// store, read-modify-write
+};
+
+#pragma pack(push, 1)
+struct XRefFileHeader
+{
+	char magic[4];							// "NXRF"
+	uint32_t version;
+	uint32_t prgCrc32;
+	uint32_t prgSize;
+	uint32_t numEntries;
+};
+
+struct XRefEntry
+{
+	uint16_t target;						// cpu address being referenced, indexed modes store the base address
+	uint16_t sourceAddress;					// cpu address of the referencing instruction
+	uint32_t sourcePrgOffset;				// offset of the referencing instruction within the prg banks
+	uint8_t kind;							// XRefKind bits
+	uint8_t opCode;
+	uint8_t reserved[2];
+};
+#pragma pack(pop)
+
+class Mos6502XRefIndex
+{
+public:
+
+	Mos6502XRefIndex();
+	~Mos6502XRefIndex();
+
+	// collects references from every instruction the analyzer traced as code
+	void Build(const Mos6502CodeAnalyzer &analyzer);
+
+	bool Save(const char *filename) const;
+
+	// maps a saved index, fails if the file is invalid or was built from different prg data
+	bool Load(const char *filename, uint32_t prgCrc32);
+
+	uint32_t GetPrgCrc32() const { return m_prgCrc32; }
+	size_t GetCount() const { return m_count; }
+	const XRefEntry *GetEntries() const { return m_entries; }
+
+	// every reference to 'target', a binary search over the sorted entries
+	std::pair<const XRefEntry *, const XRefEntry *> Find(uint16_t target) const;
+
+	static const uint32_t IndexVersion = 1;
+
+protected:
+
+	// entries point either at m_built or into the mapped file
+	const XRefEntry		*m_entries = nullptr;
+	size_t				 m_count = 0;
+	uint32_t			 m_prgCrc32 = 0;
+	uint32_t			 m_prgSize = 0;
+
+	std::vector<XRefEntry>	m_built;
+	MappedFile				m_file;
+
+private:
+};
@@ -0,0 +1,209 @@
+/*
+Description:
+	2A03 audio processing unit: two pulse channels, triangle, noise and DMC, the frame counter
+	and its IRQ.
+
+	The apu is caught up lazily instead of being clocked every cpu cycle. Run() advances it to a
+	cpu cycle by jumping from one event to the next (a channel timer clock or a frame counter
+	step), the console calls it before every register access, when an IRQ is due and at the end
+	of each frame. Channels that cannot change their output (length counter expired, disabled,
+	ultrasonic triangle) are not clocked at all.
+
+	The five channel outputs are combined with the non linear mixer lookup tables and every
+	change of the mixed level goes into a BlipBuffer as a delta, so audio costs nothing per
+	cycle and the samples for a frame are made in one batch by EndFrame().
+
+	'Region' supplies the noise / DMC periods and the frame counter steps, see NesRegion.h.
+
+	Not modelled: DMC DMA cpu stalls, the frame counter's reset delay after a $4017 write.
+
+	https://wiki.nesdev.com/w/index.php/APU
+*/
+
+#pragma once
+
+#include "BlipBuffer.h"
+#include "NesRegion.h"
+#include "NesStateHash.h"
+
+#include <stdint.h>
+
+struct NesApuMixer;
+
+template<typename Region>
+class NesApuT
+{
+public:
+
+	static const uint32_t CpuClockRate = Region::CpuClockRate;
+
+	typedef uint8_t (*MemoryReader)(void *context, uint16_t address);
+
+	NesApuT();
+	~NesApuT();
+
+	// DMC sample fetches read the cpu address space through 'reader'
+	void SetMemoryReader(MemoryReader reader, void *context) { m_memoryReader = reader; m_memoryContext = context; }
+
+	// 0 disables sample output, the channels are still emulated
+	void SetSampleRate(uint32_t sampleRate);
+
+	// dynamic rate control, scales the sample rate by 'ratio' (close to 1.0)
+	void SetRateAdjust(double ratio) { m_blip.SetRateAdjust(ratio); }
+
+	// 'cycle' is the cpu cycle count at reset
+	void Reset(uint64_t cycle);
+
+	// advances to 'cycle', cpu cycles since power on
+	void Run(uint64_t cycle);
+
+	// the earliest cpu cycle the apu may raise its IRQ, Run() must be called when it is reached
+	uint64_t GetNextIrqCycle() const { return m_nextIrqCycle; }
+	bool IsIrqActive() const { return m_frameIrq || m_dmcIrq; }
+
+	// $4000 - $4017, the caller runs the apu to the access cycle first
+	uint8_t ReadStatus();
+	void WriteRegister(uint16_t address, uint8_t value);
+
+	// runs to 'cycle' and makes the samples for everything since the previous EndFrame()
+	void EndFrame(uint64_t cycle);
+
+	// samples of the last frame, mono 16 bit
+	const std::vector<int16_t> &GetSamples() const { return m_blip.GetSamples(); }
+	uint32_t GetSampleRate() const { return m_blip.GetSampleRate(); }
+
+	void HashState(NesStateHasher &hasher) const;
+
+protected:
+
+	static const uint64_t Never = UINT64_MAX;
+
+	struct Envelope
+	{
+		uint8_t		volume;				// constant volume or envelope period
+		bool		constant;
+		bool		loop;				// also halts the length counter
+		bool		start;
+		uint8_t		divider;
+		uint8_t		decay;
+
+		void Clock();
+		uint8_t Output() const { return constant ? volume : decay; }
+	};
+
+	struct Pulse
+	{
+		Envelope	envelope;
+		uint8_t		duty;
+		uint8_t		sequence;
+		uint16_t	period;
+		uint8_t		length;
+
+		bool		sweepEnabled;
+		bool		sweepNegate;
+		bool		sweepReload;
+		uint8_t		sweepPeriod;
+		uint8_t		sweepShift;
+		uint8_t		sweepDivider;
+
+		uint64_t	nextClock;
+
+		uint16_t SweepTarget(bool onesComplement) const;
+		uint8_t Output(bool onesComplement) const;
+	};
+
+	struct Triangle
+	{
+		bool		control;			// also halts the length counter
+		uint8_t		linearLoad;
+		uint8_t		linear;
+		bool		linearReload;
+		uint8_t		sequence;
+		uint16_t	period;
+		uint8_t		length;
+
+		uint64_t	nextClock;
+
+		bool IsRunning() const { return linear != 0 && length != 0 && period >= 2; }
+	};
+
+	struct Noise
+	{
+		Envelope	envelope;
+		bool		shortMode;
+		uint16_t	period;
+		uint16_t	shift;
+		uint8_t		length;
+
+		uint64_t	nextClock;
+	};
+
+	struct Dmc
+	{
+		bool		irqEnabled;
+		bool		loop;
+		uint16_t	period;
+		uint8_t		output;
+
+		uint16_t	sampleAddress;
+		uint16_t	sampleLength;
+		uint16_t	address;
+		uint16_t	bytesRemaining;
+
+		uint8_t		buffer;
+		bool		bufferFull;
+		uint8_t		shift;
+		uint8_t		bitsRemaining;
+		bool		silence;
+
+		uint64_t	nextClock;
+
+		bool IsIdle() const { return silence && !bufferFull && bytesRemaining == 0; }
+	};
+
+	void ClockQuarterFrame();
+	void ClockHalfFrame();
+	void ClockSweep(Pulse &pulse, bool onesComplement);
+
+	void ClockPulse(Pulse &pulse);
+	void ClockTriangle();
+	void ClockNoise();
+	void ClockDmc();
+	void FetchDmcSample();
+
+	// restarts channel timers that were parked at Never because their output could not change
+	void WakeChannels();
+	void UpdateNextIrqCycle();
+
+	// mixes the channel outputs and records the change at m_cycle
+	void UpdateOutput();
+
+	Pulse			m_pulse[2];
+	Triangle		m_triangle;
+	Noise			m_noise;
+	Dmc				m_dmc;
+
+	uint8_t			m_enabled = 0;				// $4015 channel enables
+	bool			m_fiveStep = false;
+	bool			m_irqInhibit = false;
+	bool			m_frameIrq = false;
+	bool			m_dmcIrq = false;
+	uint32_t		m_frameStep = 0;
+	uint64_t		m_nextFrameStep = 0;
+	uint64_t		m_frameSequenceStart = 0;
+
+	uint64_t		m_cycle = 0;
+	uint64_t		m_frameStartCycle = 0;		// start of the audio frame, delta times count from here
+	uint64_t		m_nextIrqCycle = Never;
+
+	MemoryReader	m_memoryReader = nullptr;
+	void			*m_memoryContext = nullptr;
+
+	const NesApuMixer	*m_mixer;
+	int32_t			m_level = 0;
+	BlipBuffer		m_blip;
+
+private:
+};
+
+typedef NesApuT<NesRegionNtsc> NesApu;
@@ -0,0 +1,143 @@
+/*
+Description:
+	Audio delivery from the emulation thread to an output device.
+
+	The emulation thread pushes each frame's samples into a lock free single producer / single
+	consumer ring and never waits: when the ring is full the excess is dropped and counted. A
+	device thread pulls fixed size periods from the ring at the sample rate and hands them to a
+	sink, an underrun is padded by holding the last sample and counted.
+
+	The emulated frame rate and the device's sample clock never quite agree (60.0988Hz frames on
+	a 60Hz display, crystal tolerances), so a fixed resampling ratio slowly drains or fills the
+	ring. Push() returns a ratio for the next frame's samples instead, moved up to 0.5% away from
+	1.0 in proportion to how far the fill level is from its target. That pitch change is
+	inaudible and keeps the latency at the target without ever resetting the buffer.
+
+	Sinks: a null sink, paced like a real device so headless runs see the latency and underruns
+	a sound card would, and a WAV file. A file has no clock, the device thread writes samples as
+	soon as they arrive and Push() waits for room instead of dropping, so a recording is complete
+	at any emulation speed.
+*/
+
+#pragma once
+
+#include "SpscRing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+// an output device, called from the device thread only
+class NesAudioSink
+{
+public:
+
+	virtual ~NesAudioSink() {}
+
+	virtual bool Open(uint32_t sampleRate) = 0;
+	virtual bool Write(const int16_t *samples, size_t count) = 0;
+	virtual bool Close() = 0;
+
+	// true when the sink consumes samples at the sample rate, like a sound card
+	virtual bool IsClocked() const { return true; }
+};
+
+// discards everything
+class NesNullSink : public NesAudioSink
+{
+public:
+
+	bool Open(uint32_t sampleRate) override { m_samplesWritten = 0; return true; }
+	bool Write(const int16_t *samples, size_t count) override { m_samplesWritten += count; return true; }
+	bool Close() override { return true; }
+
+	uint64_t GetSamplesWritten() const { return m_samplesWritten; }
+
+protected:
+
+	uint64_t	m_samplesWritten = 0;
+
+private:
+};
+
+// 16 bit mono PCM .wav, the sizes in the header are filled in by Close()
+class NesWavSink : public NesAudioSink
+{
+public:
+
+	explicit NesWavSink(const char *filename) : m_filename(filename) {}
+	~NesWavSink() { Close(); }
+
+	bool Open(uint32_t sampleRate) override;
+	bool Write(const int16_t *samples, size_t count) override;
+	bool Close() override;
+	bool IsClocked() const override { return false; }
+
+protected:
+
+	bool WriteHeader(uint32_t dataBytes);
+
+	const char	*m_filename;
+	FILE		*m_file = nullptr;
+	uint32_t	 m_sampleRate = 0;
+	uint64_t	 m_dataBytes = 0;
+	bool		 m_writeFailed = false;
+
+private:
+};
+
+class NesAudioStream
+{
+public:
+
+	// the largest change to the resampling ratio
+	static constexpr double MaxRateDelta = 0.005;
+
+	NesAudioStream();
+	~NesAudioStream();
+
+	// starts the device thread, which waits for the target fill before it starts pulling.
+	// 'latencyMs' is the target fill, the device period is added on top
+	bool Start(NesAudioSink *sink, uint32_t sampleRate, uint32_t latencyMs = 30, uint32_t periodSamples = 256);
+
+	// stops the device thread, writes what is left in the ring and closes the sink, false when the sink failed
+	bool Stop();
+
+	// emulation side, never blocks on a clocked sink. Returns the resampling ratio for the next
+	// frame's samples, always 1.0 for a sink without a clock
+	double Push(const int16_t *samples, size_t count);
+
+	uint64_t GetUnderrunSamples() const { return m_underrunSamples.load(std::memory_order_relaxed); }
+	uint64_t GetDroppedSamples() const { return m_droppedSamples; }
+
+	// fill level seen by Push(), in milliseconds
+	double GetAverageLatencyMs() const;
+	double GetMaxLatencyMs() const;
+	double GetLastRatio() const { return m_lastRatio; }
+
+protected:
+
+	void DeviceThread();
+
+	SpscRing<int16_t>		m_ring;
+	NesAudioSink			*m_sink = nullptr;
+	uint32_t				 m_sampleRate = 0;
+	uint32_t				 m_periodSamples = 0;
+	bool					 m_clocked = true;
+	size_t					 m_targetFill = 0;
+
+	std::thread				 m_thread;
+	std::atomic<bool>		 m_stop;
+	std::atomic<bool>		 m_sinkFailed;
+	std::atomic<uint64_t>	 m_underrunSamples;
+
+	// emulation side statistics
+	uint64_t				 m_droppedSamples = 0;
+	uint64_t				 m_fillSum = 0;
+	uint64_t				 m_fillCount = 0;
+	size_t					 m_maxFill = 0;
+	double					 m_lastRatio = 1.0;
+
+private:
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "Mos6502CPU.h"
+#include "NesApu.h"
+#include "NesPpu.h"
+#include "NesRegion.h"
+#include "NesRom.h"
+
+class Mos6502CallStackProfiler;
+class Mos6502TraceWriter;
+class NesDebugger;
+class NesHeatmap;
+struct Mos6502TraceEntry;
+
+// Wires the cpu, ppu and apu together and runs them in lock step, one instruction at a time.
+// The ppu is caught up after every instruction (or fused pair), 3 dots per cpu cycle on NTSC / Dendy
+// and 3.2 on PAL. The apu is only caught up when its registers are accessed, when its IRQ is due and
+// at the end of every frame.
+// 'Region' is one of the NesRegion.h structs, there is one instantiation per region in NesConsole.cpp.
+template<typename Region>
+class NesConsoleT
+{
+public:
+
+	NesConsoleT();
+	~NesConsoleT();
+
+	void LoadCartridge(NesCartridge &cartridge);
+
+	void Reset();
+
+	// runs until the ppu has finished the current frame
+	void RunFrame();
+
+	// runs one instruction (or interrupt entry) and catches the ppu up, without any debug hooks
+	void Step()
+	{
+		uint64_t cycles = m_cpu.GetCycles();
+		m_cpu.Tick();
+		EndStep(cycles);
+	}
+
+	// Step() that may run two instructions as one superinstruction, see Mos6502Core::TickFused().
+	// The state after every frame is the same as with Step(), only instruction boundaries inside
+	// a fused pair can not be observed
+	void StepFused()
+	{
+		uint64_t cycles = m_cpu.GetCycles();
+		if (cycles >= m_ppuEventCycle)
+			m_ppuEventCycle = GetPpuEventCycle(cycles);
+
+		uint64_t apuIrqCycle = m_apu.GetNextIrqCycle();
+		m_cpu.TickFused(m_ppuEventCycle < apuIrqCycle ? m_ppuEventCycle : apuIrqCycle);
+		EndStep(cycles);
+	}
+
+	// audio samples are made at the end of every frame, 0 to only emulate the apu
+	void SetAudioSampleRate(uint32_t sampleRate) { m_apu.SetSampleRate(sampleRate); }
+
+	// samples the profiler every 'sampleCycles' cpu cycles, nullptr to stop profiling
+	void SetCallStackProfiler(Mos6502CallStackProfiler *profiler, uint32_t sampleCycles);
+
+	// records the instructions executed between 'firstCycle' and 'lastCycle' into 'tracer', nullptr to stop tracing
+	void SetTracer(Mos6502TraceWriter *tracer, uint64_t firstCycle = 0, uint64_t lastCycle = UINT64_MAX)
+	{
+		m_tracer = tracer;
+		m_traceFirstCycle = firstCycle;
+		m_traceLastCycle = lastCycle;
+	}
+
+	// appends a full state hash to 'log' after every frame, and a cpu / ram hash every
+	// 'instructionInterval' instructions when it is not 0. nullptr to stop
+	void SetStateHashLog(NesStateHashLog *log, uint32_t instructionInterval = 0);
+
+	// hash of the cpu, ram and ppu state
+	uint64_t HashState();
+
+	// attaches a debugger, RunFrame() returns early when it breaks. nullptr to detach
+	void SetDebugger(NesDebugger *debugger);
+
+	// counts memory accesses into 'heatmap', one snapshot per frame. nullptr to stop
+	void SetHeatmap(NesHeatmap *heatmap);
+
+	// cpu registers, the bytes at pc and the ppu position, as recorded by the tracer
+	void CaptureTraceEntry(Mos6502TraceEntry &entry);
+
+	Mos6502CPU &GetCpu() { return m_cpu; }
+	NesPpu &GetPpu() { return m_ppu; }
+	NesApuT<Region> &GetApu() { return m_apu; }
+	uint64_t GetFrameCount() const { return m_ppu.GetFrameCount(); }
+
+protected:
+
+	// runs the ppu for 'cycles' cpu cycles, PAL carries the fractional dot over to the next call
+	void StepPpu(uint32_t cycles)
+	{
+		if (Region::PpuDotsDivisor == 1)
+			m_ppu.Step<Region>(cycles * Region::PpuDotsPerCycle);
+		else
+		{
+			uint32_t dots = cycles * Region::PpuDotsPerCycle + m_dotRemainder;
+			m_dotRemainder = dots % Region::PpuDotsDivisor;
+			m_ppu.Step<Region>(dots / Region::PpuDotsDivisor);
+		}
+	}
+
+	// catches the ppu up on the cycles run since 'cycles' and raises the interrupts that became due
+	void EndStep(uint64_t cycles)
+	{
+		StepPpu((uint32_t)(m_cpu.GetCycles() - cycles));
+
+		if (m_ppu.PollNmi())
+			m_cpu.TriggerNMI();
+		if (m_cpu.GetCycles() >= m_apu.GetNextIrqCycle())
+			RunApu();
+	}
+
+	// the first cpu cycle at which the ppu reaches vblank or the end of the frame. The ppu only moves
+	// with the cpu cycles, so it stays valid until the cpu gets there
+	uint64_t GetPpuEventCycle(uint64_t cycles) const
+	{
+		// rounded up, with the PAL fraction of a dot carried in
+		uint64_t dots = (uint64_t)m_ppu.GetDotsToNextEvent<Region>() * Region::PpuDotsDivisor - m_dotRemainder;
+		return cycles + (dots + Region::PpuDotsPerCycle - 1) / Region::PpuDotsPerCycle;
+	}
+
+	// RunFrame() with the debug hooks, kept separate so the plain loop has no checks in it
+	void RunFrameInstrumented();
+	// returns true when the debugger stops before the instruction at pc
+	bool DebugInstruction();
+
+	// catches the apu up to the cpu and updates the IRQ line
+	void RunApu()
+	{
+		m_apu.Run(m_cpu.GetCycles());
+		m_cpu.SetIRQLine(m_apu.IsIrqActive());
+	}
+
+	// DMC sample fetches
+	static uint8_t ApuMemoryRead(void *context, uint16_t address);
+
+	// $2000 - $3FFF
+	static uint8_t PpuRead(void *context, uint16_t address);
+	static void PpuWrite(void *context, uint16_t address, uint8_t value);
+
+	// $4000 - $40FF, apu and io registers
+	static uint8_t IoRead(void *context, uint16_t address);
+	static void IoWrite(void *context, uint16_t address, uint8_t value);
+
+	Mos6502CPU		m_cpu;
+	NesPpu			m_ppu;
+	NesApuT<Region>	m_apu;
+	uint32_t		m_dotRemainder = 0;		// ppu dots times PpuDotsDivisor not run yet
+	uint64_t		m_ppuEventCycle = 0;	// GetPpuEventCycle() for StepFused(), 0 to work it out again
+
+	Mos6502CallStackProfiler	*m_callStackProfiler = nullptr;
+	uint32_t					 m_sampleCycles = 0;
+	uint64_t					 m_nextSampleCycle = 0;
+
+	Mos6502TraceWriter			*m_tracer = nullptr;
+	uint64_t					 m_traceFirstCycle = 0;
+	uint64_t					 m_traceLastCycle = 0;
+
+	NesDebugger					*m_debugger = nullptr;
+	bool						 m_checkBlock = true;		// the next instruction starts a basic block
+	bool						 m_stepBreakpoints = false;	// the current block holds a breakpoint
+
+	NesHeatmap					*m_heatmap = nullptr;
+
+	NesStateHashLog				*m_stateHashLog = nullptr;
+	uint32_t					 m_hashInterval = 0;
+	uint32_t					 m_hashCountdown = 0;
+	uint64_t					 m_instructions = 0;		// instructions and interrupts, only counted by the instrumented loop
+
+private:
+};
+
+typedef NesConsoleT<NesRegionNtsc> NesConsole;
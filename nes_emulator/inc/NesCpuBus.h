@@ -0,0 +1,124 @@
+#pragma once
+
+#include "NesMemory.h"
+
+// CPU address space, split into 256 pages of 256 bytes.
+// each page either points straight at memory, or is routed through read / write handlers
+// for anything with side effects (PPU / APU registers, mappers)
+//
+// NES layout:
+//	$0000 - $1FFF	2kb work ram, mirrored 4 times
+//	$2000 - $5FFF	io registers, handlers
+//	$6000 - $7FFF	8kb cartridge ram
+//	$8000 - $FFFF	rom banks
+class NesCpuBus
+{
+public:
+
+	typedef uint8_t (*ReadHandler)(void *context, uint16_t address);
+	typedef void (*WriteHandler)(void *context, uint16_t address, uint8_t value);
+
+	// everything the bus knows about one page, used to temporarily replace a page (eg. debugger traps)
+	struct PageMapping
+	{
+		const uint8_t	*read;			// nullptr when reads go through the handler
+		uint8_t			*write;			// nullptr when writes go through the handler
+		const uint8_t	*peek;			// memory behind the page for Peek(), kept when the page is trapped
+		ReadHandler		 readHandler;
+		WriteHandler	 writeHandler;
+		void			*context;
+	};
+
+	NesCpuBus();
+	~NesCpuBus();
+
+	// maps rom banks at $8000 - $FFFF. The first bank is at $8000 and the last at $C000,
+	// a single bank is mirrored into both halves
+	void MapRomBanks(const RomBankMem *romBanks, uint8_t numRomBanks);
+
+	// points 'numPages' pages starting at 'firstPage' at 'memory', repeating every 'size' bytes.
+	// read only memory is mapped with writable = false, writes to it are ignored
+	void MapMemory(uint32_t firstPage, uint32_t numPages, uint8_t *memory, uint32_t size, bool writable);
+
+	// routes every access to the pages through the handlers
+	void MapHandlers(uint32_t firstPage, uint32_t numPages, ReadHandler read, WriteHandler write, void *context);
+
+	uint8_t Read(uint16_t address)
+	{
+		const uint8_t *page = m_readPages[address >> 8];
+		if (page != nullptr)
+			return page[address & 0xFF];
+
+		const PageHandlers &handlers = m_handlers[address >> 8];
+		return handlers.read(handlers.context, address);
+	}
+
+	void Write(uint16_t address, uint8_t value)
+	{
+		uint8_t *page = m_writePages[address >> 8];
+		if (page != nullptr)
+		{
+			page[address & 0xFF] = value;
+			return;
+		}
+
+		const PageHandlers &handlers = m_handlers[address >> 8];
+		handlers.write(handlers.context, address, value);
+	}
+
+	// the byte behind 'address' when its page points straight at memory, nullptr when it goes through
+	// the handlers. lets the cpu look ahead at code and check a store has no side effects
+	const uint8_t *GetReadPointer(uint16_t address) const
+	{
+		const uint8_t *page = m_readPages[address >> 8];
+		return page != nullptr ? page + (address & 0xFF) : nullptr;
+	}
+
+	uint8_t *GetWritePointer(uint16_t address) const
+	{
+		uint8_t *page = m_writePages[address >> 8];
+		return page != nullptr ? page + (address & 0xFF) : nullptr;
+	}
+
+	// pages 0 and 1 (zero page and stack) as one block of plain writable memory, nullptr when either goes
+	// through handlers or they are not next to each other. kept up to date by every mapping change
+	uint8_t *GetLowPages() const { return m_lowPages; }
+
+	PageMapping GetPageMapping(uint32_t page) const;
+	void SetPageMapping(uint32_t page, const PageMapping &mapping);
+
+	// reads memory without side effects, pages behind handlers read as open bus. used by debug tools
+	uint8_t Peek(uint16_t address) const
+	{
+		const uint8_t *page = m_peekPages[address >> 8];
+		return page != nullptr ? page[address & 0xFF] : (uint8_t)(address >> 8);
+	}
+
+	uint8_t *GetWorkRam() { return m_workRam.data; }
+	uint8_t *GetCartridgeRam() { return m_cartridgeRam.data; }
+
+protected:
+
+	struct PageHandlers
+	{
+		ReadHandler read;
+		WriteHandler write;
+		void *context;
+	};
+
+	void UpdateLowPages();
+
+	static uint8_t OpenBusRead(void *context, uint16_t address);
+	static void IgnoreWrite(void *context, uint16_t address, uint8_t value);
+
+	const uint8_t	*m_readPages[256];
+	uint8_t			*m_writePages[256];
+	const uint8_t	*m_peekPages[256];
+	PageHandlers	 m_handlers[256];
+	uint8_t			*m_lowPages = nullptr;
+
+	Memory<2048>	m_workRam;
+	Memory<8192>	m_cartridgeRam;
+
+private:
+};
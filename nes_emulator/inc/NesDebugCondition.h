@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// values a condition can refer to
+struct NesDebugContext
+{
+	uint16_t pc;
+	uint8_t a;
+	uint8_t x;
+	uint8_t y;
+	uint8_t sp;
+	uint8_t p;
+	uint8_t value;				// byte read or written by a watchpoint, 0 for breakpoints
+	uint16_t address;			// address accessed by a watchpoint, pc for breakpoints
+
+	// for [address], must not have side effects
+	uint8_t (*peek)(const void *peekContext, uint16_t address);
+	const void *peekContext;
+};
+
+// Breakpoint / watchpoint condition, compiled once into a small stack bytecode.
+//
+//	a == $10 && [$0300] != 0
+//	value > 127 || x >= 3
+//
+// Operands are numbers ($hex, 0xhex or decimal), the registers a x y sp p pc, 'value' and
+// 'addr' for the access that triggered a watchpoint, and [expr] for a byte of memory.
+// Operators by precedence: ! - (unary), + -, & | ^, == != < <= > >=, &&, ||
+class NesDebugCondition
+{
+public:
+
+	NesDebugCondition();
+	~NesDebugCondition();
+
+	// an empty expression is always true. on failure 'error' describes the problem
+	bool Compile(const char *expression, std::string &error);
+
+	bool IsEmpty() const { return m_code.empty(); }
+
+	bool Evaluate(const NesDebugContext &context) const;
+
+	static const int MaxStackDepth = 16;
+
+protected:
+
+	bool ParseOr();
+	bool ParseAnd();
+	bool ParseCompare();
+	bool ParseBitwise();
+	bool ParseSum();
+	bool ParseUnary();
+	bool ParsePrimary();
+
+	void SkipSpaces();
+	bool Match(const char *token);
+	void Emit(uint8_t op, int stackChange);
+	bool Fail(const char *message);
+
+	std::vector<uint8_t> m_code;
+
+	// compile state
+	const char	*m_text = nullptr;
+	const char	*m_position = nullptr;
+	int			 m_depth = 0;
+	int			 m_maxDepth = 0;
+	std::string	 m_error;
+
+private:
+};
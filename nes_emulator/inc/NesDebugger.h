@@ -0,0 +1,123 @@
+/*
+Description:
+	PC breakpoints and memory watchpoints, with optional conditions.
+
+	Nothing is checked unless a debugger is attached to the console, and then:
+	- breakpoints are only looked for when execution enters a basic block (after a branch, jump,
+	  call, return or interrupt). Blocks without a breakpoint run without further checks, blocks
+	  with one are stepped one instruction at a time until they are left.
+	- watched pages are swapped for trapping handlers in the cpu page table, accesses to
+	  every other page run at full speed.
+	- conditions are compiled to bytecode up front and only evaluated when the trap fires.
+*/
+
+#pragma once
+
+#include "NesCpuBus.h"
+#include "NesDebugCondition.h"
+#include "Mos6502CPU.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum NesWatchKind : uint8_t
+{
+	WATCH_READ		= 1 << 0,
+	WATCH_WRITE		= 1 << 1,
+};
+
+struct NesDebugHit
+{
+	uint8_t		kind;			// 0 for a breakpoint, otherwise the NesWatchKind of the access
+	uint16_t	address;		// breakpoint pc or accessed address
+	uint8_t		value;			// byte read or written
+	uint16_t	pc;				// instruction that hit
+	uint32_t	index;			// which breakpoint / watchpoint
+};
+
+class NesDebugger
+{
+public:
+
+	NesDebugger();
+	~NesDebugger();
+
+	// the condition may be empty, otherwise see NesDebugCondition
+	bool AddBreakpoint(uint16_t address, const char *condition, std::string &error);
+
+	// watches first - last inclusive. ram and ppu register mirrors are watched too
+	bool AddWatchpoint(uint16_t first, uint16_t last, uint8_t kinds, const char *condition, std::string &error);
+
+	// installs the watchpoint traps into the cpu's page table, Detach() restores the original pages
+	void Attach(Mos6502CPU &cpu);
+	void Detach();
+
+	// true when a breakpoint sits in the basic block starting at 'pc'
+	bool BlockHasBreakpoint(uint16_t pc);
+
+	bool IsBreakpoint(uint16_t pc) const { return m_breakpointBits[pc] != 0; }
+
+	// address of the instruction being executed, watchpoint hits report it
+	void SetInstructionPc(uint16_t pc) { m_instructionPc = pc; }
+
+	// reads memory without side effects, trapped pages keep their memory visible to Peek()
+	uint8_t Peek(uint16_t address) const { return m_cpu->GetBus().Peek(address); }
+
+	// evaluates the conditions of the breakpoints at 'pc', raises a break if one passes
+	bool CheckBreakpoint(uint16_t pc);
+
+	bool IsBreakPending() const { return m_breakPending; }
+	const NesDebugHit &GetHit() const { return m_hit; }
+	uint64_t GetHitCount() const { return m_hitCount; }
+
+	// clears the pending break, the breakpoint that raised it is skipped once
+	void Resume();
+
+protected:
+
+	struct Breakpoint
+	{
+		uint16_t			address;
+		NesDebugCondition	condition;
+	};
+
+	struct Watchpoint
+	{
+		uint16_t			first;		// canonical addresses
+		uint16_t			last;
+		uint8_t				kinds;
+		NesDebugCondition	condition;
+	};
+
+	// maps mirrors onto one address: $0000-$1FFF to $0000-$07FF and $2000-$3FFF to $2000-$2007
+	static uint16_t CanonicalAddress(uint16_t address);
+
+	static uint8_t PeekCallback(const void *context, uint16_t address);
+	static uint8_t TrapRead(void *context, uint16_t address);
+	static void TrapWrite(void *context, uint16_t address, uint8_t value);
+
+	void OnAccess(uint8_t kind, uint16_t address, uint8_t value);
+	void FillContext(NesDebugContext &context, uint16_t address, uint8_t value) const;
+	void RaiseBreak(uint8_t kind, uint16_t address, uint8_t value, uint32_t index);
+
+	std::vector<Breakpoint>		m_breakpoints;
+	std::vector<Watchpoint>		m_watchpoints;
+
+	std::vector<uint8_t>		m_breakpointBits;		// per address, 1 if any breakpoint
+	std::vector<uint8_t>		m_watchKinds;			// per address, NesWatchKind bits
+	std::vector<int8_t>			m_blockCache;			// per rom block start, -1 unknown, 0 / 1 has breakpoint
+
+	Mos6502CPU					*m_cpu = nullptr;
+	uint16_t					 m_instructionPc = 0;
+	bool						 m_trapped[256];
+	NesCpuBus::PageMapping		 m_originalPages[256];
+
+	bool			m_breakPending = false;
+	NesDebugHit		m_hit = {};
+	uint64_t		m_hitCount = 0;
+	bool			m_skipOnce = false;
+	uint16_t		m_skipAddress = 0;
+
+private:
+};
@@ -0,0 +1,79 @@
+/*
+Description:
+	Runs a console on its own thread and hands finished frames to a presentation thread.
+
+	The ppu draws straight into the back buffer of a lock free triple buffer. When a frame is
+	complete the buffer is published and the ppu is pointed at the new back buffer, so emulation
+	never waits for presentation and presentation never sees a frame that is still being drawn.
+	A slow presenter only makes frames get skipped (counted as dropped), the emulated frame rate
+	is not affected.
+
+	An optional frame pacer sets the speed and picks which frames are drawn, frames it skips
+	are emulated without drawing and never published.
+
+	With an audio stream, every finished frame's apu samples are pushed into its ring from this
+	thread and the ratio it returns is applied to the next frame.
+
+	The console must not be touched by other threads between Start() and Stop().
+*/
+
+#pragma once
+
+#include "NesAudio.h"
+#include "NesConsole.h"
+#include "NesFrame.h"
+#include "NesFramePacer.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <thread>
+
+template<typename Region>
+class NesEmulationThreadT
+{
+public:
+
+	NesEmulationThreadT();
+	~NesEmulationThreadT();
+
+	// runs 'console' until 'numFrames' frames have been emulated or Stop() is called.
+	// without a pacer every frame is drawn and emulation runs unthrottled. 'audio' is a started
+	// stream for the apu output, the console's sample rate has to be set to match
+	bool Start(NesConsoleT<Region> &console, uint64_t numFrames = UINT64_MAX, NesFramePacer *pacer = nullptr,
+		NesAudioStream *audio = nullptr);
+	void Stop();
+
+	// true once the frame limit is reached or the thread was stopped
+	bool IsFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+	// presentation side, true and the newest frame in 'frame' when one finished since the last call.
+	// 'frame' stays valid until the next call
+	bool AcquireFrame(const NesFrame *&frame) { return m_frames.Acquire(frame); }
+
+	uint64_t GetEmulatedFrames() const { return m_emulatedFrames.load(std::memory_order_relaxed); }
+	uint64_t GetDroppedFrames() const { return m_frames.GetDroppedCount(); }
+
+	// time spent emulating, valid once finished
+	double GetRunSeconds() const { return m_runSeconds; }
+
+protected:
+
+	void Run();
+
+	NesConsoleT<Region>			*m_console = nullptr;
+	uint64_t					 m_numFrames = 0;
+	NesFramePacer				*m_pacer = nullptr;
+	NesAudioStream				*m_audio = nullptr;
+
+	TripleBuffer<NesFrame>		 m_frames;
+
+	std::thread					 m_thread;
+	std::atomic<bool>			 m_stop;
+	std::atomic<bool>			 m_finished;
+	std::atomic<uint64_t>		 m_emulatedFrames;
+	double						 m_runSeconds = 0.0;
+
+private:
+};
+
+typedef NesEmulationThreadT<NesRegionNtsc> NesEmulationThread;
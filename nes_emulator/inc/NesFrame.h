@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// One picture as output by the ppu, 256x240 NES colour indices ($00 - $3F)
+struct NesFrame
+{
+	static const uint32_t Width = 256;
+	static const uint32_t Height = 240;
+
+	uint8_t		pixels[Width * Height];
+	uint64_t	number = 0;				// ppu frame count when it was finished
+};
+
+// 2C02 colours as 0xRRGGBB, indexed by the colour index
+extern const uint32_t NesPaletteRgb[64];
+
+// binary 24 bit PPM, 256x240
+bool WriteFramePpm(const NesFrame &frame, const char *filename);
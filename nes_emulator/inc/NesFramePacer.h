@@ -0,0 +1,64 @@
+/*
+Description:
+	Frame pacing for a run loop: how fast frames are emulated and which ones are drawn.
+
+	- realtime:     one frame per 1 / frame rate seconds (the region's FrameRate, NesRegion.h).
+	                When the loop falls behind, frames are emulated without drawing until it
+	                catches up, and after a long stall the schedule restarts instead of racing
+	                to catch up
+	- unthrottled:  as fast as possible, every frame drawn
+	- turbo:        as fast as possible, only every (frameskip + 1)th frame drawn
+
+	A skipped frame is still fully emulated (cpu, vblank / NMI timing, sprite 0, scroll registers),
+	only the ppu's pixel composition and the presentation side's colour conversion are left out.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+
+enum NesPacingMode
+{
+	PACING_REALTIME,
+	PACING_UNTHROTTLED,
+	PACING_TURBO,
+};
+
+class NesFramePacer
+{
+public:
+
+	// false for an unknown name, 'mode' is unchanged then
+	static bool ParseMode(const char *name, NesPacingMode &mode);
+
+	// 'frameskip' is only used by turbo mode
+	void Start(NesPacingMode mode, double frameRate, uint32_t frameskip = 8);
+
+	// before a frame, whether it should be drawn
+	bool BeginFrame();
+
+	// after a frame, waits for the frame's slot in realtime mode
+	void EndFrame();
+
+	NesPacingMode GetMode() const { return m_mode; }
+	uint64_t GetFrames() const { return m_frames; }
+	uint64_t GetSkippedFrames() const { return m_skippedFrames; }
+
+protected:
+
+	typedef std::chrono::steady_clock Clock;
+
+	// realtime mode gives up on catching up after this many frames behind
+	static const uint32_t MaxFramesBehind = 8;
+
+	NesPacingMode		m_mode = PACING_UNTHROTTLED;
+	uint32_t			m_frameskip = 0;
+	Clock::duration		m_framePeriod = Clock::duration::zero();
+	Clock::time_point	m_nextFrame;
+
+	uint64_t			m_frames = 0;
+	uint64_t			m_skippedFrames = 0;
+
+private:
+};
@@ -0,0 +1,131 @@
+/*
+Description:
+	Memory access heatmaps: per address read / write / execute counts for the cpu address space
+	and read / write counts for the ppu address space ($0000 - $3FFF).
+
+	Counting costs nothing until a heatmap is attached to the console. Attaching swaps every cpu
+	page in the page table for counting handlers that forward to the original page, so the
+	counts are taken at the page table level and the cpu core is not touched. ppu accesses are
+	counted by the ppu's vram access functions.
+
+	Counts are collected per frame into a double buffer: the back frame is counted into while the
+	front frame holds the last complete frame. EndFrame() adds the back frame to the running totals
+	and swaps them, clearing only the pages that were touched.
+*/
+
+#pragma once
+
+#include "Mos6502CPU.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+enum NesHeatmapCounter
+{
+	HEATMAP_CPU_READ,
+	HEATMAP_CPU_WRITE,
+	HEATMAP_CPU_EXECUTE,		// opcode and operand bytes, these fetches are not counted as reads
+	HEATMAP_PPU_READ,
+	HEATMAP_PPU_WRITE,
+	HEATMAP_COUNTERS
+};
+
+struct HeatmapFileHeader
+{
+	char		id[4];				// "NHMP"
+	uint32_t	version;
+	uint32_t	numFrames;
+	uint32_t	numCounters;		// HEATMAP_COUNTERS
+};
+// followed by uint64_t totals and then the uint16_t counts of the last frame, each for the
+// 64K cpu read / write / execute and 16K ppu read / write counters in NesHeatmapCounter order
+
+class NesHeatmap
+{
+public:
+
+	static const uint32_t CpuAddresses = 0x10000;
+	static const uint32_t PpuAddresses = 0x4000;
+	static const uint32_t NumEntries = 3 * CpuAddresses + 2 * PpuAddresses;
+
+	NesHeatmap();
+	~NesHeatmap();
+
+	void Reset();
+
+	// traps every page of the cpu's page table, Detach() restores the original pages
+	void Attach(Mos6502CPU &cpu);
+	void Detach();
+
+	// marks the instruction at 'pc' as executed, its fetches were already counted as reads
+	void CountExecute(uint16_t pc, uint32_t bytes)
+	{
+		for (uint32_t i = 0; i < bytes; i++)
+		{
+			uint16_t address = (uint16_t)(pc + i);
+			m_back[EntryIndex(HEATMAP_CPU_READ, address)]--;
+			Count(HEATMAP_CPU_EXECUTE, address);
+		}
+	}
+
+	void CountPpuRead(uint16_t address) { Count(HEATMAP_PPU_READ, address & 0x3FFF); }
+	void CountPpuWrite(uint16_t address) { Count(HEATMAP_PPU_WRITE, address & 0x3FFF); }
+
+	// snapshots the frame that was just counted and starts the next one
+	void EndFrame();
+
+	uint32_t GetFrameCount() const { return m_numFrames; }
+
+	// counts of the last complete frame, and since Reset()
+	uint16_t GetFrameAccesses(NesHeatmapCounter counter, uint16_t address) const { return m_front[EntryIndex(counter, address)]; }
+	uint64_t GetTotalAccesses(NesHeatmapCounter counter, uint16_t address) const { return m_totals[EntryIndex(counter, address)]; }
+
+	bool WriteBinary(const char *filename) const;
+
+	// 256x256 cpu image (red = writes, green = reads, blue = executes) or a 128x128 ppu image
+	// (red = writes, green = reads), one pixel per address on a log scale
+	bool WriteCpuPpm(const char *filename, bool lastFrame) const;
+	bool WritePpuPpm(const char *filename, bool lastFrame) const;
+
+	// ram hotspots, unused zero page and io register polling, from the totals
+	void WriteReport(FILE *output) const;
+
+protected:
+
+	static const uint32_t NumPages = NumEntries / 256;
+
+	static uint32_t EntryIndex(NesHeatmapCounter counter, uint16_t address)
+	{
+		static const uint32_t bases[HEATMAP_COUNTERS] = { 0, CpuAddresses, 2 * CpuAddresses, 3 * CpuAddresses, 3 * CpuAddresses + PpuAddresses };
+		return bases[counter] + address;
+	}
+
+	void Count(NesHeatmapCounter counter, uint16_t address)
+	{
+		uint32_t index = EntryIndex(counter, address);
+		m_back[index]++;
+		m_backTouched[index >> 8] = 1;
+	}
+
+	bool WritePpm(const char *filename, uint32_t width, const NesHeatmapCounter *channels, uint32_t numEntries, bool lastFrame) const;
+
+	static uint8_t CountRead(void *context, uint16_t address);
+	static void CountWrite(void *context, uint16_t address, uint8_t value);
+
+	// a frame has about 30k cpu cycles, one access each at most, so 16 bits per frame is enough
+	std::vector<uint16_t>	m_frames[2];
+	std::vector<uint8_t>	m_touched[2];		// per page of counters, 1 when any count is not 0
+	uint16_t				*m_back = nullptr;
+	uint8_t					*m_backTouched = nullptr;
+	const uint16_t			*m_front = nullptr;
+	uint32_t				 m_backIndex = 0;
+
+	std::vector<uint64_t>	m_totals;
+	uint32_t				m_numFrames = 0;
+
+	Mos6502CPU				*m_cpu = nullptr;
+	NesCpuBus::PageMapping	 m_originalPages[256];
+
+private:
+};
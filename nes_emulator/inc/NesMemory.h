@@ -18,3 +18,9 @@ typedef Memory<16384> RomBankMem;
 typedef Memory<8192> VRomBankMem;
 typedef Memory<512> TrainerMem;
 
+// cpu address a 16kb rom bank is shown at when disassembling.
+// the last bank is fixed at $C000, other banks are switched in at $8000
+inline uint16_t RomBankCpuAddress(uint32_t bank, uint32_t numRomBanks)
+{
+	return bank + 1 == numRomBanks ? 0xC000 : 0x8000;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "NesMemory.h"
+#include "NesStateHash.h"
+#include "NesFrame.h"
+#include "NesRegion.h"
+
+class NesHeatmap;
+
+// 2C02 picture processing unit.
+// Covers the cpu visible side: the $2000 - $2007 registers, vram / palette / oam memory and
+// frame timing (vblank flag and NMI). Timing is tracked in dots, the frame layout comes from the
+// region the console is instantiated for (NesRegion.h).
+// Pictures are drawn a scanline at a time: each visible line is drawn when the ppu passes its
+// last pixel, using the scroll registers as they are at that point.
+//
+// https://wiki.nesdev.com/w/index.php/PPU_registers
+class NesPpu
+{
+public:
+
+	static const uint32_t DotsPerScanline = 341;
+
+	NesPpu();
+	~NesPpu();
+
+	// chr rom is read only, when a cartridge has no chr rom an internal 8kb chr ram is used
+	void SetChrData(const VRomBankMem *chrBanks, uint8_t numChrBanks, bool verticalMirroring);
+
+	void Reset();
+
+	// advances the ppu by 'dots', instantiated for each NesRegion.h region
+	template<typename Region>
+	void Step(uint32_t dots);
+
+	// true once for each NMI raised by entering vblank, or enabling NMI during vblank
+	bool PollNmi() { bool pending = m_nmiPending; m_nmiPending = false; return pending; }
+
+	bool IsFrameComplete() const { return m_frameComplete; }
+	void ClearFrameComplete() { m_frameComplete = false; }
+	uint64_t GetFrameCount() const { return m_frameCount; }
+
+	// dots until the start of vblank (the NMI) or the end of the frame, whichever comes first
+	template<typename Region>
+	uint32_t GetDotsToNextEvent() const
+	{
+		const uint32_t vblankStartDot = Region::VBlankScanline * DotsPerScanline + 1;
+		const uint32_t frameDots = Region::ScanlinesPerFrame * DotsPerScanline;
+		return (m_frameDot < vblankStartDot ? vblankStartDot : frameDots) - m_frameDot;
+	}
+
+	uint32_t GetScanline() const { return m_frameDot / DotsPerScanline; }
+	uint32_t GetDot() const { return m_frameDot % DotsPerScanline; }
+
+	// cpu side register access, 'address' is mirrored every 8 bytes
+	uint8_t ReadRegister(uint16_t address);
+	void WriteRegister(uint16_t address, uint8_t value);
+
+	// $4014 OAM DMA
+	void WriteOam(const uint8_t *data);
+
+	// registers, timing and all ppu memory
+	void HashState(NesStateHasher &hasher) const;
+
+	// counts vram reads / writes into 'heatmap', nullptr to stop
+	void SetHeatmap(NesHeatmap *heatmap) { m_heatmap = heatmap; }
+
+	// visible scanlines are drawn into 'frame', nullptr to skip drawing. The scroll registers
+	// are updated by rendering either way
+	void SetFrameBuffer(NesFrame *frame) { m_frame = frame; }
+	NesFrame *GetFrameBuffer() const { return m_frame; }
+
+protected:
+
+	uint8_t ReadVram(uint16_t address);
+	void WriteVram(uint16_t address, uint8_t value);
+	uint16_t NametableOffset(uint16_t address) const;
+	uint8_t ReadPalette(uint32_t index) const;
+
+	// the per scanline work of rendering between dots 'from' (exclusive) and 'to' in the same frame
+	template<typename Region>
+	void RunScanlines(uint32_t from, uint32_t to);
+	void RenderScanline(uint32_t line);
+	void DrawScanline(uint32_t line);
+
+	// registers
+	uint8_t m_control = 0;		// $2000
+	uint8_t m_mask = 0;			// $2001
+	uint8_t m_status = 0;		// $2002
+	uint8_t m_oamAddress = 0;	// $2003
+	uint8_t m_readBuffer = 0;	// $2007 reads are delayed by one
+	uint8_t m_openBus = 0;
+
+	uint16_t m_vramAddress = 0;		// v
+	uint16_t m_tempAddress = 0;		// t
+	uint8_t m_fineX = 0;
+	bool m_writeLatch = false;		// w, toggled by $2005 / $2006
+	bool m_nmiPending = false;
+
+	// timing
+	uint32_t m_frameDot = 0;		// dot within the frame, scanline * 341 + dot
+	uint64_t m_frameCount = 0;
+	bool m_frameComplete = false;
+
+	// memory
+	const uint8_t	*m_chr = nullptr;
+	bool			 m_chrWritable = false;
+	bool			 m_verticalMirroring = false;
+
+	Memory<8192>	m_chrRam;
+	Memory<2048>	m_nametables;
+	Memory<32>		m_palette;
+	Memory<256>		m_oam;
+
+	NesHeatmap		*m_heatmap = nullptr;
+	NesFrame		*m_frame = nullptr;
+
+private:
+};
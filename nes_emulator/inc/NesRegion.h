@@ -0,0 +1,113 @@
+/*
+Description:
+	Console regions. Each region is a set of compile time constants used as a template parameter
+	of the console, ppu and apu, so every timing constant in the inner loops is an immediate and
+	there is one instantiation per region instead of a runtime switch.
+
+	                NTSC (2C02)     PAL (2C07)      Dendy (UA6538)
+	cpu clock       1789773 Hz      1662607 Hz      1773448 Hz
+	ppu dots / cpu  3               3.2             3
+	scanlines       262             312             312
+	vblank          241 - 260       241 - 310       291 - 310
+	apu periods     NTSC            PAL             NTSC
+
+	https://wiki.nesdev.com/w/index.php/Cycle_reference_chart
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+enum NesRegionId
+{
+	REGION_NTSC,
+	REGION_PAL,
+	REGION_DENDY,
+};
+
+struct NesRegionNtsc
+{
+	static const NesRegionId Id = REGION_NTSC;
+	static constexpr const char *Name = "NTSC";
+
+	static const uint32_t CpuClockRate = 1789773;
+	static constexpr double FrameRate = 60.0988;
+
+	// ppu dots per cpu cycle as PpuDotsPerCycle / PpuDotsDivisor
+	static const uint32_t PpuDotsPerCycle = 3;
+	static const uint32_t PpuDotsDivisor = 1;
+
+	static const uint32_t ScanlinesPerFrame = 262;
+	static const uint32_t VBlankScanline = 241;
+	static const uint32_t PreRenderScanline = 261;
+
+	// apu timer periods and frame counter steps in cpu cycles, the last step is the sequence length
+	static constexpr uint16_t NoisePeriods[16] = { 4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068 };
+	static constexpr uint16_t DmcPeriods[16] = { 428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54 };
+	static constexpr uint32_t FourStepCycles[5] = { 7457, 14913, 22371, 29829, 29830 };
+	static constexpr uint32_t FiveStepCycles[6] = { 7457, 14913, 22371, 29829, 37281, 37282 };
+};
+
+struct NesRegionPal
+{
+	static const NesRegionId Id = REGION_PAL;
+	static constexpr const char *Name = "PAL";
+
+	static const uint32_t CpuClockRate = 1662607;
+	static constexpr double FrameRate = 50.007;
+
+	static const uint32_t PpuDotsPerCycle = 16;
+	static const uint32_t PpuDotsDivisor = 5;
+
+	static const uint32_t ScanlinesPerFrame = 312;
+	static const uint32_t VBlankScanline = 241;
+	static const uint32_t PreRenderScanline = 311;
+
+	static constexpr uint16_t NoisePeriods[16] = { 4, 8, 14, 30, 60, 88, 118, 148, 188, 236, 354, 472, 708, 944, 1890, 3778 };
+	static constexpr uint16_t DmcPeriods[16] = { 398, 354, 316, 298, 276, 236, 210, 198, 176, 148, 132, 118, 98, 78, 66, 50 };
+	static constexpr uint32_t FourStepCycles[5] = { 8313, 16627, 24939, 33252, 33254 };
+	static constexpr uint32_t FiveStepCycles[6] = { 8313, 16627, 24939, 33252, 41565, 41566 };
+};
+
+// PAL frame layout with the NTSC cpu / ppu ratio and apu, vblank starts 50 lines after the picture
+struct NesRegionDendy : NesRegionNtsc
+{
+	static const NesRegionId Id = REGION_DENDY;
+	static constexpr const char *Name = "Dendy";
+
+	static const uint32_t CpuClockRate = 1773448;
+	static constexpr double FrameRate = 50.007;
+
+	static const uint32_t ScanlinesPerFrame = 312;
+	static const uint32_t VBlankScanline = 291;
+	static const uint32_t PreRenderScanline = 311;
+};
+
+// cpu cycles in one frame, 341 dots per scanline: 29780.67 on NTSC, 33247.5 on PAL and 35464 on Dendy
+template<typename Region>
+constexpr double NesCyclesPerFrame()
+{
+	return Region::ScanlinesPerFrame * 341.0 * Region::PpuDotsDivisor / Region::PpuDotsPerCycle;
+}
+
+// "ntsc", "pal" or "dendy", false for anything else and 'region' is unchanged then
+inline bool ParseNesRegion(const char *name, NesRegionId &region)
+{
+	static const struct { const char *name; NesRegionId region; } regions[] =
+	{
+		{ "ntsc", REGION_NTSC },
+		{ "pal", REGION_PAL },
+		{ "dendy", REGION_DENDY },
+	};
+
+	for (const auto &entry : regions)
+	{
+		if (strcmp(name, entry.name) == 0)
+		{
+			region = entry.region;
+			return true;
+		}
+	}
+	return false;
+}
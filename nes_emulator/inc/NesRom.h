@@ -55,14 +55,27 @@ public:
 	NesCartridge();
 	~NesCartridge();
 
-	void LoadFromFile(const char *filename);
-	void LoadFromBytes(uint8_t *data, unsigned int length);
+	// false when the file can not be read or is not a complete .nes file
+	bool LoadFromFile(const char *filename);
 
-	uint8_t GetRomBankCount() { return m_data->num16kbRomBanks; }
+	// 'data' is not copied and has to outlive the cartridge. The header is checked and the banks it
+	// describes have to fit in 'length', otherwise no banks are loaded and false is returned.
+	// the header stays readable when at least the 16 header bytes were there
+	bool LoadFromBytes(uint8_t *data, unsigned int length);
+
+	uint8_t GetRomBankCount() { return m_numRomBanks; }
 	const RomBankMem *GetRomBanks() { return ROM_Banks; }
 
+	uint8_t GetVRomBankCount() { return m_numVRomBanks; }
+	const VRomBankMem *GetVRomBanks() { return VROM_Banks; }
+	uint8_t GetMapperType() { return (uint8_t)((m_data->hi_mapper_type << 4) | m_data->loMapperType); }
+	const NesRomFileHeader *GetHeader() { return m_data; }
+
 protected:
 
+	// buffer allocated by LoadFromFile, owned by the cartridge
+	uint8_t			*m_fileData = nullptr;
+
 	// pointer to raw file data in the .nes file format
 	uint8_t			*m_rawRomData;
 	long			 m_rawRomDataLength;
@@ -70,6 +83,13 @@ protected:
 	// rom file header, should overlay first 15bytes of m_rawRomData
 	NesRomFileHeader	*m_data;
 
+	// m_data points here until a header is loaded
+	NesRomFileHeader	 m_emptyHeader;
+
+	// bank counts of a successfully loaded file, 0 otherwise
+	uint8_t m_numRomBanks = 0;
+	uint8_t m_numVRomBanks = 0;
+
 	// pointers to approprate locations within the m_rawRomData format.
 	TrainerMem *trainer = nullptr;
 	RomBankMem *ROM_Banks = nullptr;
@@ -0,0 +1,121 @@
+/*
+Description:
+	Rolling hashes of the machine state, used to find where two runs of the same rom diverge.
+
+	Each entry chains the previous hash with the current state, so once two runs differ every
+	later entry differs too and the first divergence can be found by binary search.
+
+	File layout:
+		StateHashFileHeader
+		StateHashEntry[numEntries]
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+// 64 bit multiply / xor-shift hash, consumes 8 bytes per step
+class NesStateHasher
+{
+public:
+
+	explicit NesStateHasher(uint64_t seed = 0) : m_hash(seed ^ 0x9E3779B97F4A7C15ull) {}
+
+	void Add(const void *data, size_t size)
+	{
+		const uint8_t *bytes = (const uint8_t *)data;
+		while (size >= 8)
+		{
+			uint64_t word;
+			memcpy(&word, bytes, 8);
+			Mix(word);
+			bytes += 8;
+			size -= 8;
+		}
+
+		uint64_t tail = 0;
+		memcpy(&tail, bytes, size);
+		Mix(tail ^ ((uint64_t)size << 56));
+	}
+
+	void Add(uint64_t value) { Mix(value); }
+
+	uint64_t GetHash() const
+	{
+		uint64_t h = m_hash;
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		return h;
+	}
+
+protected:
+
+	void Mix(uint64_t word)
+	{
+		m_hash = (m_hash ^ word) * 0x100000001B3ull;
+		m_hash ^= m_hash >> 29;
+	}
+
+	uint64_t m_hash;
+
+private:
+};
+
+#pragma pack(push, 1)
+struct StateHashFileHeader
+{
+	char magic[4];							// "NSHS"
+	uint32_t version;
+	uint32_t instructionInterval;			// 0 for one entry per frame
+	uint32_t numEntries;
+};
+
+struct StateHashEntry
+{
+	uint64_t frame;							// frames completed when the hash was taken
+	uint64_t instructions;					// instructions executed, only counted while hashing
+	uint64_t cycles;
+	uint64_t hash;
+};
+#pragma pack(pop)
+
+class NesStateHashLog
+{
+public:
+
+	static const uint32_t HashLogVersion = 1;
+
+	NesStateHashLog();
+	~NesStateHashLog();
+
+	// 'instructionInterval' adds a cpu and ram hash every n instructions between the frame hashes
+	void Reset(uint32_t instructionInterval);
+
+	void Append(uint64_t frame, uint64_t instructions, uint64_t cycles, uint64_t stateHash)
+	{
+		NesStateHasher hasher(m_entries.empty() ? 0 : m_entries.back().hash);
+		hasher.Add(stateHash);
+		m_entries.push_back({ frame, instructions, cycles, hasher.GetHash() });
+	}
+
+	bool Save(const char *filename) const;
+	bool Load(const char *filename);
+
+	uint32_t GetInstructionInterval() const { return m_instructionInterval; }
+	const std::vector<StateHashEntry> &GetEntries() const { return m_entries; }
+
+	// index of the first entry that differs between the two logs, by bisection.
+	// returns the shorter length when one log is a prefix of the other
+	static size_t FindDivergence(const NesStateHashLog &a, const NesStateHashLog &b);
+
+protected:
+
+	std::vector<StateHashEntry>	m_entries;
+	uint32_t					m_instructionInterval = 0;
+
+private:
+};
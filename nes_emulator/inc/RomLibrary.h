@@ -0,0 +1,94 @@
+/*
+Description:
+	RomLibrary.h scans a directory tree of .nes files and writes a compact binary index.
+
+	Index file layout:
+		RomIndexFileHeader
+		RomIndexEntry[numEntries]		sorted by path, so a later run can binary search the mapped file
+		char[stringTableSize]			file paths, referenced by offset + length (not null terminated)
+
+	Later runs map the previous index and only re-parse files whose size or modified time changed.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#pragma pack(push, 1)
+struct RomIndexFileHeader
+{
+	char magic[4];							// "NIDX"
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t stringTableSize;
+};
+
+struct RomIndexEntry
+{
+	uint64_t fileSize;
+	int64_t modifiedTime;					// file system timestamp, only compared for equality
+	uint32_t crc32;							// CRC32 of everything after the 16 byte header
+	uint32_t pathOffset;					// offset of the path within the string table
+	uint16_t pathLength;
+	uint8_t mapperType;
+	uint8_t num16kbRomBanks;
+	uint8_t num8kbVRomBanks;
+	uint8_t flags;							// RomIndexFlags
+	uint8_t reserved[2];
+};
+#pragma pack(pop)
+
+enum RomIndexFlags : uint8_t
+{
+	ROM_INDEX_PAL				= 1 << 0,
+	ROM_INDEX_VERTICAL_MIRROR	= 1 << 1,
+	ROM_INDEX_BATTERY			= 1 << 2,
+	ROM_INDEX_TRAINER			= 1 << 3,
+	ROM_INDEX_FOUR_SCREEN		= 1 << 4,
+	ROM_INDEX_INVALID			= 1 << 7,	// not a .nes file, or truncated
+};
+
+struct RomLibraryStats
+{
+	uint32_t filesFound = 0;
+	uint32_t filesScanned = 0;
+	uint32_t filesReused = 0;
+	uint32_t filesInvalid = 0;
+	uint64_t bytesHashed = 0;
+	double seconds = 0.0;
+};
+
+class RomLibraryScanner
+{
+public:
+
+	RomLibraryScanner();
+	~RomLibraryScanner();
+
+	// Scans 'directory' recursively and writes 'indexFilename'.
+	// if numThreads is 0 the hardware thread count is used.
+	bool Scan(const char *directory, const char *indexFilename, unsigned int numThreads = 0);
+
+	const RomLibraryStats &GetStats() const { return m_stats; }
+
+	static const uint32_t IndexVersion = 1;
+
+protected:
+
+	struct ScanItem
+	{
+		std::string path;
+		RomIndexEntry entry;
+		bool needsScan;
+	};
+
+	static void ScanFile(ScanItem &item, std::vector<uint8_t> &buffer);
+	bool WriteIndex(const char *indexFilename);
+
+	std::vector<ScanItem> m_items;
+	RomLibraryStats m_stats;
+
+private:
+};
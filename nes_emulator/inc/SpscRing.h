@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+// Lock free single producer / single consumer ring buffer.
+// The producer and consumer each keep a cached copy of the other side's index so the shared
+// atomics are only re-read when the ring looks full (or empty). Capacity is rounded up to a
+// power of two.
+template<typename T>
+class SpscRing
+{
+public:
+
+	explicit SpscRing(size_t capacity = 1024)
+	{
+		Resize(capacity);
+	}
+
+	// not thread safe, only call while neither side is running
+	void Resize(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+
+		m_items.assign(size, T());
+		m_mask = size - 1;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+		m_cachedHead = 0;
+		m_cachedTail = 0;
+	}
+
+	size_t GetCapacity() const { return m_items.size(); }
+
+	// producer side, fails when the ring is full
+	bool TryPush(const T &item)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head - m_cachedTail >= m_items.size())
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head - m_cachedTail >= m_items.size())
+				return false;
+		}
+
+		m_items[head & m_mask] = item;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// producer side, pushes as many of 'count' items as fit and returns how many were pushed
+	size_t Push(const T *items, size_t count)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		size_t space = m_items.size() - (head - m_cachedTail);
+		if (space < count)
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			space = m_items.size() - (head - m_cachedTail);
+		}
+
+		if (count > space)
+			count = space;
+		for (size_t i = 0; i < count; i++)
+			m_items[(head + i) & m_mask] = items[i];
+
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	// consumer side, pops up to 'count' items and returns how many were popped
+	size_t Pop(T *items, size_t count)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t available = m_cachedHead - tail;
+		if (available < count)
+		{
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			available = m_cachedHead - tail;
+		}
+
+		if (count > available)
+			count = available;
+		for (size_t i = 0; i < count; i++)
+			items[i] = m_items[(tail + i) & m_mask];
+
+		m_tail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	// approximate, exact only when called from one of the two sides while the other is idle
+	size_t GetCount() const
+	{
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+	}
+
+protected:
+
+	std::vector<T>	m_items;
+	size_t			m_mask = 0;
+
+	// producer and consumer state live on separate cache lines
+	alignas(64) std::atomic<size_t>	m_head;
+	size_t							m_cachedTail = 0;
+
+	alignas(64) std::atomic<size_t>	m_tail;
+	size_t							m_cachedHead = 0;
+
+private:
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// Lock free triple buffer, one producer and one consumer.
+// The producer always owns a back buffer and the consumer a front buffer, the third sits in the
+// middle. Publish() swaps the back buffer into the middle and Acquire() swaps the middle out to
+// the front, both with a single atomic exchange, so neither side ever waits for the other.
+// A published buffer the consumer never picked up is overwritten and counted as dropped.
+template<typename T>
+class TripleBuffer
+{
+public:
+
+	TripleBuffer()
+	{
+		Reset();
+	}
+
+	// not thread safe, only call while neither side is running
+	void Reset()
+	{
+		m_back = 0;
+		m_middle.store(1, std::memory_order_relaxed);
+		m_front = 2;
+		m_published = 0;
+		m_dropped.store(0, std::memory_order_relaxed);
+	}
+
+	// producer side, the buffer to fill next
+	T &GetBack() { return m_buffers[m_back]; }
+
+	// producer side, hands the back buffer to the consumer and returns the new back buffer
+	T &Publish()
+	{
+		uint8_t previous = m_middle.exchange((uint8_t)(m_back | FreshBit), std::memory_order_acq_rel);
+		if (previous & FreshBit)
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+
+		m_back = previous & IndexMask;
+		m_published++;
+		return m_buffers[m_back];
+	}
+
+	// consumer side, true and the newest buffer in 'front' when one was published since the last call
+	bool Acquire(const T *&front)
+	{
+		if (!(m_middle.load(std::memory_order_relaxed) & FreshBit))
+			return false;
+
+		uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = previous & IndexMask;
+		front = &m_buffers[m_front];
+		return true;
+	}
+
+	// producer side
+	uint64_t GetPublishedCount() const { return m_published; }
+
+	// published buffers that were replaced before the consumer picked them up, safe from either side
+	uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+protected:
+
+	static const uint8_t FreshBit = 0x04;
+	static const uint8_t IndexMask = 0x03;
+
+	T	m_buffers[3];
+
+	// producer and consumer state live on separate cache lines
+	alignas(64) uint8_t					m_back;
+	uint64_t							m_published;
+	std::atomic<uint64_t>				m_dropped;
+
+	alignas(64) std::atomic<uint8_t>	m_middle;
+
+	alignas(64) uint8_t					m_front;
+
+private:
+};
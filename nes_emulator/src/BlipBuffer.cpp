@@ -0,0 +1,273 @@
+#include "BlipBuffer.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BLIP_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define BLIP_TARGET_AVX2
+	#else
+		#define BLIP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#endif
+#else
+	#define BLIP_X86 0
+#endif
+
+static const double Pi = 3.14159265358979323846;
+
+// where the band limit sits, as a fraction of the nyquist frequency
+static const double CutOff = 0.9;
+
+// high pass corner, close to the console's ~37 Hz (ignoring the ~90 Hz stage keeps the bass)
+static const double HighPassHz = 37.0;
+
+// the top 5 bits of the sample position fraction pick the phase
+static_assert(BlipBuffer::Phases == 32, "the phase is taken from the top 5 bits of the fraction");
+static const uint32_t PhaseShift = 32 - 5;
+
+static void AddStepsScalar(float *accumulator, const float (*kernel)[BlipBuffer::Taps], const BlipDelta *deltas, size_t count,
+	uint64_t offset, uint64_t clockFactor)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t position = offset + deltas[i].time * clockFactor;
+		const float *step = kernel[(position >> PhaseShift) & (BlipBuffer::Phases - 1)];
+		float *out = accumulator + (position >> 32);
+		float amplitude = (float)deltas[i].delta;
+
+		for (uint32_t tap = 0; tap < BlipBuffer::Taps; tap++)
+			out[tap] += step[tap] * amplitude;
+	}
+}
+
+#if BLIP_X86
+// the vector versions sum the steps of all deltas that start on the same sample in registers
+// and touch memory once per sample: dense deltas overlap, and an unaligned load straight after
+// an overlapping store cannot be forwarded from the store buffer
+static void AddStepsSse2(float *accumulator, const float (*kernel)[BlipBuffer::Taps], const BlipDelta *deltas, size_t count,
+	uint64_t offset, uint64_t clockFactor)
+{
+	static_assert(BlipBuffer::Taps == 16, "one step is 4 sse registers");
+
+	size_t i = 0;
+	uint64_t position = count != 0 ? offset + deltas[0].time * clockFactor : 0;
+	while (i < count)
+	{
+		uint64_t index = position >> 32;
+		__m128 sum0 = _mm_setzero_ps();
+		__m128 sum1 = _mm_setzero_ps();
+		__m128 sum2 = _mm_setzero_ps();
+		__m128 sum3 = _mm_setzero_ps();
+
+		do
+		{
+			const float *step = kernel[(position >> PhaseShift) & (BlipBuffer::Phases - 1)];
+			__m128 amplitude = _mm_set1_ps((float)deltas[i].delta);
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(step + 0), amplitude));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(step + 4), amplitude));
+			sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(step + 8), amplitude));
+			sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_loadu_ps(step + 12), amplitude));
+
+			if (++i < count)
+				position = offset + deltas[i].time * clockFactor;
+		}
+		while (i < count && (position >> 32) == index);
+
+		float *out = accumulator + index;
+		_mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), sum0));
+		_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), sum1));
+		_mm_storeu_ps(out + 8, _mm_add_ps(_mm_loadu_ps(out + 8), sum2));
+		_mm_storeu_ps(out + 12, _mm_add_ps(_mm_loadu_ps(out + 12), sum3));
+	}
+}
+
+BLIP_TARGET_AVX2 static void AddStepsAvx2(float *accumulator, const float (*kernel)[BlipBuffer::Taps], const BlipDelta *deltas, size_t count,
+	uint64_t offset, uint64_t clockFactor)
+{
+	size_t i = 0;
+	uint64_t position = count != 0 ? offset + deltas[0].time * clockFactor : 0;
+	while (i < count)
+	{
+		uint64_t index = position >> 32;
+		__m256 sum0 = _mm256_setzero_ps();
+		__m256 sum1 = _mm256_setzero_ps();
+
+		do
+		{
+			const float *step = kernel[(position >> PhaseShift) & (BlipBuffer::Phases - 1)];
+			__m256 amplitude = _mm256_set1_ps((float)deltas[i].delta);
+			sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(step + 0), amplitude, sum0);
+			sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(step + 8), amplitude, sum1);
+
+			if (++i < count)
+				position = offset + deltas[i].time * clockFactor;
+		}
+		while (i < count && (position >> 32) == index);
+
+		float *out = accumulator + index;
+		_mm256_storeu_ps(out + 0, _mm256_add_ps(_mm256_loadu_ps(out + 0), sum0));
+		_mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), sum1));
+	}
+}
+
+static bool CpuHasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// avx2 and fma, and the os saving the ymm registers
+	__cpuid(info, 1);
+	bool fma = (info[2] & (1 << 12)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	return fma && avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+#else
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+BlipBufferSimd BlipBuffer::GetBestSimd()
+{
+#if BLIP_X86
+	static const BlipBufferSimd best = CpuHasAvx2() ? BLIP_SIMD_AVX2 : BLIP_SIMD_SSE2;
+	return best;
+#else
+	return BLIP_SIMD_SCALAR;
+#endif
+}
+
+const char *BlipBuffer::GetSimdName(BlipBufferSimd simd)
+{
+	switch (simd)
+	{
+	case BLIP_SIMD_SSE2: return "sse2";
+	case BLIP_SIMD_AVX2: return "avx2";
+	default: return "scalar";
+	}
+}
+
+BlipBuffer::BlipBuffer()
+{
+	BuildKernel();
+	SetSimd(GetBestSimd());
+}
+
+bool BlipBuffer::SetSimd(BlipBufferSimd simd)
+{
+	if (simd > GetBestSimd())
+		return false;
+
+	switch (simd)
+	{
+#if BLIP_X86
+	case BLIP_SIMD_SSE2: m_addSteps = AddStepsSse2; break;
+	case BLIP_SIMD_AVX2: m_addSteps = AddStepsAvx2; break;
+#endif
+	default: m_addSteps = AddStepsScalar; break;
+	}
+	return true;
+}
+
+BlipBuffer::~BlipBuffer()
+{
+
+}
+
+void BlipBuffer::SetRates(double clockRate, uint32_t sampleRate)
+{
+	m_sampleRate = sampleRate;
+	m_clockRate = clockRate;
+	SetRateAdjust(1.0);
+	m_highPassFactor = sampleRate != 0 ? (float)(1.0 - exp(-2.0 * Pi * HighPassHz / sampleRate)) : 0.0f;
+
+	// a frame is never longer than a tenth of a second
+	m_deltas.reserve(8192);
+	m_samples.reserve(sampleRate / 10);
+	Clear();
+}
+
+void BlipBuffer::SetRateAdjust(double ratio)
+{
+	m_clockFactor = m_sampleRate != 0 ? (uint64_t)(m_sampleRate * ratio / m_clockRate * 4294967296.0 + 0.5) : 0;
+}
+
+void BlipBuffer::Clear()
+{
+	m_offset = 0;
+	m_integrator = 0.0f;
+	m_highPass = 0.0f;
+	m_deltas.clear();
+	m_samples.clear();
+	m_accumulator.assign(Taps, 0.0f);
+}
+
+void BlipBuffer::EndFrame(uint32_t frameClocks)
+{
+	m_samples.clear();
+	if (m_sampleRate == 0)
+		return;
+
+	uint64_t frameEnd = m_offset + frameClocks * m_clockFactor;
+	uint32_t numSamples = (uint32_t)(frameEnd >> 32);
+
+	// room for the frame plus the tail of the last step, the tail of the previous frame is kept
+	if (m_accumulator.size() < numSamples + Taps)
+		m_accumulator.resize(numSamples + Taps, 0.0f);
+
+	float *accumulator = m_accumulator.data();
+	m_addSteps(accumulator, m_kernel, m_deltas.data(), m_deltas.size(), m_offset, m_clockFactor);
+	m_deltas.clear();
+
+	m_samples.resize(numSamples);
+	for (uint32_t i = 0; i < numSamples; i++)
+	{
+		m_integrator += accumulator[i];
+		float sample = m_integrator - m_highPass;
+		m_highPass += sample * m_highPassFactor;
+
+		if (sample > 32767.0f)
+			sample = 32767.0f;
+		else if (sample < -32768.0f)
+			sample = -32768.0f;
+		m_samples[i] = (int16_t)lrintf(sample);
+	}
+
+	// the next frame starts where this one ended
+	memmove(accumulator, accumulator + numSamples, Taps * sizeof(float));
+	memset(accumulator + Taps, 0, (m_accumulator.size() - Taps) * sizeof(float));
+	m_offset = frameEnd & 0xFFFFFFFFull;
+}
+
+void BlipBuffer::BuildKernel()
+{
+	// windowed sinc impulses, one per fractional position. Each is normalized to sum to 1 so the
+	// running sum of a step settles at exactly its delta
+	for (uint32_t phase = 0; phase < Phases; phase++)
+	{
+		double sum = 0.0;
+		double centre = Taps / 2 - 1 + (double)phase / Phases;
+
+		for (uint32_t tap = 0; tap < Taps; tap++)
+		{
+			double x = (tap - centre) * CutOff;
+			double sinc = x == 0.0 ? 1.0 : sin(Pi * x) / (Pi * x);
+
+			// blackman window over the kernel length
+			double w = (tap - centre + Taps / 2) / Taps;
+			double window = w <= 0.0 || w >= 1.0 ? 0.0 : 0.42 - 0.5 * cos(2.0 * Pi * w) + 0.08 * cos(4.0 * Pi * w);
+
+			m_kernel[phase][tap] = (float)(sinc * window);
+			sum += sinc * window;
+		}
+
+		for (uint32_t tap = 0; tap < Taps; tap++)
+			m_kernel[phase][tap] = (float)(m_kernel[phase][tap] / sum);
+	}
+}
@@ -0,0 +1,357 @@
+#include "Cc65DebugInfo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// attributes of one record, values point into the line being parsed
+struct DbgAttribute
+{
+	const char	*key;
+	size_t		 keyLength;
+	const char	*value;
+	size_t		 valueLength;
+};
+
+struct DbgRecord
+{
+	std::vector<DbgAttribute> attributes;
+
+	const DbgAttribute *Find(const char *key) const
+	{
+		size_t length = strlen(key);
+		for (const DbgAttribute &attribute : attributes)
+		{
+			if (attribute.keyLength == length && memcmp(attribute.key, key, length) == 0)
+				return &attribute;
+		}
+		return nullptr;
+	}
+
+	uint32_t GetNumber(const char *key, uint32_t fallback = 0) const
+	{
+		const DbgAttribute *attribute = Find(key);
+		if (attribute == nullptr)
+			return fallback;
+
+		// decimal or 0x prefixed hex, the value is always followed by ',' or the end of the line
+		return (uint32_t)strtoul(std::string(attribute->value, attribute->valueLength).c_str(), nullptr, 0);
+	}
+
+	std::string GetString(const char *key) const
+	{
+		const DbgAttribute *attribute = Find(key);
+		return attribute != nullptr ? std::string(attribute->value, attribute->valueLength) : std::string();
+	}
+
+	// ids joined with '+', eg. span=3+4+9
+	std::vector<uint32_t> GetList(const char *key) const
+	{
+		std::vector<uint32_t> ids;
+		std::string text = GetString(key);
+		const char *p = text.c_str();
+		while (*p != '\0')
+		{
+			char *end;
+			ids.push_back((uint32_t)strtoul(p, &end, 0));
+			p = *end == '+' ? end + 1 : end + strlen(end);
+		}
+		return ids;
+	}
+};
+
+// splits "type<tab>key=value,key="quoted, value"" into the record type and its attributes
+static std::string ParseRecord(const char *line, const char *end, DbgRecord &record)
+{
+	record.attributes.clear();
+
+	const char *p = line;
+	while (p < end && *p != ' ' && *p != '\t')
+		p++;
+	std::string type(line, p - line);
+
+	while (p < end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == ','))
+			p++;
+		if (p >= end)
+			break;
+
+		DbgAttribute attribute;
+		attribute.key = p;
+		while (p < end && *p != '=')
+			p++;
+		attribute.keyLength = p - attribute.key;
+		if (p < end)
+			p++;
+
+		if (p < end && *p == '"')
+		{
+			attribute.value = ++p;
+			while (p < end && *p != '"')
+				p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+			attribute.valueLength = p - attribute.value;
+			if (p < end)
+				p++;
+		}
+		else
+		{
+			attribute.value = p;
+			while (p < end && *p != ',')
+				p++;
+			attribute.valueLength = p - attribute.value;
+		}
+
+		record.attributes.push_back(attribute);
+	}
+
+	return type;
+}
+
+template<typename T>
+static T &Slot(std::vector<T> &items, uint32_t id)
+{
+	if (id >= items.size())
+		items.resize(id + 1);
+	return items[id];
+}
+
+Cc65DebugInfo::Cc65DebugInfo()
+{
+
+}
+
+Cc65DebugInfo::~Cc65DebugInfo()
+{
+
+}
+
+bool Cc65DebugInfo::Load(const char *filename)
+{
+	m_files.clear();
+	m_lines.clear();
+	m_names.clear();
+	m_addressLine.assign(0x10000, -1);
+	m_addressFunction.assign(0x10000, -1);
+	m_addressSymbol.assign(0x10000, -1);
+	m_loaded = false;
+
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
+
+	std::vector<char> text;
+	char buffer[65536];
+	size_t bytesRead;
+	while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		text.insert(text.end(), buffer, buffer + bytesRead);
+	fclose(file);
+
+	const char *slash = std::max(strrchr(filename, '/'), strrchr(filename, '\\'));
+	m_directory = slash != nullptr ? std::string(filename, slash - filename + 1) : std::string();
+
+	// records reference each other by id and ld65 writes lines before the spans they use,
+	// so everything is collected first and resolved to addresses afterwards
+	struct Segment { uint32_t start = 0; uint32_t size = 0; };
+	struct Span { uint32_t segment = 0; uint32_t start = 0; uint32_t size = 0; };
+	struct Line { Cc65SourceLine source = {}; std::vector<uint32_t> spans; };
+	struct Scope { std::string name; uint32_t size = 0; std::vector<uint32_t> spans; };
+	struct Label { uint32_t address; uint32_t segment; std::string name; };
+
+	std::vector<Segment> segments;
+	std::vector<Span> spans;
+	std::vector<Line> lines;
+	std::vector<Scope> scopes;
+	std::vector<Label> labels;
+
+	bool hasVersion = false;
+	DbgRecord record;
+
+	const char *p = text.data();
+	const char *textEnd = p + text.size();
+	while (p < textEnd)
+	{
+		const char *lineEnd = (const char *)memchr(p, '\n', textEnd - p);
+		if (lineEnd == nullptr)
+			lineEnd = textEnd;
+
+		const char *end = lineEnd;
+		if (end > p && end[-1] == '\r')
+			end--;
+
+		std::string type = ParseRecord(p, end, record);
+		p = lineEnd + 1;
+
+		if (type == "version")
+		{
+			if (record.GetNumber("major") != 2)
+			{
+				printf("%s: unsupported debug info version %u\n", filename, record.GetNumber("major"));
+				return false;
+			}
+			hasVersion = true;
+		}
+		else if (type == "file")
+		{
+			Slot(m_files, record.GetNumber("id")) = record.GetString("name");
+		}
+		else if (type == "seg")
+		{
+			Segment &segment = Slot(segments, record.GetNumber("id"));
+			segment.start = record.GetNumber("start");
+			segment.size = record.GetNumber("size");
+		}
+		else if (type == "span")
+		{
+			Span &span = Slot(spans, record.GetNumber("id"));
+			span.segment = record.GetNumber("seg");
+			span.start = record.GetNumber("start");
+			span.size = record.GetNumber("size");
+		}
+		else if (type == "line")
+		{
+			if (record.Find("span") == nullptr)
+				continue;
+
+			Line &line = Slot(lines, record.GetNumber("id"));
+			line.source.file = record.GetNumber("file");
+			line.source.line = record.GetNumber("line");
+			line.source.type = (uint8_t)record.GetNumber("type", CC65_LINE_ASM);
+			line.spans = record.GetList("span");
+		}
+		else if (type == "scope")
+		{
+			// .proc scopes, cc65 emits one per C function
+			if (record.GetString("type") != "scope" || record.Find("span") == nullptr)
+				continue;
+
+			Scope &scope = Slot(scopes, record.GetNumber("id"));
+			scope.name = record.GetString("name");
+			scope.size = record.GetNumber("size");
+			scope.spans = record.GetList("span");
+		}
+		else if (type == "sym")
+		{
+			if (record.GetString("type") != "lab" || record.Find("seg") == nullptr)
+				continue;
+
+			labels.push_back({ record.GetNumber("val"), record.GetNumber("seg"), record.GetString("name") });
+		}
+	}
+
+	if (!hasVersion)
+	{
+		printf("%s is not an ld65 debug info file\n", filename);
+		return false;
+	}
+
+	auto forEachAddress = [&](const std::vector<uint32_t> &spanIds, auto callback)
+	{
+		for (uint32_t id : spanIds)
+		{
+			if (id >= spans.size() || spans[id].segment >= segments.size())
+				continue;
+
+			uint32_t start = segments[spans[id].segment].start + spans[id].start;
+			for (uint32_t address = start; address < start + spans[id].size && address < 0x10000; address++)
+				callback(address);
+		}
+	};
+
+	// source lines, C first then asm then macro expansions
+	static const uint8_t typeRank[] = { 1, 0, 2 };
+	std::vector<uint8_t> addressRank(0x10000, 0xFF);
+
+	for (const Line &line : lines)
+	{
+		if (line.spans.empty())
+			continue;
+
+		int32_t index = (int32_t)m_lines.size();
+		uint8_t rank = line.source.type < 3 ? typeRank[line.source.type] : 3;
+		m_lines.push_back(line.source);
+
+		forEachAddress(line.spans, [&](uint32_t address)
+		{
+			if (rank < addressRank[address])
+			{
+				addressRank[address] = rank;
+				m_addressLine[address] = index;
+			}
+		});
+	}
+
+	// labels own everything up to the next label in their segment
+	std::sort(labels.begin(), labels.end(), [](const Label &a, const Label &b) { return a.address < b.address; });
+
+	for (size_t i = 0; i < labels.size(); i++)
+	{
+		const Label &label = labels[i];
+		if (label.segment >= segments.size() || label.address >= 0x10000)
+			continue;
+
+		int32_t name = (int32_t)m_names.size();
+		m_names.push_back(label.name);
+
+		if (m_addressSymbol[label.address] < 0)
+			m_addressSymbol[label.address] = name;
+
+		const Segment &segment = segments[label.segment];
+		uint32_t end = std::min<uint32_t>(segment.start + segment.size, 0x10000);
+		if (i + 1 < labels.size())
+			end = std::min(end, labels[i + 1].address);
+
+		for (uint32_t address = label.address; address < end; address++)
+			m_addressFunction[address] = name;
+	}
+
+	// then functions, outer scopes first so nested ones win
+	std::sort(scopes.begin(), scopes.end(), [](const Scope &a, const Scope &b) { return a.size > b.size; });
+
+	for (const Scope &scope : scopes)
+	{
+		if (scope.name.empty() || scope.spans.empty())
+			continue;
+
+		int32_t name = (int32_t)m_names.size();
+		m_names.push_back(scope.name);
+
+		uint32_t first = 0x10000;
+		forEachAddress(scope.spans, [&](uint32_t address)
+		{
+			m_addressFunction[address] = name;
+			first = std::min(first, address);
+		});
+
+		if (first < 0x10000 && m_addressSymbol[first] < 0)
+			m_addressSymbol[first] = name;
+	}
+
+	m_loaded = true;
+	return true;
+}
+
+const Cc65SourceLine *Cc65DebugInfo::FindLine(uint16_t address) const
+{
+	if (!m_loaded || m_addressLine[address] < 0)
+		return nullptr;
+	return &m_lines[m_addressLine[address]];
+}
+
+const char *Cc65DebugInfo::FindFunction(uint16_t address) const
+{
+	if (!m_loaded || m_addressFunction[address] < 0)
+		return nullptr;
+	return m_names[m_addressFunction[address]].c_str();
+}
+
+const char *Cc65DebugInfo::FindSymbol(uint16_t address) const
+{
+	if (!m_loaded || m_addressSymbol[address] < 0)
+		return nullptr;
+	return m_names[m_addressSymbol[address]].c_str();
+}
@@ -0,0 +1,141 @@
+#include "Cc65SourceProfile.h"
+
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+
+Cc65SourceProfile::Cc65SourceProfile()
+{
+
+}
+
+Cc65SourceProfile::~Cc65SourceProfile()
+{
+
+}
+
+void Cc65SourceProfile::Build(const Cc65DebugInfo &debugInfo, const Mos6502Profiler &profiler)
+{
+	m_debugInfo = &debugInfo;
+	m_functions.clear();
+	m_lines.clear();
+	m_totalCycles = 0;
+	m_unknownCycles = 0;
+	m_sources.assign(debugInfo.GetFileCount(), std::vector<std::string>());
+	m_sourceLoaded.assign(debugInfo.GetFileCount(), false);
+
+	std::unordered_map<std::string, size_t> functionIndex;
+	std::unordered_map<uint64_t, size_t> lineIndex;
+
+	for (uint32_t pc = 0; pc < 0x10000; pc++)
+	{
+		uint64_t cycles = profiler.GetPCCycles((uint16_t)pc);
+		if (cycles == 0)
+			continue;
+
+		m_totalCycles += cycles;
+
+		const char *function = debugInfo.FindFunction((uint16_t)pc);
+		const Cc65SourceLine *line = debugInfo.FindLine((uint16_t)pc);
+		if (function == nullptr && line == nullptr)
+		{
+			m_unknownCycles += cycles;
+			continue;
+		}
+
+		if (function != nullptr)
+		{
+			auto it = functionIndex.emplace(function, m_functions.size());
+			if (it.second)
+				m_functions.push_back({ function, 0, 0, 0 });
+			m_functions[it.first->second].cycles += cycles;
+		}
+
+		if (line != nullptr)
+		{
+			uint64_t key = ((uint64_t)line->file << 32) | line->line;
+			auto it = lineIndex.emplace(key, m_lines.size());
+			if (it.second)
+				m_lines.push_back({ function != nullptr ? function : "", line->file, line->line, 0 });
+			m_lines[it.first->second].cycles += cycles;
+		}
+	}
+
+	auto byCycles = [](const Entry &a, const Entry &b) { return a.cycles > b.cycles; };
+	std::sort(m_functions.begin(), m_functions.end(), byCycles);
+	std::sort(m_lines.begin(), m_lines.end(), byCycles);
+}
+
+void Cc65SourceProfile::WriteReport(FILE *output, uint64_t numFrames, double cyclesPerFrame, uint32_t numEntries) const
+{
+	double frames = numFrames > 0 ? (double)numFrames : 1.0;
+	double budgetScale = 100.0 / cyclesPerFrame;
+
+	fprintf(output, "%llu frames, %.1f cycles per frame (budget %.1f), %.1f without debug info\n\n", (unsigned long long)numFrames,
+		m_totalCycles / frames, cyclesPerFrame, m_unknownCycles / frames);
+
+	fprintf(output, "cycles/frame  %%budget  function\n");
+	for (size_t i = 0; i < m_functions.size() && i < numEntries; i++)
+	{
+		double perFrame = m_functions[i].cycles / frames;
+		fprintf(output, "%12.1f  %7.2f  %s\n", perFrame, perFrame * budgetScale, m_functions[i].name.c_str());
+	}
+
+	fprintf(output, "\ncycles/frame  %%budget  source\n");
+	for (size_t i = 0; i < m_lines.size() && i < numEntries; i++)
+	{
+		const Entry &entry = m_lines[i];
+		double perFrame = entry.cycles / frames;
+		fprintf(output, "%12.1f  %7.2f  %s:%u", perFrame, perFrame * budgetScale, m_debugInfo->GetFileName(entry.file), entry.line);
+
+		if (!entry.name.empty())
+			fprintf(output, " (%s)", entry.name.c_str());
+
+		std::string text = ReadSourceLine(entry.file, entry.line);
+		if (!text.empty())
+			fprintf(output, "\n                         %s", text.c_str());
+		fprintf(output, "\n");
+	}
+}
+
+std::string Cc65SourceProfile::ReadSourceLine(uint32_t file, uint32_t line) const
+{
+	if (file >= m_sources.size())
+		return std::string();
+
+	if (!m_sourceLoaded[file])
+	{
+		m_sourceLoaded[file] = true;
+
+		// relative to the .dbg file first, then the working directory
+		std::string name = m_debugInfo->GetFileName(file);
+		FILE *source = fopen((m_debugInfo->GetDirectory() + name).c_str(), "r");
+		if (source == nullptr)
+			source = fopen(name.c_str(), "r");
+		if (source == nullptr)
+			return std::string();
+
+		std::string text;
+		int c;
+		while ((c = fgetc(source)) != EOF)
+		{
+			if (c != '\n')
+			{
+				text += (char)c;
+				continue;
+			}
+
+			// trim the line ending and leading indentation
+			size_t start = text.find_first_not_of(" \t");
+			size_t end = text.find_last_not_of("\r");
+			m_sources[file].push_back(start != std::string::npos && end != std::string::npos ? text.substr(start, end - start + 1) : std::string());
+			text.clear();
+		}
+		m_sources[file].push_back(text);
+		fclose(source);
+	}
+
+	if (line == 0 || line > m_sources[file].size())
+		return std::string();
+	return m_sources[file][line - 1];
+}
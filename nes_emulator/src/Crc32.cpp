@@ -0,0 +1,27 @@
+#include "Crc32.h"
+
+struct Crc32Table
+{
+	uint32_t values[256];
+
+	Crc32Table()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			values[i] = c;
+		}
+	}
+};
+
+static const Crc32Table s_crcTable;
+
+uint32_t Crc32(const uint8_t *data, size_t length)
+{
+	uint32_t crc = 0xFFFFFFFFu;
+	for (size_t i = 0; i < length; i++)
+		crc = s_crcTable.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFu;
+}
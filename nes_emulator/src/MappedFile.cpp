@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char *filename)
+{
+	Close();
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER filesize;
+	if (!GetFileSizeEx(file, &filesize) || filesize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_data = (const uint8_t *)view;
+	m_size = (size_t)filesize.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+
+	if (m_mappingHandle != nullptr)
+		CloseHandle((HANDLE)m_mappingHandle);
+
+	if (m_fileHandle != nullptr)
+		CloseHandle((HANDLE)m_fileHandle);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char *filename)
+{
+	Close();
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+
+	m_fileDescriptor = fd;
+	m_data = (const uint8_t *)view;
+	m_size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		munmap((void *)m_data, m_size);
+
+	if (m_fileDescriptor >= 0)
+		close(m_fileDescriptor);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fileDescriptor = -1;
+}
+
+#endif
@@ -1,26 +1,96 @@
 #include "Mos6502CPU.h"
-#include <iostream>
+#include "Mos6502Disassembler.h"
+#include "Mos6502OpCodes.h"
 
-Mos6502CPU::Mos6502CPU()
+template<typename Variant>
+Mos6502Core<Variant>::Mos6502Core()
 {
-
+	PC = 0;
+	SP = 0xFD;
+	A = 0;
+	X = 0;
+	Y = 0;
+	SR.value = 0x24;
 }
 
-Mos6502CPU::~Mos6502CPU()
+template<typename Variant>
+Mos6502Core<Variant>::~Mos6502Core()
 {
 
 }
 
 
-void Mos6502CPU::SetRomData(const RomBankMem *romMemory, uint8_t numRomBanks)
+template<typename Variant>
+void Mos6502Core<Variant>::SetRomData(const RomBankMem *romMemory, uint8_t numRomBanks)
 {
 	m_rom = romMemory;
 	m_numRomBanks = numRomBanks;
+	m_bus.MapRomBanks(romMemory, numRomBanks);
+}
+
+template<typename Variant>
+void Mos6502Core<Variant>::Reset()
+{
+	A = 0;
+	X = 0;
+	Y = 0;
+	SP = 0xFD;
+	SR.value = 0x24;	// interrupts disabled, unused bit reads as 1
+
+	m_nmiPending = false;
+	m_irqLine = false;
+
+	// the reset sequence takes 7 cycles, same as any other interrupt
+	PC = Read16(0xFFFC);
+	m_cycles = 7;
+	m_fusedCount = 0;
+}
+
+template<typename Variant>
+void Mos6502Core<Variant>::Tick()
+{
+	Execute<false>(0);
+}
+
+template<typename Variant>
+void Mos6502Core<Variant>::TickFused(uint64_t cycleLimit)
+{
+#if NES_CPU_PROFILER
+	// the profiler counts every instruction on its own
+	if (m_profiler != nullptr)
+		cycleLimit = 0;
+#endif
+
+	Execute<true>(cycleLimit);
 }
 
-void Mos6502CPU::Tick()
+template<typename Variant>
+template<bool Fuse>
+void Mos6502Core<Variant>::Execute(uint64_t cycleLimit)
 {
-	uint8_t opCode = m_rom->data[PC];
+	// interrupts are checked between instructions, NMI has priority over IRQ
+	if (m_nmiPending)
+	{
+		m_nmiPending = false;
+		Interrupt(0xFFFA, false);
+		return;
+	}
+
+	if (m_irqLine && !SR.I)
+	{
+		Interrupt(0xFFFE, false);
+		return;
+	}
+
+#if NES_CPU_PROFILER
+	uint16_t profilePC = PC;
+	uint64_t profileCycles = m_cycles;
+#endif
+
+	uint8_t opCode = Read(PC++);
+
+	// base cycle count, page crossing and taken branches add to this as they execute
+	m_cycles += Mos6502OpCodeTable[opCode].cycles;
 	
 	// Instruction Set References:
 	// http://www.obelisk.me.uk/6502/reference.html
@@ -45,14 +115,14 @@ void Mos6502CPU::Tick()
 	//      (indirect,X)  ADC (oper,X)  61    2     6
 	//      (indirect),Y  ADC (oper),Y  71    2     5*
 
-	case 0x69: break;
-	case 0x65: break;
-	case 0x75: break;
-	case 0x6D: break;
-	case 0x7D: break;
-	case 0x79: break;
-	case 0x61: break;
-	case 0x71: break;
+	case 0x69: ADC(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x65: ADC(Operand<ADDR_ZEROPAGE>()); break;
+	case 0x75: ADC(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0x6D: ADC(Operand<ADDR_ABSOLUTE>()); break;
+	case 0x7D: ADC(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0x79: ADC(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0x61: ADC(Operand<ADDR_INDIRECT_X>()); break;
+	case 0x71: ADC(Operand<ADDR_INDIRECT_Y>()); break;
 
 	
 	// AND  AND Memory with Accumulator
@@ -72,14 +142,14 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  AND (oper),Y  31    2     5*
 	
 
-	case 0x29: break;
-	case 0x25: break;
-	case 0x35: break;
-	case 0x2D: break;
-	case 0x3D: break;
-	case 0x39: break;
-	case 0x21: break;
-	case 0x31: break;
+	case 0x29: AND(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x25: AND(Operand<ADDR_ZEROPAGE>()); break;
+	case 0x35: AND(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0x2D: AND(Operand<ADDR_ABSOLUTE>()); break;
+	case 0x3D: AND(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0x39: AND(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0x21: AND(Operand<ADDR_INDIRECT_X>()); break;
+	case 0x31: AND(Operand<ADDR_INDIRECT_Y>()); break;
 
 	
 	// ASL  Shift Left One Bit (Memory or Accumulator)
@@ -96,11 +166,11 @@ void Mos6502CPU::Tick()
 	//      absolute,X    ASL oper,X    1E    3     7
 
 
-	case 0x0A: break;
-	case 0x06: break;
-	case 0x16: break;
-	case 0x0E: break;
-	case 0x1E: break;
+	case 0x0A: A = ASL(A); break;
+	case 0x06: Modify<ADDR_ZEROPAGE, &Mos6502Core::ASL>(); break;
+	case 0x16: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::ASL>(); break;
+	case 0x0E: Modify<ADDR_ABSOLUTE, &Mos6502Core::ASL>(); break;
+	case 0x1E: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::ASL>(); break;
 
 
 	// BCC  Branch on Carry Clear
@@ -113,7 +183,7 @@ void Mos6502CPU::Tick()
 	//      relative      BCC oper      90    2     2**
 
 
-	case 0x90: break;
+	case 0x90: Branch(!SR.C); break;
 
 
 	// BCS  Branch on Carry Set
@@ -125,7 +195,7 @@ void Mos6502CPU::Tick()
 	//      --------------------------------------------
 	//      relative      BCS oper      B0    2     2**
 
-	case 0xB0: break;
+	case 0xB0: Branch(SR.C); break;
 
 	// BEQ  Branch on Result Zero
 	// 
@@ -137,7 +207,7 @@ void Mos6502CPU::Tick()
 	//      relative      BEQ oper      F0    2     2**
 	
 
-	case 0xF0: break;
+	case 0xF0: Branch(SR.Z); break;
 
 
 	// BIT  Test Bits in Memory with Accumulator
@@ -154,8 +224,8 @@ void Mos6502CPU::Tick()
 	//      absolute      BIT oper      2C    3     4
 	
 
-	case 0x24: break;
-	case 0x2C: break;
+	case 0x24: BIT(Operand<ADDR_ZEROPAGE>()); break;
+	case 0x2C: BIT(Operand<ADDR_ABSOLUTE>()); break;
 
 
 	// BMI  Branch on Result Minus
@@ -168,7 +238,7 @@ void Mos6502CPU::Tick()
 	//      relative      BMI oper      30    2     2**
 	
 
-	case 0x30: break;
+	case 0x30: Branch(SR.N); break;
 
 
 	// BNE  Branch on Result not Zero
@@ -181,7 +251,7 @@ void Mos6502CPU::Tick()
 	//      relative      BNE oper      D0    2     2**
 	
 
-	case 0xD0: break;
+	case 0xD0: Branch(!SR.Z); break;
 
 	// BPL  Branch on Result Plus
 	// 
@@ -193,7 +263,7 @@ void Mos6502CPU::Tick()
 	//      relative      BPL oper      10    2     2**
 	
 
-	case 0x10: break;
+	case 0x10: Branch(!SR.N); break;
 
 
 	// BRK  Force Break
@@ -206,7 +276,7 @@ void Mos6502CPU::Tick()
 	//      implied       BRK           00    1     7
 	
 
-	case 0x00: break;
+	case 0x00: PC++; Interrupt(0xFFFE, true); break;
 
 
 	// BVC  Branch on Overflow Clear
@@ -219,7 +289,7 @@ void Mos6502CPU::Tick()
 	//      relative      BVC oper      50    2     2**
 	
 
-	case 0x50: break;
+	case 0x50: Branch(!SR.V); break;
 
 
 	// BVS  Branch on Overflow Set
@@ -232,7 +302,7 @@ void Mos6502CPU::Tick()
 	//      relative      BVC oper      70    2     2**
 	
 
-	case 0x70: break;
+	case 0x70: Branch(SR.V); break;
 
 
 	// CLC  Clear Carry Flag
@@ -245,7 +315,7 @@ void Mos6502CPU::Tick()
 	//      implied       CLC           18    1     2
 	
 
-	case 0x18: break;
+	case 0x18: SR.C = 0; break;
 
 
 	// CLD  Clear Decimal Mode
@@ -258,7 +328,7 @@ void Mos6502CPU::Tick()
 	//      implied       CLD           D8    1     2
 	
 
-	case 0xD8: break;
+	case 0xD8: SR.D = 0; break;
 
 
 	// CLI  Clear Interrupt Disable Bit
@@ -271,7 +341,7 @@ void Mos6502CPU::Tick()
 	//      implied       CLI           58    1     2
 	
 
-	case 0x58: break;
+	case 0x58: SR.I = 0; break;
 
 
 	// CLV  Clear Overflow Flag
@@ -284,7 +354,7 @@ void Mos6502CPU::Tick()
 	//      implied       CLV           B8    1     2
 	
 
-	case 0xB8: break;
+	case 0xB8: SR.V = 0; break;
 
 	// CMP  Compare Memory with Accumulator
 	// 
@@ -303,14 +373,14 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  CMP (oper),Y  D1    2     5*
 	
 
-	case 0xC9: break;
-	case 0xC5: break;
-	case 0xD5: break;
-	case 0xCD: break;
-	case 0xDD: break;
-	case 0xD9: break;
-	case 0xC1: break;
-	case 0xD1: break;
+	case 0xC9: Compare(A, Operand<ADDR_IMMEDIATE>()); if (Fuse) FuseBranch(cycleLimit); break;
+	case 0xC5: Compare(A, Operand<ADDR_ZEROPAGE>()); break;
+	case 0xD5: Compare(A, Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0xCD: Compare(A, Operand<ADDR_ABSOLUTE>()); break;
+	case 0xDD: Compare(A, Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0xD9: Compare(A, Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0xC1: Compare(A, Operand<ADDR_INDIRECT_X>()); break;
+	case 0xD1: Compare(A, Operand<ADDR_INDIRECT_Y>()); break;
 
 
 	// CPX  Compare Memory and Index X
@@ -325,9 +395,9 @@ void Mos6502CPU::Tick()
 	//      absolute      CPX oper      EC    3     4
 	
 
-	case 0xE0: break;
-	case 0xE4: break;
-	case 0xEC: break;
+	case 0xE0: Compare(X, Operand<ADDR_IMMEDIATE>()); break;
+	case 0xE4: Compare(X, Operand<ADDR_ZEROPAGE>()); break;
+	case 0xEC: Compare(X, Operand<ADDR_ABSOLUTE>()); break;
 
 
 	// CPY  Compare Memory and Index Y
@@ -342,9 +412,9 @@ void Mos6502CPU::Tick()
 	//      absolute      CPY oper      CC    3     4
 	
 
-	case 0xC0: break;
-	case 0xC4: break;
-	case 0xCC: break;
+	case 0xC0: Compare(Y, Operand<ADDR_IMMEDIATE>()); break;
+	case 0xC4: Compare(Y, Operand<ADDR_ZEROPAGE>()); break;
+	case 0xCC: Compare(Y, Operand<ADDR_ABSOLUTE>()); break;
 
 
 	// DEC  Decrement Memory by One
@@ -360,10 +430,10 @@ void Mos6502CPU::Tick()
 	//      absolute,X    DEC oper,X    DE    3     7
 	
 
-	case 0xC6: break;
-	case 0xD6: break;
-	case 0xCE: break;
-	case 0xDE: break;
+	case 0xC6: Modify<ADDR_ZEROPAGE, &Mos6502Core::DEC>(); break;
+	case 0xD6: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::DEC>(); break;
+	case 0xCE: Modify<ADDR_ABSOLUTE, &Mos6502Core::DEC>(); break;
+	case 0xDE: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::DEC>(); break;
 
 
 	// DEX  Decrement Index X by One
@@ -376,7 +446,7 @@ void Mos6502CPU::Tick()
 	//      implied       DEC           CA    1     2
 	
 
-	case 0xCA: break;
+	case 0xCA: SetZN(--X); if (Fuse) FuseBranch(cycleLimit); break;
 
 
 	// DEY  Decrement Index Y by One
@@ -388,7 +458,7 @@ void Mos6502CPU::Tick()
 	//      --------------------------------------------
 	//      implied       DEC           88    1     2
 	
-	case 0x88: break;
+	case 0x88: SetZN(--Y); if (Fuse) FuseBranch(cycleLimit); break;
 
 	// EOR  Exclusive-OR Memory with Accumulator
 	// 
@@ -407,14 +477,14 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  EOR (oper),Y  51    2     5*
 	
 
-	case 0x49: break;
-	case 0x45: break;
-	case 0x55: break;
-	case 0x4D: break;
-	case 0x5D: break;
-	case 0x59: break;
-	case 0x41: break;
-	case 0x51: break;
+	case 0x49: EOR(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x45: EOR(Operand<ADDR_ZEROPAGE>()); break;
+	case 0x55: EOR(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0x4D: EOR(Operand<ADDR_ABSOLUTE>()); break;
+	case 0x5D: EOR(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0x59: EOR(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0x41: EOR(Operand<ADDR_INDIRECT_X>()); break;
+	case 0x51: EOR(Operand<ADDR_INDIRECT_Y>()); break;
 
 
 	// INC  Increment Memory by One
@@ -430,10 +500,10 @@ void Mos6502CPU::Tick()
 	//      absolute,X    INC oper,X    FE    3     7
 	
 
-	case 0xE6: break;
-	case 0xF6: break;
-	case 0xEE: break;
-	case 0xFE: break;
+	case 0xE6: Modify<ADDR_ZEROPAGE, &Mos6502Core::INC>(); if (Fuse) FuseBranch(cycleLimit); break;
+	case 0xF6: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::INC>(); break;
+	case 0xEE: Modify<ADDR_ABSOLUTE, &Mos6502Core::INC>(); break;
+	case 0xFE: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::INC>(); break;
 
 
 	// INX  Increment Index X by One
@@ -446,7 +516,7 @@ void Mos6502CPU::Tick()
 	//      implied       INX           E8    1     2
 	
 
-	case 0xE8: break;
+	case 0xE8: SetZN(++X); break;
 
 
 	// INY  Increment Index Y by One
@@ -459,7 +529,7 @@ void Mos6502CPU::Tick()
 	//      implied       INY           C8    1     2
 	
 
-	case 0xC8: break;
+	case 0xC8: SetZN(++Y); break;
 
 
 	// JMP  Jump to New Location
@@ -473,8 +543,8 @@ void Mos6502CPU::Tick()
 	//      indirect      JMP (oper)    6C    3     5
 	
 
-	case 0x4C: break;
-	case 0x6C: break;
+	case 0x4C: PC = Read16(PC); break;
+	case 0x6C: PC = ReadIndirectJumpTarget(Read16(PC)); break;
 
 
 	// JSR  Jump to New Location Saving Return Address
@@ -488,7 +558,16 @@ void Mos6502CPU::Tick()
 	//      absolute      JSR oper      20    3     6
 	
 
-	case 0x20: break;
+	case 0x20:
+	{
+		uint16_t target = Read16(PC);
+		Push16((uint16_t)(PC + 1));
+		PC = target;
+
+		if (m_callObserver != nullptr)
+			m_callObserver->OnCall(target, SP);
+	}
+	break;
 
 
 	// LDA  Load Accumulator with Memory
@@ -508,14 +587,14 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  LDA (oper),Y  B1    2     5*
 
 
-	case 0xA9: break;
-	case 0xA5: break;
-	case 0xB5: break;
-	case 0xAD: break;
-	case 0xBD: break;
-	case 0xB9: break;
-	case 0xA1: break;
-	case 0xB1: break;
+	case 0xA9: A = Load(Operand<ADDR_IMMEDIATE>()); if (Fuse) FuseStore(cycleLimit); break;
+	case 0xA5: A = Load(Operand<ADDR_ZEROPAGE>()); if (Fuse) FuseStore(cycleLimit); break;
+	case 0xB5: A = Load(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0xAD: A = Load(Operand<ADDR_ABSOLUTE>()); if (Fuse) FuseStore(cycleLimit); break;
+	case 0xBD: A = Load(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0xB9: A = Load(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0xA1: A = Load(Operand<ADDR_INDIRECT_X>()); break;
+	case 0xB1: A = Load(Operand<ADDR_INDIRECT_Y>()); break;
 
 
 	// LDX  Load Index X with Memory
@@ -531,11 +610,11 @@ void Mos6502CPU::Tick()
 	//      absolute      LDX oper      AE    3     4
 	//      absolute,Y    LDX oper,Y    BE    3     4*
 	
-	case 0xA2: break;
-	case 0xA6: break;
-	case 0xB6: break;
-	case 0xAE: break;
-	case 0xBE: break;
+	case 0xA2: X = Load(Operand<ADDR_IMMEDIATE>()); break;
+	case 0xA6: X = Load(Operand<ADDR_ZEROPAGE>()); break;
+	case 0xB6: X = Load(Operand<ADDR_ZEROPAGE_Y>()); break;
+	case 0xAE: X = Load(Operand<ADDR_ABSOLUTE>()); break;
+	case 0xBE: X = Load(Operand<ADDR_ABSOLUTE_Y>()); break;
 
 	// LDY  Load Index Y with Memory
 	// 
@@ -551,11 +630,11 @@ void Mos6502CPU::Tick()
 	//      absolute,X    LDY oper,X    BC    3     4*
 	
 
-	case 0xA0: break;
-	case 0xA4: break;
-	case 0xB4: break;
-	case 0xAC: break;
-	case 0xBC: break;
+	case 0xA0: Y = Load(Operand<ADDR_IMMEDIATE>()); break;
+	case 0xA4: Y = Load(Operand<ADDR_ZEROPAGE>()); break;
+	case 0xB4: Y = Load(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0xAC: Y = Load(Operand<ADDR_ABSOLUTE>()); break;
+	case 0xBC: Y = Load(Operand<ADDR_ABSOLUTE_X>()); break;
 
 	
 	// LSR  Shift One Bit Right (Memory or Accumulator)
@@ -572,11 +651,11 @@ void Mos6502CPU::Tick()
 	//      absolute,X    LSR oper,X    5E    3     7
 	
 
-	case 0x4A: break;
-	case 0x46: break;
-	case 0x56: break;
-	case 0x4E: break;
-	case 0x5E: break;
+	case 0x4A: A = LSR(A); break;
+	case 0x46: Modify<ADDR_ZEROPAGE, &Mos6502Core::LSR>(); break;
+	case 0x56: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::LSR>(); break;
+	case 0x4E: Modify<ADDR_ABSOLUTE, &Mos6502Core::LSR>(); break;
+	case 0x5E: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::LSR>(); break;
 
 
 	// NOP  No Operation
@@ -609,14 +688,14 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  ORA (oper),Y  11    2     5*
 	
 
-	case 0x09: break;
-	case 0x05: break;
-	case 0x15: break;
-	case 0x0D: break;
-	case 0x1D: break;
-	case 0x19: break;
-	case 0x01: break;
-	case 0x11: break;
+	case 0x09: ORA(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x05: ORA(Operand<ADDR_ZEROPAGE>()); break;
+	case 0x15: ORA(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0x0D: ORA(Operand<ADDR_ABSOLUTE>()); break;
+	case 0x1D: ORA(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0x19: ORA(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0x01: ORA(Operand<ADDR_INDIRECT_X>()); break;
+	case 0x11: ORA(Operand<ADDR_INDIRECT_Y>()); break;
 
 
 	// PHA  Push Accumulator on Stack
@@ -628,7 +707,7 @@ void Mos6502CPU::Tick()
 	//      --------------------------------------------
 	//      implied       PHA           48    1     3
 	
-	case 0x48: break;
+	case 0x48: Push(A); break;
 
 	// PHP  Push Processor Status on Stack
 	// 
@@ -640,7 +719,7 @@ void Mos6502CPU::Tick()
 	//      implied       PHP           08    1     3
 	
 
-	case 0x08: break;
+	case 0x08: PushStatus(true); break;
 
 
 	// PLA  Pull Accumulator from Stack
@@ -653,7 +732,7 @@ void Mos6502CPU::Tick()
 	//      implied       PLA           68    1     4
 	
 
-	case 0x68: break;
+	case 0x68: A = Load(Pull()); break;
 
 
 	// PLP  Pull Processor Status from Stack
@@ -663,10 +742,10 @@ void Mos6502CPU::Tick()
 	// 
 	//      addressing    assembler    opc  bytes  cyles
 	//      --------------------------------------------
-	//      implied       PHP           28    1     4
+	//      implied       PLP           28    1     4
 	
 
-	case 0x2B: break;
+	case 0x28: PullStatus(); break;
 
 
 	// ROL  Rotate One Bit Left (Memory or Accumulator)
@@ -683,11 +762,11 @@ void Mos6502CPU::Tick()
 	//      absolute,X    ROL oper,X    3E    3     7
 	
 
-	case 0x2A: break;
-	case 0x26: break;
-	case 0x36: break;
-	case 0x2E: break;
-	case 0x3E: break;
+	case 0x2A: A = ROL(A); break;
+	case 0x26: Modify<ADDR_ZEROPAGE, &Mos6502Core::ROL>(); break;
+	case 0x36: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::ROL>(); break;
+	case 0x2E: Modify<ADDR_ABSOLUTE, &Mos6502Core::ROL>(); break;
+	case 0x3E: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::ROL>(); break;
 
 
 	// ROR  Rotate One Bit Right (Memory or Accumulator)
@@ -704,11 +783,11 @@ void Mos6502CPU::Tick()
 	//      absolute,X    ROR oper,X    7E    3     7
 	
 
-	case 0x6A: break;
-	case 0x66: break;
-	case 0x76: break;
-	case 0x6E: break;
-	case 0x7E: break;
+	case 0x6A: A = ROR(A); break;
+	case 0x66: Modify<ADDR_ZEROPAGE, &Mos6502Core::ROR>(); break;
+	case 0x76: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::ROR>(); break;
+	case 0x6E: Modify<ADDR_ABSOLUTE, &Mos6502Core::ROR>(); break;
+	case 0x7E: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::ROR>(); break;
 
 
 	// RTI  Return from Interrupt
@@ -721,7 +800,13 @@ void Mos6502CPU::Tick()
 	//      implied       RTI           40    1     6
 	
 
-	case 0x40: break;
+	case 0x40:
+		PullStatus();
+		PC = Pull16();
+
+		if (m_callObserver != nullptr)
+			m_callObserver->OnReturn(SP);
+		break;
 
 
 	// RTS  Return from Subroutine
@@ -734,7 +819,12 @@ void Mos6502CPU::Tick()
 	//      implied       RTS           60    1     6
 	
 
-	case 0x60: break;
+	case 0x60:
+		PC = (uint16_t)(Pull16() + 1);
+
+		if (m_callObserver != nullptr)
+			m_callObserver->OnReturn(SP);
+		break;
 
 
 	// SBC  Subtract Memory from Accumulator with Borrow
@@ -753,14 +843,14 @@ void Mos6502CPU::Tick()
 	//      (indirect,X)  SBC (oper,X)  E1    2     6
 	//      (indirect),Y  SBC (oper),Y  F1    2     5*
 	
-	case 0xE9: break;
-	case 0xE5: break;
-	case 0xF5: break;
-	case 0xED: break;
-	case 0xFD: break;
-	case 0xF9: break;
-	case 0xE1: break;
-	case 0xF1: break;
+	case 0xE9: SBC(Operand<ADDR_IMMEDIATE>()); break;
+	case 0xE5: SBC(Operand<ADDR_ZEROPAGE>()); break;
+	case 0xF5: SBC(Operand<ADDR_ZEROPAGE_X>()); break;
+	case 0xED: SBC(Operand<ADDR_ABSOLUTE>()); break;
+	case 0xFD: SBC(Operand<ADDR_ABSOLUTE_X>()); break;
+	case 0xF9: SBC(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0xE1: SBC(Operand<ADDR_INDIRECT_X>()); break;
+	case 0xF1: SBC(Operand<ADDR_INDIRECT_Y>()); break;
 
 	// SEC  Set Carry Flag
 	// 
@@ -772,7 +862,7 @@ void Mos6502CPU::Tick()
 	//      implied       SEC           38    1     2
 	
 
-	case 0x38: break;
+	case 0x38: SR.C = 1; break;
 
 
 	// SED  Set Decimal Flag
@@ -785,7 +875,7 @@ void Mos6502CPU::Tick()
 	//      implied       SED           F8    1     2
 	
 
-	case 0xF8: break;
+	case 0xF8: SR.D = 1; break;
 
 
 	// SEI  Set Interrupt Disable Status
@@ -798,7 +888,7 @@ void Mos6502CPU::Tick()
 	//      implied       SEI           78    1     2
 	
 
-	case 0x78: break;
+	case 0x78: SR.I = 1; break;
 
 
 	// STA  Store Accumulator in Memory
@@ -817,13 +907,13 @@ void Mos6502CPU::Tick()
 	//      (indirect),Y  STA (oper),Y  91    2     6
 	
 
-	case 0x85: break;
-	case 0x95: break;
-	case 0x8D: break;
-	case 0x9D: break;
-	case 0x99: break;
-	case 0x81: break;
-	case 0x91: break;
+	case 0x85: Store<ADDR_ZEROPAGE>(A); break;
+	case 0x95: Store<ADDR_ZEROPAGE_X>(A); break;
+	case 0x8D: Store<ADDR_ABSOLUTE>(A); break;
+	case 0x9D: Store<ADDR_ABSOLUTE_X>(A); break;
+	case 0x99: Store<ADDR_ABSOLUTE_Y>(A); break;
+	case 0x81: Store<ADDR_INDIRECT_X>(A); break;
+	case 0x91: Store<ADDR_INDIRECT_Y>(A); break;
 
 
 	// STX  Store Index X in Memory
@@ -838,9 +928,9 @@ void Mos6502CPU::Tick()
 	//      absolute      STX oper      8E    3     4
 	
 
-	case 0x86: break;
-	case 0x96: break;
-	case 0x8E: break;
+	case 0x86: Store<ADDR_ZEROPAGE>(X); break;
+	case 0x96: Store<ADDR_ZEROPAGE_Y>(X); break;
+	case 0x8E: Store<ADDR_ABSOLUTE>(X); break;
 
 
 	// STY  Sore Index Y in Memory
@@ -855,9 +945,9 @@ void Mos6502CPU::Tick()
 	//      absolute      STY oper      8C    3     4
 	
 
-	case 0x84: break;
-	case 0x94: break;
-	case 0x8C: break;
+	case 0x84: Store<ADDR_ZEROPAGE>(Y); break;
+	case 0x94: Store<ADDR_ZEROPAGE_X>(Y); break;
+	case 0x8C: Store<ADDR_ABSOLUTE>(Y); break;
 
 
 	// TAX  Transfer Accumulator to Index X
@@ -870,7 +960,7 @@ void Mos6502CPU::Tick()
 	//      implied       TAX           AA    1     2
 	
 
-	case 0xAA: break;
+	case 0xAA: X = Load(A); break;
 
 
 	// TAY  Transfer Accumulator to Index Y
@@ -883,7 +973,7 @@ void Mos6502CPU::Tick()
 	//      implied       TAY           A8    1     2
 	
 
-	case 0xA8: break;
+	case 0xA8: Y = Load(A); break;
 
 
 	// TSX  Transfer Stack Pointer to Index X
@@ -896,7 +986,7 @@ void Mos6502CPU::Tick()
 	//      implied       TSX           BA    1     2
 	
 
-	case 0xBA: break;
+	case 0xBA: X = Load(SP); break;
 
 
 	// TXA  Transfer Index X to Accumulator
@@ -909,7 +999,7 @@ void Mos6502CPU::Tick()
 	//      implied       TXA           8A    1     2
 	
 
-	case 0x8A: break;
+	case 0x8A: A = Load(X); break;
 
 
 	// TXS  Transfer Index X to Stack Register
@@ -922,7 +1012,11 @@ void Mos6502CPU::Tick()
 	//      implied       TXS           9A    1     2
 	
 
-	case 0x9A: break;
+	case 0x9A:
+		SP = X;
+		if (m_callObserver != nullptr)
+			m_callObserver->OnStackReset(SP);
+		break;
 
 
 	// TYA  Transfer Index Y to Accumulator
@@ -934,960 +1028,509 @@ void Mos6502CPU::Tick()
 	//     --------------------------------------------
 	//     implied       TYA           98    1     2
 
-	case 0x98: break;
-
-
-	default:
-		break;
-	}
-
-
-
-}
-
-
-
-void Mos6502CPU::PrintProgram()
-{
-	uint32_t size = sizeof(RomBankMem) * m_numRomBanks;
-	uint16_t ip = 0;
-
-	uint8_t instructionsPerPage = 40;
-	uint8_t pageInstructionCount = 0;
-
-	while (ip < size)
-	{
-		if (pageInstructionCount >= instructionsPerPage)
-		{
-			system("pause");
-			pageInstructionCount = 0;
-		}
-
-		pageInstructionCount++;
-
-
-		uint8_t opCode = ((uint8_t *)m_rom)[ip];
-		std::cout << std::hex << (int)opCode << ": ";
-
- 		switch (opCode)
-		{
-			// ADC  Add Memory to Accumulator with Carry
-			// 
-			//      A + M + C -> A, C                N Z C I D V
-			//                                       + + + - - +
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     ADC #oper     69    2     2
-			//      zeropage      ADC oper      65    2     3
-			//      zeropage,X    ADC oper,X    75    2     4
-			//      absolute      ADC oper      6D    3     4
-			//      absolute,X    ADC oper,X    7D    3     4*
-			//      absolute,Y    ADC oper,Y    79    3     4*
-			//      (indirect,X)  ADC (oper,X)  61    2     6
-			//      (indirect),Y  ADC (oper),Y  71    2     5*
-
-		case 0x69: std::cout << "ADC" << std::endl; ip += 2; break;
-		case 0x65: std::cout << "ADC" << std::endl; ip += 2; break;
-		case 0x75: std::cout << "ADC" << std::endl; ip += 2; break;
-		case 0x6D: std::cout << "ADC" << std::endl; ip += 3; break;
-		case 0x7D: std::cout << "ADC" << std::endl; ip += 3; break;
-		case 0x79: std::cout << "ADC" << std::endl; ip += 3; break;
-		case 0x61: std::cout << "ADC" << std::endl; ip += 2; break;
-		case 0x71: std::cout << "ADC" << std::endl; ip += 2; break;
-
-
-			// AND  AND Memory with Accumulator
-			// 
-			//      A AND M -> A                     N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     AND #oper     29    2     2
-			//      zeropage      AND oper      25    2     3
-			//      zeropage,X    AND oper,X    35    2     4
-			//      absolute      AND oper      2D    3     4
-			//      absolute,X    AND oper,X    3D    3     4*
-			//      absolute,Y    AND oper,Y    39    3     4*
-			//      (indirect,X)  AND (oper,X)  21    2     6
-			//      (indirect),Y  AND (oper),Y  31    2     5*
-
-
-		case 0x29: std::cout << "AND" << std::endl; ip += 2; break;
-		case 0x25: std::cout << "AND" << std::endl; ip += 2; break;
-		case 0x35: std::cout << "AND" << std::endl; ip += 2; break;
-		case 0x2D: std::cout << "AND" << std::endl; ip += 3; break;
-		case 0x3D: std::cout << "AND" << std::endl; ip += 3; break;
-		case 0x39: std::cout << "AND" << std::endl; ip += 3; break;
-		case 0x21: std::cout << "AND" << std::endl; ip += 2; break;
-		case 0x31: std::cout << "AND" << std::endl; ip += 2; break;
-
-
-			// ASL  Shift Left One Bit (Memory or Accumulator)
-			// 
-			//      C <- [76543210] <- 0             N Z C I D V
-			//                                       + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      accumulator   ASL A         0A    1     2
-			//      zeropage      ASL oper      06    2     5
-			//      zeropage,X    ASL oper,X    16    2     6
-			//      absolute      ASL oper      0E    3     6
-			//      absolute,X    ASL oper,X    1E    3     7
-
-
-		case 0x0A: std::cout << "ASL" << std::endl; ip += 1; break;
-		case 0x06: std::cout << "ASL" << std::endl; ip += 2; break;
-		case 0x16: std::cout << "ASL" << std::endl; ip += 2; break;
-		case 0x0E: std::cout << "ASL" << std::endl; ip += 3; break;
-		case 0x1E: std::cout << "ASL" << std::endl; ip += 3; break;
-
-
-			// BCC  Branch on Carry Clear
-			// 
-			//      branch on C = 0                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BCC oper      90    2     2**
-
-
-		case 0x90: std::cout << "BCC" << std::endl; ip += 2; break;
-
-
-			// BCS  Branch on Carry Set
-			// 
-			//      branch on C = 1                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BCS oper      B0    2     2**
-
-		case 0xB0: std::cout << "BSC" << std::endl; ip += 2; break;
-
-			// BEQ  Branch on Result Zero
-			// 
-			//      branch on Z = 1                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BEQ oper      F0    2     2**
-
-
-		case 0xF0: std::cout << "BEQ" << std::endl; ip += 2; break;
-
-
-			// BIT  Test Bits in Memory with Accumulator
-			// 
-			//      bits 7 and 6 of operand are transfered to bit 7 and 6 of SR (N,V);
-			//      the zeroflag is set to the result of operand AND accumulator.
-			// 
-			//      A AND M, M7 -> N, M6 -> V        N Z C I D V
-			//                                      M7 + - - - M6
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      BIT oper      24    2     3
-			//      absolute      BIT oper      2C    3     4
-
-
-		case 0x24: std::cout << "BIT" << std::endl; ip += 2; break;
-		case 0x2C: std::cout << "BIT" << std::endl; ip += 3; break;
+	case 0x98: A = Load(Y); break;
 
 
-			// BMI  Branch on Result Minus
-			// 
-			//      branch on N = 1                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BMI oper      30    2     2**
+	// Unofficial opcodes
+	// https://wiki.nesdev.com/w/index.php/CPU_unofficial_opcodes
+	// the same decoding logic as the official set gives every remaining opcode a fixed behaviour,
+	// games and test roms rely on the stable ones
 
 
-		case 0x30: std::cout << "BMI" << std::endl; ip += 2; break;
-
-
-			// BNE  Branch on Result not Zero
-			// 
-			//      branch on Z = 0                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BNE oper      D0    2     2**
-
-
-		case 0xD0: std::cout << "BNE" << std::endl; ip += 2; break;
-
-			// BPL  Branch on Result Plus
-			// 
-			//      branch on N = 0                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BPL oper      10    2     2**
-
-
-		case 0x10: std::cout << "BPL" << std::endl; ip += 2; break;
-
-
-			// BRK  Force Break
-			// 
-			//      interrupt,                       N Z C I D V
-			//      push PC+2, push SR               - - - 1 - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       BRK           00    1     7
-
-
-		case 0x00: std::cout << "BRK" << std::endl; ip += 1; break;
-
-
-			// BVC  Branch on Overflow Clear
-			// 
-			//      branch on V = 0                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BVC oper      50    2     2**
-
-
-		case 0x50: std::cout << "BVC" << std::endl; ip += 2; break;
-
-
-			// BVS  Branch on Overflow Set
-			// 
-			//      branch on V = 1                  N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      relative      BVC oper      70    2     2**
-
-
-		case 0x70: std::cout << "BVS" << std::endl; ip += 2; break;
-
-
-			// CLC  Clear Carry Flag
-			// 
-			//      0 -> C                           N Z C I D V
-			//                                       - - 0 - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       CLC           18    1     2
-
-
-		case 0x18: std::cout << "CLC" << std::endl; ip += 1; break;
-
-
-			// CLD  Clear Decimal Mode
-			// 
-			//      0 -> D                           N Z C I D V
-			//                                       - - - - 0 -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       CLD           D8    1     2
-
-
-		case 0xD8: std::cout << "CLD" << std::endl; ip += 1; break;
-
-
-			// CLI  Clear Interrupt Disable Bit
-			// 
-			//      0 -> I                           N Z C I D V
-			//                                       - - - 0 - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       CLI           58    1     2
-
-
-		case 0x58: std::cout << "CLI" << std::endl; ip += 1; break;
-
-
-			// CLV  Clear Overflow Flag
-			// 
-			//      0 -> V                           N Z C I D V
-			//                                       - - - - - 0
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       CLV           B8    1     2
-
-
-		case 0xB8: std::cout << "CLV" << std::endl; ip += 1; break;
-
-			// CMP  Compare Memory with Accumulator
-			// 
-			//      A - M                            N Z C I D V
-			//                                     + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     CMP #oper     C9    2     2
-			//      zeropage      CMP oper      C5    2     3
-			//      zeropage,X    CMP oper,X    D5    2     4
-			//      absolute      CMP oper      CD    3     4
-			//      absolute,X    CMP oper,X    DD    3     4*
-			//      absolute,Y    CMP oper,Y    D9    3     4*
-			//      (indirect,X)  CMP (oper,X)  C1    2     6
-			//      (indirect),Y  CMP (oper),Y  D1    2     5*
-
-
-		case 0xC9: std::cout << "CMP" << std::endl; ip += 2; break;
-		case 0xC5: std::cout << "CMP" << std::endl; ip += 2; break;
-		case 0xD5: std::cout << "CMP" << std::endl; ip += 3; break;
-		case 0xCD: std::cout << "CMP" << std::endl; ip += 3; break;
-		case 0xDD: std::cout << "CMP" << std::endl; ip += 3; break;
-		case 0xD9: std::cout << "CMP" << std::endl; ip += 3; break;
-		case 0xC1: std::cout << "CMP" << std::endl; ip += 2; break;
-		case 0xD1: std::cout << "CMP" << std::endl; ip += 2; break;
-
-
-			// CPX  Compare Memory and Index X
-			// 
-			//      X - M                            N Z C I D V
-			//                                       + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     CPX #oper     E0    2     2
-			//      zeropage      CPX oper      E4    2     3
-			//      absolute      CPX oper      EC    3     4
-
-
-		case 0xE0: std::cout << "CPX" << std::endl; ip += 2; break;
-		case 0xE4: std::cout << "CPX" << std::endl; ip += 2; break;
-		case 0xEC: std::cout << "CPX" << std::endl; ip += 3; break;
-
-
-			// CPY  Compare Memory and Index Y
-			// 
-			//      Y - M                            N Z C I D V
-			//                                       + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     CPY #oper     C0    2     2
-			//      zeropage      CPY oper      C4    2     3
-			//      absolute      CPY oper      CC    3     4
-
-
-		case 0xC0: std::cout << "CPY" << std::endl; ip += 2; break;
-		case 0xC4: std::cout << "CPY" << std::endl; ip += 2; break;
-		case 0xCC: std::cout << "CPY" << std::endl; ip += 3; break;
-
-
-			// DEC  Decrement Memory by One
-			// 
-			//      M - 1 -> M                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      DEC oper      C6    2     5
-			//      zeropage,X    DEC oper,X    D6    2     6
-			//      absolute      DEC oper      CE    3     3
-			//      absolute,X    DEC oper,X    DE    3     7
-
-
-		case 0xC6: std::cout << "DEC" << std::endl; ip += 2; break;
-		case 0xD6: std::cout << "DEC" << std::endl; ip += 2; break;
-		case 0xCE: std::cout << "DEC" << std::endl; ip += 3; break;
-		case 0xDE: std::cout << "DEC" << std::endl; ip += 3; break;
-
-
-			// DEX  Decrement Index X by One
-			// 
-			//      X - 1 -> X                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       DEC           CA    1     2
-
-
-		case 0xCA: std::cout << "DEX" << std::endl; ip += 1; break;
-
-
-			// DEY  Decrement Index Y by One
-			// 
-			//      Y - 1 -> Y                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       DEC           88    1     2
-
-		case 0x88: std::cout << "DEY" << std::endl; ip += 1; break;
-
-			// EOR  Exclusive-OR Memory with Accumulator
-			// 
-			//      A EOR M -> A                     N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     EOR #oper     49    2     2
-			//      zeropage      EOR oper      45    2     3
-			//      zeropage,X    EOR oper,X    55    2     4
-			//      absolute      EOR oper      4D    3     4
-			//      absolute,X    EOR oper,X    5D    3     4*
-			//      absolute,Y    EOR oper,Y    59    3     4*
-			//      (indirect,X)  EOR (oper,X)  41    2     6
-			//      (indirect),Y  EOR (oper),Y  51    2     5*
-
-
-		case 0x49: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x45: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x55: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x4D: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x5D: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x59: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x41: std::cout << "EOR" << std::endl; ip += 1; break;
-		case 0x51: std::cout << "EOR" << std::endl; ip += 1; break;
-
-
-			// INC  Increment Memory by One
-			// 
-			//      M + 1 -> M                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      INC oper      E6    2     5
-			//      zeropage,X    INC oper,X    F6    2     6
-			//      absolute      INC oper      EE    3     6
-			//      absolute,X    INC oper,X    FE    3     7
-
-
-		case 0xE6: std::cout << "INC" << std::endl; ip += 2; break;
-		case 0xF6: std::cout << "INC" << std::endl; ip += 2; break;
-		case 0xEE: std::cout << "INC" << std::endl; ip += 3; break;
-		case 0xFE: std::cout << "INC" << std::endl; ip += 3; break;
-
-
-			// INX  Increment Index X by One
-			// 
-			//      X + 1 -> X                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       INX           E8    1     2
-
-
-		case 0xE8: std::cout << "INX" << std::endl; ip += 1; break;
-
-
-			// INY  Increment Index Y by One
-			// 
-			//      Y + 1 -> Y                       N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       INY           C8    1     2
-
-
-		case 0xC8: std::cout << "INY" << std::endl; ip += 1; break;
-
-
-			// JMP  Jump to New Location
-			// 
-			//      (PC+1) -> PCL                    N Z C I D V
-			//      (PC+2) -> PCH                    - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      absolute      JMP oper      4C    3     3
-			//      indirect      JMP (oper)    6C    3     5
-
-
-		case 0x4C: std::cout << "JMP" << std::endl; ip += 3; break;
-		case 0x6C: std::cout << "JMP" << std::endl; ip += 3; break;
-
-
-			// JSR  Jump to New Location Saving Return Address
-			// 
-			//      push (PC+2),                     N Z C I D V
-			//      (PC+1) -> PCL                    - - - - - -
-			//      (PC+2) -> PCH
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      absolute      JSR oper      20    3     6
-
-
-		case 0x20: std::cout << "JSR" << std::endl; ip += 3; break;
-
-
-			// LDA  Load Accumulator with Memory
-			// 
-			//      M -> A                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     LDA #oper     A9    2     2
-			//      zeropage      LDA oper      A5    2     3
-			//      zeropage,X    LDA oper,X    B5    2     4
-			//      absolute      LDA oper      AD    3     4
-			//      absolute,X    LDA oper,X    BD    3     4*
-			//      absolute,Y    LDA oper,Y    B9    3     4*
-			//      (indirect,X)  LDA (oper,X)  A1    2     6
-			//      (indirect),Y  LDA (oper),Y  B1    2     5*
-
-
-		case 0xA9: std::cout << "LDA" << std::endl; ip += 2; break;
-		case 0xA5: std::cout << "LDA" << std::endl; ip += 2; break;
-		case 0xB5: std::cout << "LDA" << std::endl; ip += 2; break;
-		case 0xAD: std::cout << "LDA" << std::endl; ip += 3; break;
-		case 0xBD: std::cout << "LDA" << std::endl; ip += 3; break;
-		case 0xB9: std::cout << "LDA" << std::endl; ip += 3; break;
-		case 0xA1: std::cout << "LDA" << std::endl; ip += 2; break;
-		case 0xB1: std::cout << "LDA" << std::endl; ip += 2; break;
-
-
-			// LDX  Load Index X with Memory
-			// 
-			//      M -> X                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     LDX #oper     A2    2     2
-			//      zeropage      LDX oper      A6    2     3
-			//      zeropage,Y    LDX oper,Y    B6    2     4
-			//      absolute      LDX oper      AE    3     4
-			//      absolute,Y    LDX oper,Y    BE    3     4*
-
-		case 0xA2: std::cout << "LDX" << std::endl; ip += 2; break;
-		case 0xA6: std::cout << "LDX" << std::endl; ip += 2; break;
-		case 0xB6: std::cout << "LDX" << std::endl; ip += 2; break;
-		case 0xAE: std::cout << "LDX" << std::endl; ip += 3; break;
-		case 0xBE: std::cout << "LDX" << std::endl; ip += 3; break;
-
-			// LDY  Load Index Y with Memory
-			// 
-			//      M -> Y                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     LDY #oper     A0    2     2
-			//      zeropage      LDY oper      A4    2     3
-			//      zeropage,X    LDY oper,X    B4    2     4
-			//      absolute      LDY oper      AC    3     4
-			//      absolute,X    LDY oper,X    BC    3     4*
-
-
-		case 0xA0: std::cout << "LDY" << std::endl; ip += 2; break;
-		case 0xA4: std::cout << "LDY" << std::endl; ip += 2; break;
-		case 0xB4: std::cout << "LDY" << std::endl; ip += 2; break;
-		case 0xAC: std::cout << "LDY" << std::endl; ip += 3; break;
-		case 0xBC: std::cout << "LDY" << std::endl; ip += 3; break;
-
-
-			// LSR  Shift One Bit Right (Memory or Accumulator)
-			// 
-			//      0 -> [76543210] -> C             N Z C I D V
-			//                                       - + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      accumulator   LSR A         4A    1     2
-			//      zeropage      LSR oper      46    2     5
-			//      zeropage,X    LSR oper,X    56    2     6
-			//      absolute      LSR oper      4E    3     6
-			//      absolute,X    LSR oper,X    5E    3     7
-
-
-		case 0x4A: std::cout << "LSR" << std::endl; ip += 1; break;
-		case 0x46: std::cout << "LSR" << std::endl; ip += 2; break;
-		case 0x56: std::cout << "LSR" << std::endl; ip += 2; break;
-		case 0x4E: std::cout << "LSR" << std::endl; ip += 3; break;
-		case 0x5E: std::cout << "LSR" << std::endl; ip += 3; break;
-
-
-			// NOP  No Operation
-			// 
-			//      ---                              N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       NOP           EA    1     2
-
-
-		case 0xEA: std::cout << "NOP" << std::endl; ip += 1; break;
-
-
-			// ORA  OR Memory with Accumulator
-			// 
-			//      A OR M -> A                      N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     ORA #oper     09    2     2
-			//      zeropage      ORA oper      05    2     3
-			//      zeropage,X    ORA oper,X    15    2     4
-			//      absolute      ORA oper      0D    3     4
-			//      absolute,X    ORA oper,X    1D    3     4*
-			//      absolute,Y    ORA oper,Y    19    3     4*
-			//      (indirect,X)  ORA (oper,X)  01    2     6
-			//      (indirect),Y  ORA (oper),Y  11    2     5*
-
-
-		case 0x09: std::cout << "ORA" << std::endl; ip += 2; break;
-		case 0x05: std::cout << "ORA" << std::endl; ip += 2; break;
-		case 0x15: std::cout << "ORA" << std::endl; ip += 2; break;
-		case 0x0D: std::cout << "ORA" << std::endl; ip += 3; break;
-		case 0x1D: std::cout << "ORA" << std::endl; ip += 3; break;
-		case 0x19: std::cout << "ORA" << std::endl; ip += 3; break;
-		case 0x01: std::cout << "ORA" << std::endl; ip += 2; break;
-		case 0x11: std::cout << "ORA" << std::endl; ip += 2; break;
-
-
-			// PHA  Push Accumulator on Stack
-			// 
-			//      push A                           N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       PHA           48    1     3
-
-		case 0x48: std::cout << "PHA" << std::endl; ip += 1; break;
-
-			// PHP  Push Processor Status on Stack
-			// 
-			//      push SR                          N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       PHP           08    1     3
-
-
-		case 0x08: std::cout << "PHP" << std::endl; ip += 1; break;
-
-
-			// PLA  Pull Accumulator from Stack
-			// 
-			//      pull A                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       PLA           68    1     4
-
-
-		case 0x68: std::cout << "PLA" << std::endl; ip += 1; break;
-
-
-			// PLP  Pull Processor Status from Stack
-			// 
-			//      pull SR                          N Z C I D V
-			//                                       from stack
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       PHP           28    1     4
-
-
-		case 0x2B: std::cout << "PLP" << std::endl; ip += 1; break;
-
-
-			// ROL  Rotate One Bit Left (Memory or Accumulator)
-			// 
-			//      C <- [76543210] <- C             N Z C I D V
-			//                                       + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      accumulator   ROL A         2A    1     2
-			//      zeropage      ROL oper      26    2     5
-			//      zeropage,X    ROL oper,X    36    2     6
-			//      absolute      ROL oper      2E    3     6
-			//      absolute,X    ROL oper,X    3E    3     7
-
-
-		case 0x2A: std::cout << "ROL" << std::endl; ip += 1; break;
-		case 0x26: std::cout << "ROL" << std::endl; ip += 2; break;
-		case 0x36: std::cout << "ROL" << std::endl; ip += 2; break;
-		case 0x2E: std::cout << "ROL" << std::endl; ip += 3; break;
-		case 0x3E: std::cout << "ROL" << std::endl; ip += 3; break;
-
-
-			// ROR  Rotate One Bit Right (Memory or Accumulator)
-			// 
-			//      C -> [76543210] -> C             N Z C I D V
-			//                                       + + + - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      accumulator   ROR A         6A    1     2
-			//      zeropage      ROR oper      66    2     5
-			//      zeropage,X    ROR oper,X    76    2     6
-			//      absolute      ROR oper      6E    3     6
-			//      absolute,X    ROR oper,X    7E    3     7
-
-
-		case 0x6A: std::cout << "ROR" << std::endl; ip += 1; break;
-		case 0x66: std::cout << "ROR" << std::endl; ip += 2; break;
-		case 0x76: std::cout << "ROR" << std::endl; ip += 2; break;
-		case 0x6E: std::cout << "ROR" << std::endl; ip += 3; break;
-		case 0x7E: std::cout << "ROR" << std::endl; ip += 3; break;
-
-
-			// RTI  Return from Interrupt
-			// 
-			//      pull SR, pull PC                 N Z C I D V
-			//                                       from stack
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       RTI           40    1     6
-
-
-		case 0x40: std::cout << "RTI" << std::endl; ip += 1; break;
-
-
-			// RTS  Return from Subroutine
-			// 
-			//      pull PC, PC+1 -> PC              N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       RTS           60    1     6
-
-
-		case 0x60: std::cout << "RTS" << std::endl; ip += 1; break;
-
-
-			// SBC  Subtract Memory from Accumulator with Borrow
-			// 
-			//      A - M - C -> A                   N Z C I D V
-			//                                       + + + - - +
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      immidiate     SBC #oper     E9    2     2
-			//      zeropage      SBC oper      E5    2     3
-			//      zeropage,X    SBC oper,X    F5    2     4
-			//      absolute      SBC oper      ED    3     4
-			//      absolute,X    SBC oper,X    FD    3     4*
-			//      absolute,Y    SBC oper,Y    F9    3     4*
-			//      (indirect,X)  SBC (oper,X)  E1    2     6
-			//      (indirect),Y  SBC (oper),Y  F1    2     5*
-
-		case 0xE9: std::cout << "SBC" << std::endl; ip += 2; break;
-		case 0xE5: std::cout << "SBC" << std::endl; ip += 2; break;
-		case 0xF5: std::cout << "SBC" << std::endl; ip += 2; break;
-		case 0xED: std::cout << "SBC" << std::endl; ip += 3; break;
-		case 0xFD: std::cout << "SBC" << std::endl; ip += 3; break;
-		case 0xF9: std::cout << "SBC" << std::endl; ip += 3; break;
-		case 0xE1: std::cout << "SBC" << std::endl; ip += 2; break;
-		case 0xF1: std::cout << "SBC" << std::endl; ip += 2; break;
-
-			// SEC  Set Carry Flag
-			// 
-			//      1 -> C                           N Z C I D V
-			//                                       - - 1 - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       SEC           38    1     2
-
-
-		case 0x38: std::cout << "SEC" << std::endl; ip += 1; break;
-
-
-			// SED  Set Decimal Flag
-			// 
-			//      1 -> D                           N Z C I D V
-			//                                       - - - - 1 -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       SED           F8    1     2
-
-
-		case 0xF8: std::cout << "SED" << std::endl; ip += 1; break;
-
-
-			// SEI  Set Interrupt Disable Status
-			// 
-			//      1 -> I                           N Z C I D V
-			//                                       - - - 1 - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       SEI           78    1     2
-
-
-		case 0x78: std::cout << "SEI" << std::endl; ip += 1; break;
-
-
-			// STA  Store Accumulator in Memory
-			// 
-			//      A -> M                           N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      STA oper      85    2     3
-			//      zeropage,X    STA oper,X    95    2     4
-			//      absolute      STA oper      8D    3     4
-			//      absolute,X    STA oper,X    9D    3     5
-			//      absolute,Y    STA oper,Y    99    3     5
-			//      (indirect,X)  STA (oper,X)  81    2     6
-			//      (indirect),Y  STA (oper),Y  91    2     6
-
-
-		case 0x85: std::cout << "STA" << std::endl; ip += 2; break;
-		case 0x95: std::cout << "STA" << std::endl; ip += 2; break;
-		case 0x8D: std::cout << "STA" << std::endl; ip += 3; break;
-		case 0x9D: std::cout << "STA" << std::endl; ip += 3; break;
-		case 0x99: std::cout << "STA" << std::endl; ip += 3; break;
-		case 0x81: std::cout << "STA" << std::endl; ip += 2; break;
-		case 0x91: std::cout << "STA" << std::endl; ip += 2; break;
-
-
-			// STX  Store Index X in Memory
-			// 
-			//      X -> M                           N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      STX oper      86    2     3
-			//      zeropage,Y    STX oper,Y    96    2     4
-			//      absolute      STX oper      8E    3     4
+	// SLO  Shift Left One Bit, then OR Memory with Accumulator (ASL + ORA)
+	//
+	//      M = C <- [76543210] <- 0, A OR M -> A       N Z C I D V
+	//                                                  + + + - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      SLO oper      07    2     5
+	//      zeropage,X    SLO oper,X    17    2     6
+	//      absolute      SLO oper      0F    3     6
+	//      absolute,X    SLO oper,X    1F    3     7
+	//      absolute,Y    SLO oper,Y    1B    3     7
+	//      (indirect,X)  SLO (oper,X)  03    2     8
+	//      (indirect),Y  SLO (oper),Y  13    2     8
+
+	case 0x07: Modify<ADDR_ZEROPAGE, &Mos6502Core::SLO>(); break;
+	case 0x17: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::SLO>(); break;
+	case 0x0F: Modify<ADDR_ABSOLUTE, &Mos6502Core::SLO>(); break;
+	case 0x1F: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::SLO>(); break;
+	case 0x1B: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::SLO>(); break;
+	case 0x03: Modify<ADDR_INDIRECT_X, &Mos6502Core::SLO>(); break;
+	case 0x13: Modify<ADDR_INDIRECT_Y, &Mos6502Core::SLO>(); break;
+
+
+	// RLA  Rotate Left One Bit, then AND Memory with Accumulator (ROL + AND)
+	//
+	//      M = C <- [76543210] <- C, A AND M -> A      N Z C I D V
+	//                                                  + + + - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      RLA oper      27    2     5
+	//      zeropage,X    RLA oper,X    37    2     6
+	//      absolute      RLA oper      2F    3     6
+	//      absolute,X    RLA oper,X    3F    3     7
+	//      absolute,Y    RLA oper,Y    3B    3     7
+	//      (indirect,X)  RLA (oper,X)  23    2     8
+	//      (indirect),Y  RLA (oper),Y  33    2     8
+
+	case 0x27: Modify<ADDR_ZEROPAGE, &Mos6502Core::RLA>(); break;
+	case 0x37: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::RLA>(); break;
+	case 0x2F: Modify<ADDR_ABSOLUTE, &Mos6502Core::RLA>(); break;
+	case 0x3F: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::RLA>(); break;
+	case 0x3B: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::RLA>(); break;
+	case 0x23: Modify<ADDR_INDIRECT_X, &Mos6502Core::RLA>(); break;
+	case 0x33: Modify<ADDR_INDIRECT_Y, &Mos6502Core::RLA>(); break;
+
+
+	// SRE  Shift Right One Bit, then EOR Memory with Accumulator (LSR + EOR)
+	//
+	//      M = 0 -> [76543210] -> C, A EOR M -> A      N Z C I D V
+	//                                                  + + + - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      SRE oper      47    2     5
+	//      zeropage,X    SRE oper,X    57    2     6
+	//      absolute      SRE oper      4F    3     6
+	//      absolute,X    SRE oper,X    5F    3     7
+	//      absolute,Y    SRE oper,Y    5B    3     7
+	//      (indirect,X)  SRE (oper,X)  43    2     8
+	//      (indirect),Y  SRE (oper),Y  53    2     8
+
+	case 0x47: Modify<ADDR_ZEROPAGE, &Mos6502Core::SRE>(); break;
+	case 0x57: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::SRE>(); break;
+	case 0x4F: Modify<ADDR_ABSOLUTE, &Mos6502Core::SRE>(); break;
+	case 0x5F: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::SRE>(); break;
+	case 0x5B: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::SRE>(); break;
+	case 0x43: Modify<ADDR_INDIRECT_X, &Mos6502Core::SRE>(); break;
+	case 0x53: Modify<ADDR_INDIRECT_Y, &Mos6502Core::SRE>(); break;
+
+
+	// RRA  Rotate Right One Bit, then Add Memory to Accumulator with Carry (ROR + ADC)
+	//
+	//      M = C -> [76543210] -> C, A + M + C -> A, C N Z C I D V
+	//                                                  + + + - - +
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      RRA oper      67    2     5
+	//      zeropage,X    RRA oper,X    77    2     6
+	//      absolute      RRA oper      6F    3     6
+	//      absolute,X    RRA oper,X    7F    3     7
+	//      absolute,Y    RRA oper,Y    7B    3     7
+	//      (indirect,X)  RRA (oper,X)  63    2     8
+	//      (indirect),Y  RRA (oper),Y  73    2     8
+
+	case 0x67: Modify<ADDR_ZEROPAGE, &Mos6502Core::RRA>(); break;
+	case 0x77: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::RRA>(); break;
+	case 0x6F: Modify<ADDR_ABSOLUTE, &Mos6502Core::RRA>(); break;
+	case 0x7F: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::RRA>(); break;
+	case 0x7B: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::RRA>(); break;
+	case 0x63: Modify<ADDR_INDIRECT_X, &Mos6502Core::RRA>(); break;
+	case 0x73: Modify<ADDR_INDIRECT_Y, &Mos6502Core::RRA>(); break;
+
+
+	// SAX  Store Accumulator AND Index X in Memory
+	//
+	//      A AND X -> M                     N Z C I D V
+	//                                       - - - - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      SAX oper      87    2     3
+	//      zeropage,Y    SAX oper,Y    97    2     4
+	//      absolute      SAX oper      8F    3     4
+	//      (indirect,X)  SAX (oper,X)  83    2     6
 
-
-		case 0x86: std::cout << "STX" << std::endl; ip += 2; break;
-		case 0x96: std::cout << "STX" << std::endl; ip += 2; break;
-		case 0x8E: std::cout << "STX" << std::endl; ip += 3; break;
+	case 0x87: Store<ADDR_ZEROPAGE>(A & X); break;
+	case 0x97: Store<ADDR_ZEROPAGE_Y>(A & X); break;
+	case 0x8F: Store<ADDR_ABSOLUTE>(A & X); break;
+	case 0x83: Store<ADDR_INDIRECT_X>(A & X); break;
 
 
-			// STY  Sore Index Y in Memory
-			// 
-			//      Y -> M                           N Z C I D V
-			//                                       - - - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      zeropage      STY oper      84    2     3
-			//      zeropage,X    STY oper,X    94    2     4
-			//      absolute      STY oper      8C    3     4
+	// LAX  Load Accumulator and Index X with Memory
+	//
+	//      M -> A -> X                      N Z C I D V
+	//                                       + + - - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      LAX oper      A7    2     3
+	//      zeropage,Y    LAX oper,Y    B7    2     4
+	//      absolute      LAX oper      AF    3     4
+	//      absolute,Y    LAX oper,Y    BF    3     4*
+	//      (indirect,X)  LAX (oper,X)  A3    2     6
+	//      (indirect),Y  LAX (oper),Y  B3    2     5*
+
+	case 0xA7: LAX(Operand<ADDR_ZEROPAGE>()); break;
+	case 0xB7: LAX(Operand<ADDR_ZEROPAGE_Y>()); break;
+	case 0xAF: LAX(Operand<ADDR_ABSOLUTE>()); break;
+	case 0xBF: LAX(Operand<ADDR_ABSOLUTE_Y>()); break;
+	case 0xA3: LAX(Operand<ADDR_INDIRECT_X>()); break;
+	case 0xB3: LAX(Operand<ADDR_INDIRECT_Y>()); break;
+
+
+	// DCP  Decrement Memory by One, then Compare with Accumulator (DEC + CMP)
+	//
+	//      M - 1 -> M, A - M                N Z C I D V
+	//                                       + + + - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      DCP oper      C7    2     5
+	//      zeropage,X    DCP oper,X    D7    2     6
+	//      absolute      DCP oper      CF    3     6
+	//      absolute,X    DCP oper,X    DF    3     7
+	//      absolute,Y    DCP oper,Y    DB    3     7
+	//      (indirect,X)  DCP (oper,X)  C3    2     8
+	//      (indirect),Y  DCP (oper),Y  D3    2     8
+
+	case 0xC7: Modify<ADDR_ZEROPAGE, &Mos6502Core::DCP>(); break;
+	case 0xD7: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::DCP>(); break;
+	case 0xCF: Modify<ADDR_ABSOLUTE, &Mos6502Core::DCP>(); break;
+	case 0xDF: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::DCP>(); break;
+	case 0xDB: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::DCP>(); break;
+	case 0xC3: Modify<ADDR_INDIRECT_X, &Mos6502Core::DCP>(); break;
+	case 0xD3: Modify<ADDR_INDIRECT_Y, &Mos6502Core::DCP>(); break;
+
+
+	// ISC  Increment Memory by One, then Subtract Memory from Accumulator with Borrow (INC + SBC)
+	//
+	//      M + 1 -> M, A - M - C -> A       N Z C I D V
+	//                                       + + + - - +
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      zeropage      ISC oper      E7    2     5
+	//      zeropage,X    ISC oper,X    F7    2     6
+	//      absolute      ISC oper      EF    3     6
+	//      absolute,X    ISC oper,X    FF    3     7
+	//      absolute,Y    ISC oper,Y    FB    3     7
+	//      (indirect,X)  ISC (oper,X)  E3    2     8
+	//      (indirect),Y  ISC (oper),Y  F3    2     8
+
+	case 0xE7: Modify<ADDR_ZEROPAGE, &Mos6502Core::ISC>(); break;
+	case 0xF7: Modify<ADDR_ZEROPAGE_X, &Mos6502Core::ISC>(); break;
+	case 0xEF: Modify<ADDR_ABSOLUTE, &Mos6502Core::ISC>(); break;
+	case 0xFF: Modify<ADDR_ABSOLUTE_X, &Mos6502Core::ISC>(); break;
+	case 0xFB: Modify<ADDR_ABSOLUTE_Y, &Mos6502Core::ISC>(); break;
+	case 0xE3: Modify<ADDR_INDIRECT_X, &Mos6502Core::ISC>(); break;
+	case 0xF3: Modify<ADDR_INDIRECT_Y, &Mos6502Core::ISC>(); break;
+
+
+	// immediate only: ANC, ALR, ARR, SBX, the SBC duplicate and the unstable ANE / LXA
+	//
+	//      ANC  A AND M -> A, N -> C        N Z C I D V   + + + - - -
+	//      ALR  (A AND M) / 2 -> A          N Z C I D V   + + + - - -
+	//      ARR  (A AND M) / 2 + C * 128 -> A, C = bit 6, V = bit 6 EOR bit 5
+	//                                       N Z C I D V   + + + - - +
+	//      SBX  (A AND X) - M -> X          N Z C I D V   + + + - - -
+	//      ANE  (A OR $EE) AND X AND M -> A N Z C I D V   + + - - - -
+	//      LXA  M -> A -> X                 N Z C I D V   + + - - - -
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      immidiate     ANC #oper     0B    2     2
+	//      immidiate     ANC #oper     2B    2     2
+	//      immidiate     ALR #oper     4B    2     2
+	//      immidiate     ARR #oper     6B    2     2
+	//      immidiate     ANE #oper     8B    2     2
+	//      immidiate     LXA #oper     AB    2     2
+	//      immidiate     SBX #oper     CB    2     2
+	//      immidiate     SBC #oper     EB    2     2
+	//
+	// ANE and LXA mix in a chip dependent constant, $EE for ANE and $FF for LXA are the common values
 
+	case 0x0B: ANC(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x2B: ANC(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x4B: ALR(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x6B: ARR(Operand<ADDR_IMMEDIATE>()); break;
+	case 0x8B: A = Load((uint8_t)((A | 0xEE) & X & Operand<ADDR_IMMEDIATE>())); break;
+	case 0xAB: LAX(Operand<ADDR_IMMEDIATE>()); break;
+	case 0xCB: SBX(Operand<ADDR_IMMEDIATE>()); break;
+	case 0xEB: SBC(Operand<ADDR_IMMEDIATE>()); break;
 
-		case 0x84: std::cout << "STY" << std::endl; ip += 2; break;
-		case 0x94: std::cout << "STY" << std::endl; ip += 2; break;
-		case 0x8C: std::cout << "STY" << std::endl; ip += 3; break;
 
+	// SHA, SHX, SHY, TAS, LAS  the unstable indexed stores and LAS
+	//
+	//      SHA  A AND X AND (H + 1) -> M
+	//      SHX  X AND (H + 1) -> M
+	//      SHY  Y AND (H + 1) -> M
+	//      TAS  A AND X -> SP, SP AND (H + 1) -> M
+	//      LAS  M AND SP -> A, X, SP        N Z C I D V   + + - - - -
+	//
+	//      H is the high byte of the address before indexing
+	//
+	//      addressing    assembler    opc  bytes  cyles
+	//      --------------------------------------------
+	//      absolute,Y    SHA oper,Y    9F    3     5
+	//      (indirect),Y  SHA (oper),Y  93    2     6
+	//      absolute,Y    SHX oper,Y    9E    3     5
+	//      absolute,X    SHY oper,X    9C    3     5
+	//      absolute,Y    TAS oper,Y    9B    3     5
+	//      absolute,Y    LAS oper,Y    BB    3     4*
+
+	case 0x9F: StoreHighAnd(Address<ADDR_ABSOLUTE>(), Y, A & X); break;
+	case 0x93: StoreHighAnd(ReadPointer(Read(PC++)), Y, A & X); break;
+	case 0x9E: StoreHighAnd(Address<ADDR_ABSOLUTE>(), Y, X); break;
+	case 0x9C: StoreHighAnd(Address<ADDR_ABSOLUTE>(), X, Y); break;
+	case 0x9B: SP = A & X; StoreHighAnd(Address<ADDR_ABSOLUTE>(), Y, SP); break;
+	case 0xBB: LAS(Operand<ADDR_ABSOLUTE_Y>()); break;
+
+
+	// NOP  No Operation, the unofficial ones still read their operand
+	//
+	//      ---                              N Z C I D V
+	//                                       - - - - - -
+	//
+	//      addressing    assembler    opc                  bytes  cyles
+	//      --------------------------------------------------------------
+	//      implied       NOP           1A 3A 5A 7A DA FA     1     2
+	//      immidiate     NOP #oper     80 82 89 C2 E2        2     2
+	//      zeropage      NOP oper      04 44 64              2     3
+	//      zeropage,X    NOP oper,X    14 34 54 74 D4 F4     2     4
+	//      absolute      NOP oper      0C                    3     4
+	//      absolute,X    NOP oper,X    1C 3C 5C 7C DC FC     3     4*
+
+	case 0x1A: case 0x3A: case 0x5A: case 0x7A: case 0xDA: case 0xFA: break;
+	case 0x80: case 0x82: case 0x89: case 0xC2: case 0xE2: Operand<ADDR_IMMEDIATE>(); break;
+	case 0x04: case 0x44: case 0x64: Operand<ADDR_ZEROPAGE>(); break;
+	case 0x14: case 0x34: case 0x54: case 0x74: case 0xD4: case 0xF4: Operand<ADDR_ZEROPAGE_X>(); break;
+	case 0x0C: Operand<ADDR_ABSOLUTE>(); break;
+	case 0x1C: case 0x3C: case 0x5C: case 0x7C: case 0xDC: case 0xFC: Operand<ADDR_ABSOLUTE_X>(); break;
+
+
+	// JAM  Halt the cpu
+	//
+	//      addressing    assembler    opc                                  bytes  cyles
+	//      ------------------------------------------------------------------------------
+	//      implied       JAM           02 12 22 32 42 52 62 72 92 B2 D2 F2   1     -
+	//
+	// the cpu stops fetching until reset. pc is left on the opcode so it executes again every
+	// Tick(), which the test runner sees as a trap. Interrupts are still taken, a real jammed
+	// cpu ignores them
 
-			// TAX  Transfer Accumulator to Index X
-			// 
-			//      A -> X                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       TAX           AA    1     2
+	case 0x02: case 0x12: case 0x22: case 0x32: case 0x42: case 0x52:
+	case 0x62: case 0x72: case 0x92: case 0xB2: case 0xD2: case 0xF2: PC--; break;
 
 
-		case 0xAA: std::cout << "TAX" << std::endl; ip += 1; break;
+	default:
+		break;
+	}
 
+#if NES_CPU_PROFILER
+	if (m_profiler != nullptr)
+		m_profiler->Record(profilePC, opCode, (uint32_t)(m_cycles - profileCycles));
+#endif
+}
 
-			// TAY  Transfer Accumulator to Index Y
-			// 
-			//      A -> Y                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       TAY           A8    1     2
+template<typename Variant>
+void Mos6502Core<Variant>::FuseStore(uint64_t cycleLimit)
+{
+	// the operand is looked at before deciding, so the whole STA has to be in one page of plain memory.
+	// A store to plain memory is not seen by the ppu or apu, it does not matter that they catch up after it
+	const uint8_t *next = m_bus.GetReadPointer(PC);
+	if (m_cycles >= cycleLimit || next == nullptr || (PC & 0xFF) > 0xFD)
+		return;
+
+	uint16_t target;
+	if (next[0] == 0x85)
+		target = next[1];
+	else if (next[0] == 0x8D)
+		target = (uint16_t)(next[1] | (next[2] << 8));
+	else
+		return;
+
+	uint8_t *memory = m_bus.GetWritePointer(target);
+	if (memory == nullptr)
+		return;
+
+	*memory = A;
+	PC += Mos6502OpCodeTable[next[0]].bytes;
+	m_cycles += Mos6502OpCodeTable[next[0]].cycles;
+	m_fusedCount++;
+}
 
+template<typename Variant>
+uint16_t Mos6502Core<Variant>::ReadIndirectJumpTarget(uint16_t pointer)
+{
+	// JMP ($xxFF) fetches the high byte from $xx00, the carry into the high byte is lost
+	uint16_t hiAddress = (uint16_t)((pointer & 0xFF00) | ((pointer + 1) & 0x00FF));
+	return (uint16_t)(Read(pointer) | (Read(hiAddress) << 8));
+}
 
-		case 0xA8: std::cout << "TAY" << std::endl; ip += 1; break;
+template<typename Variant>
+void Mos6502Core<Variant>::AddBinary(uint8_t value)
+{
+	uint32_t sum = A + value + SR.C;
+	SR.C = sum > 0xFF;
+	SR.V = ((~(A ^ value) & (A ^ sum)) & 0x80) != 0;
+	A = (uint8_t)sum;
+	SetZN(A);
+}
 
+template<typename Variant>
+void Mos6502Core<Variant>::AddDecimal(uint8_t value)
+{
+	// http://www.6502.org/tutorials/decimal_mode.html, appendix A
+	// N and V come from the sum before the high digit is adjusted, Z from the binary sum
+	uint32_t lo = (A & 0x0F) + (value & 0x0F) + SR.C;
+	if (lo >= 0x0A)
+		lo = ((lo + 0x06) & 0x0F) + 0x10;
+
+	uint32_t sum = (A & 0xF0) + (value & 0xF0) + lo;
+	SR.Z = ((A + value + SR.C) & 0xFF) == 0;
+	SR.N = (sum >> 7) & 1;
+	SR.V = ((~(A ^ value) & (A ^ sum)) & 0x80) != 0;
+
+	if (sum >= 0xA0)
+		sum += 0x60;
+	SR.C = sum > 0xFF;
+	A = (uint8_t)sum;
+}
 
-			// TSX  Transfer Stack Pointer to Index X
-			// 
-			//      SP -> X                          N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       TSX           BA    1     2
+template<typename Variant>
+void Mos6502Core<Variant>::SubtractDecimal(uint8_t value)
+{
+	// the flags are the same as a binary subtract, only A is decimal adjusted
+	uint8_t a = A;
+	int32_t borrow = 1 - SR.C;
+	AddBinary((uint8_t)~value);
+
+	int32_t lo = (a & 0x0F) - (value & 0x0F) - borrow;
+	if (lo < 0)
+		lo = ((lo - 0x06) & 0x0F) - 0x10;
+
+	int32_t difference = (a & 0xF0) - (value & 0xF0) + lo;
+	if (difference < 0)
+		difference -= 0x60;
+	A = (uint8_t)difference;
+}
 
+template<typename Variant>
+void Mos6502Core<Variant>::ARR(uint8_t value)
+{
+	// AND then ROR A, C and V come from bits 6 and 5 of the result. The NMOS decimal mode
+	// adjustment of ARR is not modelled
+	A = (uint8_t)(((A & value) >> 1) | (SR.C << 7));
+	SetZN(A);
+	SR.C = (A >> 6) & 1;
+	SR.V = ((A >> 6) ^ (A >> 5)) & 1;
+}
 
-		case 0xBA: std::cout << "TSX" << std::endl; ip += 1; break;
+template<typename Variant>
+void Mos6502Core<Variant>::StoreHighAnd(uint16_t base, uint8_t index, uint8_t value)
+{
+	uint16_t address = (uint16_t)(base + index);
+	value &= (uint8_t)((base >> 8) + 1);
+	if ((base ^ address) & 0xFF00)
+		address = (uint16_t)((address & 0x00FF) | (value << 8));
+	Write(address, value);
+}
 
+template<typename Variant>
+void Mos6502Core<Variant>::BIT(uint8_t value)
+{
+	SR.Z = (A & value) == 0;
+	SR.V = (value >> 6) & 1;
+	SR.N = value >> 7;
+}
 
-			// TXA  Transfer Index X to Accumulator
-			// 
-			//      X -> A                           N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       TXA           8A    1     2
+template<typename Variant>
+void Mos6502Core<Variant>::Compare(uint8_t reg, uint8_t value)
+{
+	SR.C = reg >= value;
+	SetZN((uint8_t)(reg - value));
+}
 
+template<typename Variant>
+void Mos6502Core<Variant>::Branch(bool condition)
+{
+	int8_t offset = (int8_t)Read(PC++);
+	if (!condition)
+		return;
+
+	// +1 cycle when taken, +1 more if the target is on another page
+	uint16_t target = (uint16_t)(PC + offset);
+	m_cycles += ((PC ^ target) & 0xFF00) ? 2 : 1;
+	PC = target;
+}
 
-		case 0x8A: std::cout << "TXA" << std::endl; ip += 1; break;
+template<typename Variant>
+uint8_t Mos6502Core<Variant>::ASL(uint8_t value)
+{
+	SR.C = value >> 7;
+	return Load((uint8_t)(value << 1));
+}
 
+template<typename Variant>
+uint8_t Mos6502Core<Variant>::LSR(uint8_t value)
+{
+	SR.C = value & 1;
+	return Load((uint8_t)(value >> 1));
+}
 
-			// TXS  Transfer Index X to Stack Register
-			// 
-			//      X -> SP                          N Z C I D V
-			//                                       + + - - - -
-			// 
-			//      addressing    assembler    opc  bytes  cyles
-			//      --------------------------------------------
-			//      implied       TXS           9A    1     2
+template<typename Variant>
+uint8_t Mos6502Core<Variant>::ROL(uint8_t value)
+{
+	uint8_t carry = SR.C;
+	SR.C = value >> 7;
+	return Load((uint8_t)((value << 1) | carry));
+}
 
+template<typename Variant>
+uint8_t Mos6502Core<Variant>::ROR(uint8_t value)
+{
+	uint8_t carry = SR.C;
+	SR.C = value & 1;
+	return Load((uint8_t)((value >> 1) | (carry << 7)));
+}
 
-		case 0x9A: std::cout << "TXS" << std::endl; ip += 1; break;
+template<typename Variant>
+void Mos6502Core<Variant>::Interrupt(uint16_t vector, bool isBreak)
+{
+	Push16(PC);
+	PushStatus(isBreak);
+	SR.I = 1;
+	PC = Read16(vector);
 
+	if (m_callObserver != nullptr)
+		m_callObserver->OnInterrupt(vector, PC, SP, isBreak);
 
-			// TYA  Transfer Index Y to Accumulator
-			//
-			//     Y -> A                           N Z C I D V
-			//                                      + + - - - -
-			//
-			//     addressing    assembler    opc  bytes  cyles
-			//     --------------------------------------------
-			//     implied       TYA           98    1     2
+	// BRK has its cycles counted from the opcode table
+	if (!isBreak)
+		m_cycles += 7;
+}
 
-		case 0x98: std::cout << "TYA" << std::endl; ip += 1; break;
 
 
-		default:
-			std::cout << "--- UNKNOWN -- " << std::endl; ip += 1;
-			break;
-		}
+template<typename Variant>
+void Mos6502Core<Variant>::HashState(NesStateHasher &hasher, bool includeRam)
+{
+	hasher.Add(((uint64_t)PC << 48) | ((uint64_t)SP << 40) | ((uint64_t)A << 32) | ((uint64_t)X << 24) | ((uint64_t)Y << 16) |
+		((uint64_t)SR.value << 8) | ((uint64_t)m_nmiPending << 1) | (uint64_t)m_irqLine);
+	hasher.Add(m_cycles);
 
+	if (includeRam)
+	{
+		hasher.Add(m_bus.GetWorkRam(), 2048);
+		hasher.Add(m_bus.GetCartridgeRam(), 8192);
 	}
-
-
-
 }
 
+template<typename Variant>
+void Mos6502Core<Variant>::PrintProgram(FILE *output)
+{
+	// the listing is built in a buffer and written out in large blocks,
+	// each bank is disassembled on its own thread at the cpu address it maps to
+	Mos6502Disassembler disassembler;
+	disassembler.SetOutput(output);
+	disassembler.DisassembleBanks(m_rom, m_numRomBanks);
+	disassembler.Flush();
+}
 
+template class Mos6502Core<Ricoh2A03>;
+template class Mos6502Core<Nmos6502>;
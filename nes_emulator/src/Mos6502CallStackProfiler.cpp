@@ -0,0 +1,137 @@
+#include "Mos6502CallStackProfiler.h"
+
+#include <string>
+
+// the stack only has 256 bytes, anything deeper is runaway recursion or stack switching
+static const size_t MaxStackDepth = 128;
+
+Mos6502CallStackProfiler::Mos6502CallStackProfiler()
+{
+	Reset(0, 0xFD);
+}
+
+Mos6502CallStackProfiler::~Mos6502CallStackProfiler()
+{
+
+}
+
+void Mos6502CallStackProfiler::Reset(uint16_t entryPoint, uint8_t sp)
+{
+	m_nodes.clear();
+	m_children.clear();
+	m_stack.clear();
+	m_totalSamples = 0;
+
+	m_rootSp = sp;
+	m_nodes.push_back({ 0, entryPoint, FRAME_RESET, 0 });
+	m_stack.push_back({ 0, 0 });
+}
+
+void Mos6502CallStackProfiler::OnCall(uint16_t target, uint8_t sp)
+{
+	PushFrame(target, FRAME_CALL, sp);
+}
+
+void Mos6502CallStackProfiler::OnInterrupt(uint16_t vector, uint16_t target, uint8_t sp, bool isBreak)
+{
+	uint8_t kind = FRAME_IRQ;
+	if (isBreak)
+		kind = FRAME_BRK;
+	else if (vector == 0xFFFA)
+		kind = FRAME_NMI;
+
+	PushFrame(target, kind, sp);
+}
+
+void Mos6502CallStackProfiler::OnReturn(uint8_t sp)
+{
+	PopFrames(sp);
+}
+
+void Mos6502CallStackProfiler::OnStackReset(uint8_t sp)
+{
+	// frames the new stack pointer is above are gone. With only the root left (the reset code
+	// setting up its stack) the root moves to the new stack pointer
+	PopFrames(sp);
+	if (m_stack.size() == 1)
+		m_rootSp = sp;
+}
+
+void Mos6502CallStackProfiler::PushFrame(uint16_t address, uint8_t kind, uint8_t sp)
+{
+	// drop anything the return address has been pushed over
+	PopFrames(sp);
+
+	if (m_stack.size() >= MaxStackDepth)
+		return;
+
+	uint32_t parent = m_stack.back().node;
+	uint64_t key = ((uint64_t)parent << 24) | ((uint64_t)kind << 16) | address;
+
+	auto it = m_children.find(key);
+	uint32_t node;
+	if (it != m_children.end())
+	{
+		node = it->second;
+	}
+	else
+	{
+		node = (uint32_t)m_nodes.size();
+		m_nodes.push_back({ parent, address, kind, 0 });
+		m_children.emplace(key, node);
+	}
+
+	m_stack.push_back({ node, GetStackDepth(sp) });
+}
+
+void Mos6502CallStackProfiler::PopFrames(uint8_t sp)
+{
+	// the root frame is never popped
+	uint8_t depth = GetStackDepth(sp);
+	while (m_stack.size() > 1 && m_stack.back().depth > depth)
+		m_stack.pop_back();
+}
+
+void Mos6502CallStackProfiler::FormatFrame(const Node &node, char *text, size_t size) const
+{
+	static const char *prefixes[] = { "RESET_", "", "NMI_", "IRQ_", "BRK_" };
+
+	const char *name = m_resolver != nullptr ? m_resolver(m_resolverContext, node.address) : nullptr;
+	if (name != nullptr)
+		snprintf(text, size, "%s%s", prefixes[node.kind], name);
+	else if (node.kind == FRAME_CALL)
+		snprintf(text, size, "L_%04X", node.address);
+	else
+		snprintf(text, size, "%s%04X", prefixes[node.kind], node.address);
+}
+
+bool Mos6502CallStackProfiler::WriteFolded(const char *filename) const
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+		return false;
+
+	WriteFolded(file);
+	return fclose(file) == 0;
+}
+
+void Mos6502CallStackProfiler::WriteFolded(FILE *output) const
+{
+	// names are formatted once, parents always come before their children
+	std::vector<std::string> paths(m_nodes.size());
+	char frame[256];
+
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		const Node &node = m_nodes[i];
+		FormatFrame(node, frame, sizeof(frame));
+
+		if (i == 0)
+			paths[i] = frame;
+		else
+			paths[i] = paths[node.parent] + ";" + frame;
+
+		if (node.samples > 0)
+			fprintf(output, "%s %llu\n", paths[i].c_str(), (unsigned long long)node.samples);
+	}
+}
@@ -0,0 +1,182 @@
+#include "Mos6502CodeAnalyzer.h"
+#include "Mos6502Disassembler.h"
+#include "Mos6502OpCodes.h"
+
+Mos6502CodeAnalyzer::Mos6502CodeAnalyzer()
+{
+
+}
+
+Mos6502CodeAnalyzer::~Mos6502CodeAnalyzer()
+{
+
+}
+
+void Mos6502CodeAnalyzer::Analyze(const RomBankMem *romBanks, uint8_t numRomBanks)
+{
+	m_prg = (const uint8_t *)romBanks;
+	m_numRomBanks = numRomBanks;
+	m_prgSize = sizeof(RomBankMem) * numRomBanks;
+	m_numCodeBytes = 0;
+
+	m_codeBits.assign((m_prgSize + 7) / 8, 0);
+	m_instructionBits.assign((m_prgSize + 7) / 8, 0);
+	m_labelBits.assign(0x10000 / 8, 0);
+	m_worklist.clear();
+
+	if (numRomBanks == 0)
+		return;
+
+	// vectors are the last 6 bytes of the last bank: NMI, RESET, IRQ/BRK
+	const uint8_t *vectors = m_prg + m_prgSize - 6;
+	m_nmiVector = (uint16_t)(vectors[0] | (vectors[1] << 8));
+	m_resetVector = (uint16_t)(vectors[2] | (vectors[3] << 8));
+	m_irqVector = (uint16_t)(vectors[4] | (vectors[5] << 8));
+
+	AddEntryPoint(m_resetVector);
+	AddEntryPoint(m_nmiVector);
+	AddEntryPoint(m_irqVector);
+
+	while (!m_worklist.empty())
+	{
+		uint16_t address = m_worklist.back();
+		m_worklist.pop_back();
+		TraceFrom(address);
+	}
+}
+
+void Mos6502CodeAnalyzer::AddEntryPoint(uint16_t cpuAddress)
+{
+	SetBit(m_labelBits, cpuAddress);
+
+	int32_t offset = CpuToPrgOffset(cpuAddress);
+	if (offset < 0)
+		return;
+
+	// also label the address the listing shows, they differ when a single bank is mirrored
+	SetBit(m_labelBits, PrgOffsetToCpu((uint32_t)offset));
+
+	if (!IsInstructionStart((uint32_t)offset))
+		m_worklist.push_back(cpuAddress);
+}
+
+void Mos6502CodeAnalyzer::TraceFrom(uint16_t cpuAddress)
+{
+	// decode straight line code until the flow leaves or joins code that has already been traced
+	for (;;)
+	{
+		int32_t offset = CpuToPrgOffset(cpuAddress);
+		if (offset < 0 || IsInstructionStart((uint32_t)offset))
+			return;
+
+		const Mos6502OpCode &op = Mos6502OpCodeTable[m_prg[offset]];
+		if (op.mnemonic == nullptr)
+			return;
+
+		// instructions may not run off the end of a bank, or overlap an instruction found on another path
+		uint32_t bankEnd = ((uint32_t)offset / sizeof(RomBankMem) + 1) * sizeof(RomBankMem);
+		if ((uint32_t)offset + op.bytes > bankEnd)
+			return;
+
+		for (uint32_t i = 0; i < op.bytes; i++)
+		{
+			if (IsCode(offset + i))
+				return;
+		}
+
+		for (uint32_t i = 0; i < op.bytes; i++)
+			SetBit(m_codeBits, offset + i);
+		SetBit(m_instructionBits, offset);
+		m_numCodeBytes += op.bytes;
+
+		// only the bytes of the instruction are read, a 1 byte opcode can be the last byte of the prg
+		uint16_t operand = 0;
+		if (op.bytes == 3)
+			operand = (uint16_t)(m_prg[offset + 1] | (m_prg[offset + 2] << 8));
+		else if (op.bytes == 2)
+			operand = m_prg[offset + 1];
+
+		if (op.flags & OPCODE_BRANCH)
+			AddEntryPoint((uint16_t)(cpuAddress + 2 + (int8_t)operand));
+
+		else if (op.flags & OPCODE_CALL)
+			AddEntryPoint(operand);
+
+		else if (op.flags & OPCODE_JUMP)
+		{
+			// JMP ($xxxx) targets are only known at runtime
+			if (op.mode == ADDR_ABSOLUTE)
+				AddEntryPoint(operand);
+			return;
+		}
+
+		else if (op.flags & (OPCODE_RETURN | OPCODE_BREAK | OPCODE_HALT))
+			return;
+
+		cpuAddress = (uint16_t)(cpuAddress + op.bytes);
+	}
+}
+
+int32_t Mos6502CodeAnalyzer::CpuToPrgOffset(uint16_t cpuAddress) const
+{
+	if (cpuAddress < 0x8000 || m_numRomBanks == 0)
+		return -1;
+
+	uint32_t offsetInBank = cpuAddress & 0x3FFF;
+
+	if (cpuAddress >= 0xC000 || m_numRomBanks == 1)
+		return (int32_t)((m_numRomBanks - 1) * sizeof(RomBankMem) + offsetInBank);
+
+	return (int32_t)offsetInBank;
+}
+
+uint16_t Mos6502CodeAnalyzer::PrgOffsetToCpu(uint32_t prgOffset) const
+{
+	uint32_t bank = prgOffset / sizeof(RomBankMem);
+	uint16_t offsetInBank = (uint16_t)(prgOffset % sizeof(RomBankMem));
+
+	return RomBankCpuAddress(bank, m_numRomBanks) | offsetInBank;
+}
+
+void Mos6502CodeAnalyzer::WriteListing(Mos6502Disassembler &disassembler) const
+{
+	char text[64];
+
+	snprintf(text, sizeof(text), "; NMI   $%04X\n; RESET $%04X\n; IRQ   $%04X\n", m_nmiVector, m_resetVector, m_irqVector);
+	disassembler.AppendText(text);
+
+	disassembler.SetLabels(&m_labelBits);
+
+	uint32_t offset = 0;
+	while (offset < m_prgSize)
+	{
+		if (offset % sizeof(RomBankMem) == 0)
+		{
+			uint32_t bank = offset / sizeof(RomBankMem);
+			snprintf(text, sizeof(text), "\n; bank %u - $%04X\n", (unsigned int)bank, RomBankCpuAddress(bank, m_numRomBanks));
+			disassembler.AppendText(text);
+		}
+
+		uint16_t cpuAddress = PrgOffsetToCpu(offset);
+
+		if (IsInstructionStart(offset))
+		{
+			if (HasLabel(cpuAddress))
+				disassembler.FormatLabel(cpuAddress);
+
+			offset += disassembler.FormatInstruction(m_prg + offset, m_prgSize - offset, cpuAddress);
+			continue;
+		}
+
+		// group data bytes up to the next instruction or bank boundary
+		uint32_t end = offset + 1;
+		uint32_t bankEnd = (offset / sizeof(RomBankMem) + 1) * sizeof(RomBankMem);
+		while (end < bankEnd && !IsInstructionStart(end))
+			end++;
+
+		disassembler.FormatData(m_prg + offset, end - offset, cpuAddress);
+		offset = end;
+	}
+
+	disassembler.SetLabels(nullptr);
+}
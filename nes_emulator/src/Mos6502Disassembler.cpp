@@ -0,0 +1,241 @@
+#include "Mos6502Disassembler.h"
+#include "Mos6502OpCodes.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+static const char s_hexDigits[] = "0123456789ABCDEF";
+
+// longest line is "C000  4C F5 C5  JMP ($C5F5),Y\n", leave room to spare
+static const size_t MaxLineLength = 64;
+
+Mos6502Disassembler::Mos6502Disassembler(size_t bufferSize)
+{
+	m_buffer.resize(bufferSize < MaxLineLength ? MaxLineLength : bufferSize);
+}
+
+Mos6502Disassembler::~Mos6502Disassembler()
+{
+	Flush();
+}
+
+void Mos6502Disassembler::Disassemble(const uint8_t *data, uint32_t length, uint16_t cpuAddress)
+{
+	uint32_t offset = 0;
+	while (offset < length)
+		offset += FormatInstruction(data + offset, length - offset, (uint16_t)(cpuAddress + offset));
+}
+
+void Mos6502Disassembler::DisassembleBanks(const RomBankMem *romBanks, uint32_t numRomBanks, unsigned int numThreads)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	numThreads = std::min<unsigned int>(numThreads, std::max(1u, numRomBanks));
+
+	// each worker reuses one disassembler and copies out the text of every bank it takes
+	std::vector<std::vector<char>> bankText(numRomBanks);
+	std::atomic<uint32_t> nextBank(0);
+
+	auto worker = [&]() {
+		Mos6502Disassembler disassembler(256 * 1024);
+		for (uint32_t bank = nextBank++; bank < numRomBanks; bank = nextBank++)
+		{
+			char header[32];
+			snprintf(header, sizeof(header), "\n; bank %u - $%04X\n", bank, RomBankCpuAddress(bank, numRomBanks));
+
+			disassembler.Clear();
+			disassembler.AppendText(header);
+			disassembler.Disassemble(romBanks[bank].data, sizeof(RomBankMem), RomBankCpuAddress(bank, numRomBanks));
+			bankText[bank].assign(disassembler.GetText(), disassembler.GetText() + disassembler.GetLength());
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < numThreads; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread &t : threads)
+		t.join();
+
+	for (const std::vector<char> &text : bankText)
+		AppendText(text.data(), text.size());
+}
+
+uint32_t Mos6502Disassembler::FormatInstruction(const uint8_t *data, uint32_t available, uint16_t cpuAddress, bool endLine)
+{
+	const Mos6502OpCode &op = Mos6502OpCodeTable[data[0]];
+
+	if (op.mnemonic == nullptr || op.bytes > available)
+	{
+		FormatData(data, 1, cpuAddress);
+		if (!endLine)
+			m_length--;
+		return 1;
+	}
+
+	Reserve(MaxLineLength);
+
+	// address and raw bytes, padded to three bytes wide
+	AppendHex16(cpuAddress);
+	AppendChar(' ');
+	for (int i = 0; i < 3; i++)
+	{
+		AppendChar(' ');
+		if (i < op.bytes)
+			AppendHex8(data[i]);
+		else
+		{
+			AppendChar(' ');
+			AppendChar(' ');
+		}
+	}
+	AppendChar(' ');
+	AppendChar((op.flags & OPCODE_UNOFFICIAL) ? '*' : ' ');
+
+	memcpy(&m_buffer[m_length], op.mnemonic, 3);
+	m_length += 3;
+
+	uint8_t lo = op.bytes > 1 ? data[1] : 0;
+	uint16_t word = op.bytes > 2 ? (uint16_t)(lo | (data[2] << 8)) : lo;
+
+	switch (op.mode)
+	{
+	case ADDR_IMPLIED:		break;
+	case ADDR_ACCUMULATOR:	AppendChar(' '); AppendChar('A'); break;
+	case ADDR_IMMEDIATE:	AppendChar(' '); AppendChar('#'); AppendChar('$'); AppendHex8(lo); break;
+	case ADDR_ZEROPAGE:		AppendChar(' '); AppendChar('$'); AppendHex8(lo); break;
+	case ADDR_ZEROPAGE_X:	AppendChar(' '); AppendChar('$'); AppendHex8(lo); AppendChar(','); AppendChar('X'); break;
+	case ADDR_ZEROPAGE_Y:	AppendChar(' '); AppendChar('$'); AppendHex8(lo); AppendChar(','); AppendChar('Y'); break;
+	case ADDR_ABSOLUTE:
+		AppendChar(' ');
+		if (op.flags & (OPCODE_JUMP | OPCODE_CALL))
+			AppendTarget(word);
+		else
+		{
+			AppendChar('$');
+			AppendHex16(word);
+		}
+		break;
+
+	case ADDR_ABSOLUTE_X:	AppendChar(' '); AppendChar('$'); AppendHex16(word); AppendChar(','); AppendChar('X'); break;
+	case ADDR_ABSOLUTE_Y:	AppendChar(' '); AppendChar('$'); AppendHex16(word); AppendChar(','); AppendChar('Y'); break;
+	case ADDR_INDIRECT:		AppendChar(' '); AppendChar('('); AppendChar('$'); AppendHex16(word); AppendChar(')'); break;
+	case ADDR_INDIRECT_X:	AppendChar(' '); AppendChar('('); AppendChar('$'); AppendHex8(lo); AppendChar(','); AppendChar('X'); AppendChar(')'); break;
+	case ADDR_INDIRECT_Y:	AppendChar(' '); AppendChar('('); AppendChar('$'); AppendHex8(lo); AppendChar(')'); AppendChar(','); AppendChar('Y'); break;
+
+	// branches show the target address rather than the signed offset
+	case ADDR_RELATIVE:
+		AppendChar(' ');
+		AppendTarget((uint16_t)(cpuAddress + 2 + (int8_t)lo));
+		break;
+	}
+
+	if (endLine)
+		AppendChar('\n');
+	return op.bytes;
+}
+
+void Mos6502Disassembler::AppendText(const char *text)
+{
+	AppendText(text, strlen(text));
+}
+
+void Mos6502Disassembler::AppendText(const char *text, size_t length)
+{
+	// large blocks bypass the buffer once it has been written out
+	if (m_output != nullptr && length > m_buffer.size())
+	{
+		Flush();
+		fwrite(text, 1, length, m_output);
+		return;
+	}
+
+	Reserve(length);
+	memcpy(&m_buffer[m_length], text, length);
+	m_length += length;
+}
+
+void Mos6502Disassembler::FormatData(const uint8_t *data, uint32_t count, uint16_t cpuAddress)
+{
+	// "C000            .db $FF,$00"
+	for (uint32_t i = 0; i < count; i += 8)
+	{
+		Reserve(MaxLineLength);
+
+		AppendHex16((uint16_t)(cpuAddress + i));
+		for (int pad = 0; pad < 12; pad++)
+			AppendChar(' ');
+
+		memcpy(&m_buffer[m_length], ".db ", 4);
+		m_length += 4;
+
+		uint32_t lineCount = count - i < 8 ? count - i : 8;
+		for (uint32_t j = 0; j < lineCount; j++)
+		{
+			if (j > 0)
+				AppendChar(',');
+			AppendChar('$');
+			AppendHex8(data[i + j]);
+		}
+		AppendChar('\n');
+	}
+}
+
+void Mos6502Disassembler::FormatLabel(uint16_t cpuAddress)
+{
+	Reserve(MaxLineLength);
+	AppendChar('L');
+	AppendChar('_');
+	AppendHex16(cpuAddress);
+	AppendChar(':');
+	AppendChar('\n');
+}
+
+void Mos6502Disassembler::AppendTarget(uint16_t address)
+{
+	bool hasLabel = m_labelBits != nullptr && (((*m_labelBits)[address >> 3] >> (address & 7)) & 1);
+	AppendChar(hasLabel ? 'L' : '$');
+	if (hasLabel)
+		AppendChar('_');
+	AppendHex16(address);
+}
+
+void Mos6502Disassembler::Flush()
+{
+	if (m_output != nullptr && m_length > 0)
+	{
+		fwrite(m_buffer.data(), 1, m_length, m_output);
+		fflush(m_output);
+		m_length = 0;
+	}
+}
+
+void Mos6502Disassembler::Reserve(size_t bytes)
+{
+	if (m_length + bytes <= m_buffer.size())
+		return;
+
+	// write the full buffer out in one go, or grow when collecting text in memory
+	if (m_output != nullptr)
+	{
+		fwrite(m_buffer.data(), 1, m_length, m_output);
+		m_length = 0;
+	}
+
+	if (m_length + bytes > m_buffer.size())
+		m_buffer.resize((m_length + bytes) * 2);
+}
+
+void Mos6502Disassembler::AppendHex8(uint8_t value)
+{
+	m_buffer[m_length++] = s_hexDigits[value >> 4];
+	m_buffer[m_length++] = s_hexDigits[value & 0x0F];
+}
+
+void Mos6502Disassembler::AppendHex16(uint16_t value)
+{
+	AppendHex8((uint8_t)(value >> 8));
+	AppendHex8((uint8_t)value);
+}
@@ -0,0 +1,267 @@
+#include "Mos6502OpCodes.h"
+
+// Instruction Set References:
+// http://www.obelisk.me.uk/6502/reference.html
+// http://e-tradition.net/bytes/6502/6502_instruction_set.html
+// https://wiki.nesdev.com/w/index.php/CPU_unofficial_opcodes (unofficial opcodes, named as in
+// "No More Secrets")
+
+const Mos6502OpCode Mos6502OpCodeTable[256] =
+{
+	/* 00 */ { "BRK", ADDR_IMPLIED,      1, 7, OPCODE_BREAK },
+	/* 01 */ { "ORA", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* 02 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 03 */ { "SLO", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 04 */ { "NOP", ADDR_ZEROPAGE,     2, 3, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 05 */ { "ORA", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* 06 */ { "ASL", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* 07 */ { "SLO", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 08 */ { "PHP", ADDR_IMPLIED,      1, 3, 0 },
+	/* 09 */ { "ORA", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* 0A */ { "ASL", ADDR_ACCUMULATOR,  1, 2, 0 },
+	/* 0B */ { "ANC", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 0C */ { "NOP", ADDR_ABSOLUTE,     3, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 0D */ { "ORA", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* 0E */ { "ASL", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 0F */ { "SLO", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 10 */ { "BPL", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* 11 */ { "ORA", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 12 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 13 */ { "SLO", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 14 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 15 */ { "ORA", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* 16 */ { "ASL", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 17 */ { "SLO", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 18 */ { "CLC", ADDR_IMPLIED,      1, 2, 0 },
+	/* 19 */ { "ORA", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 1A */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* 1B */ { "SLO", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 1C */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* 1D */ { "ORA", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 1E */ { "ASL", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* 1F */ { "SLO", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 20 */ { "JSR", ADDR_ABSOLUTE,     3, 6, OPCODE_CALL },
+	/* 21 */ { "AND", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* 22 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 23 */ { "RLA", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 24 */ { "BIT", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* 25 */ { "AND", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* 26 */ { "ROL", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* 27 */ { "RLA", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 28 */ { "PLP", ADDR_IMPLIED,      1, 4, 0 },
+	/* 29 */ { "AND", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* 2A */ { "ROL", ADDR_ACCUMULATOR,  1, 2, 0 },
+	/* 2B */ { "ANC", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 2C */ { "BIT", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* 2D */ { "AND", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* 2E */ { "ROL", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 2F */ { "RLA", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 30 */ { "BMI", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* 31 */ { "AND", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 32 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 33 */ { "RLA", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 34 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 35 */ { "AND", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* 36 */ { "ROL", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 37 */ { "RLA", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 38 */ { "SEC", ADDR_IMPLIED,      1, 2, 0 },
+	/* 39 */ { "AND", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 3A */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* 3B */ { "RLA", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 3C */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* 3D */ { "AND", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 3E */ { "ROL", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* 3F */ { "RLA", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 40 */ { "RTI", ADDR_IMPLIED,      1, 6, OPCODE_RETURN },
+	/* 41 */ { "EOR", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* 42 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 43 */ { "SRE", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 44 */ { "NOP", ADDR_ZEROPAGE,     2, 3, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 45 */ { "EOR", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* 46 */ { "LSR", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* 47 */ { "SRE", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 48 */ { "PHA", ADDR_IMPLIED,      1, 3, 0 },
+	/* 49 */ { "EOR", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* 4A */ { "LSR", ADDR_ACCUMULATOR,  1, 2, 0 },
+	/* 4B */ { "ALR", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 4C */ { "JMP", ADDR_ABSOLUTE,     3, 3, OPCODE_JUMP },
+	/* 4D */ { "EOR", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* 4E */ { "LSR", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 4F */ { "SRE", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 50 */ { "BVC", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* 51 */ { "EOR", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 52 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 53 */ { "SRE", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 54 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 55 */ { "EOR", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* 56 */ { "LSR", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 57 */ { "SRE", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 58 */ { "CLI", ADDR_IMPLIED,      1, 2, 0 },
+	/* 59 */ { "EOR", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 5A */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* 5B */ { "SRE", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 5C */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* 5D */ { "EOR", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 5E */ { "LSR", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* 5F */ { "SRE", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 60 */ { "RTS", ADDR_IMPLIED,      1, 6, OPCODE_RETURN },
+	/* 61 */ { "ADC", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* 62 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 63 */ { "RRA", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 64 */ { "NOP", ADDR_ZEROPAGE,     2, 3, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 65 */ { "ADC", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* 66 */ { "ROR", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* 67 */ { "RRA", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 68 */ { "PLA", ADDR_IMPLIED,      1, 4, 0 },
+	/* 69 */ { "ADC", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* 6A */ { "ROR", ADDR_ACCUMULATOR,  1, 2, 0 },
+	/* 6B */ { "ARR", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 6C */ { "JMP", ADDR_INDIRECT,     3, 5, OPCODE_JUMP },
+	/* 6D */ { "ADC", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* 6E */ { "ROR", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 6F */ { "RRA", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 70 */ { "BVS", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* 71 */ { "ADC", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 72 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 73 */ { "RRA", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 74 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 75 */ { "ADC", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* 76 */ { "ROR", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* 77 */ { "RRA", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 78 */ { "SEI", ADDR_IMPLIED,      1, 2, 0 },
+	/* 79 */ { "ADC", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 7A */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* 7B */ { "RRA", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 7C */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* 7D */ { "ADC", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* 7E */ { "ROR", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* 7F */ { "RRA", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 80 */ { "NOP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 81 */ { "STA", ADDR_INDIRECT_X,   2, 6, OPCODE_WRITE },
+	/* 82 */ { "NOP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 83 */ { "SAX", ADDR_INDIRECT_X,   2, 6, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 84 */ { "STY", ADDR_ZEROPAGE,     2, 3, OPCODE_WRITE },
+	/* 85 */ { "STA", ADDR_ZEROPAGE,     2, 3, OPCODE_WRITE },
+	/* 86 */ { "STX", ADDR_ZEROPAGE,     2, 3, OPCODE_WRITE },
+	/* 87 */ { "SAX", ADDR_ZEROPAGE,     2, 3, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 88 */ { "DEY", ADDR_IMPLIED,      1, 2, 0 },
+	/* 89 */ { "NOP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 8A */ { "TXA", ADDR_IMPLIED,      1, 2, 0 },
+	/* 8B */ { "ANE", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* 8C */ { "STY", ADDR_ABSOLUTE,     3, 4, OPCODE_WRITE },
+	/* 8D */ { "STA", ADDR_ABSOLUTE,     3, 4, OPCODE_WRITE },
+	/* 8E */ { "STX", ADDR_ABSOLUTE,     3, 4, OPCODE_WRITE },
+	/* 8F */ { "SAX", ADDR_ABSOLUTE,     3, 4, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 90 */ { "BCC", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* 91 */ { "STA", ADDR_INDIRECT_Y,   2, 6, OPCODE_WRITE },
+	/* 92 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* 93 */ { "SHA", ADDR_INDIRECT_Y,   2, 6, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 94 */ { "STY", ADDR_ZEROPAGE_X,   2, 4, OPCODE_WRITE },
+	/* 95 */ { "STA", ADDR_ZEROPAGE_X,   2, 4, OPCODE_WRITE },
+	/* 96 */ { "STX", ADDR_ZEROPAGE_Y,   2, 4, OPCODE_WRITE },
+	/* 97 */ { "SAX", ADDR_ZEROPAGE_Y,   2, 4, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 98 */ { "TYA", ADDR_IMPLIED,      1, 2, 0 },
+	/* 99 */ { "STA", ADDR_ABSOLUTE_Y,   3, 5, OPCODE_WRITE },
+	/* 9A */ { "TXS", ADDR_IMPLIED,      1, 2, 0 },
+	/* 9B */ { "TAS", ADDR_ABSOLUTE_Y,   3, 5, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 9C */ { "SHY", ADDR_ABSOLUTE_X,   3, 5, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 9D */ { "STA", ADDR_ABSOLUTE_X,   3, 5, OPCODE_WRITE },
+	/* 9E */ { "SHX", ADDR_ABSOLUTE_Y,   3, 5, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* 9F */ { "SHA", ADDR_ABSOLUTE_Y,   3, 5, OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* A0 */ { "LDY", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* A1 */ { "LDA", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* A2 */ { "LDX", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* A3 */ { "LAX", ADDR_INDIRECT_X,   2, 6, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* A4 */ { "LDY", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* A5 */ { "LDA", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* A6 */ { "LDX", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* A7 */ { "LAX", ADDR_ZEROPAGE,     2, 3, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* A8 */ { "TAY", ADDR_IMPLIED,      1, 2, 0 },
+	/* A9 */ { "LDA", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* AA */ { "TAX", ADDR_IMPLIED,      1, 2, 0 },
+	/* AB */ { "LXA", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* AC */ { "LDY", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* AD */ { "LDA", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* AE */ { "LDX", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* AF */ { "LAX", ADDR_ABSOLUTE,     3, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* B0 */ { "BCS", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* B1 */ { "LDA", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* B2 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* B3 */ { "LAX", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* B4 */ { "LDY", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* B5 */ { "LDA", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* B6 */ { "LDX", ADDR_ZEROPAGE_Y,   2, 4, OPCODE_READ },
+	/* B7 */ { "LAX", ADDR_ZEROPAGE_Y,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* B8 */ { "CLV", ADDR_IMPLIED,      1, 2, 0 },
+	/* B9 */ { "LDA", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* BA */ { "TSX", ADDR_IMPLIED,      1, 2, 0 },
+	/* BB */ { "LAS", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* BC */ { "LDY", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* BD */ { "LDA", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* BE */ { "LDX", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* BF */ { "LAX", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* C0 */ { "CPY", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* C1 */ { "CMP", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* C2 */ { "NOP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* C3 */ { "DCP", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* C4 */ { "CPY", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* C5 */ { "CMP", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* C6 */ { "DEC", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* C7 */ { "DCP", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* C8 */ { "INY", ADDR_IMPLIED,      1, 2, 0 },
+	/* C9 */ { "CMP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* CA */ { "DEX", ADDR_IMPLIED,      1, 2, 0 },
+	/* CB */ { "SBX", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* CC */ { "CPY", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* CD */ { "CMP", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* CE */ { "DEC", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* CF */ { "DCP", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* D0 */ { "BNE", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* D1 */ { "CMP", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* D2 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* D3 */ { "DCP", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* D4 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* D5 */ { "CMP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* D6 */ { "DEC", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* D7 */ { "DCP", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* D8 */ { "CLD", ADDR_IMPLIED,      1, 2, 0 },
+	/* D9 */ { "CMP", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* DA */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* DB */ { "DCP", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* DC */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* DD */ { "CMP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* DE */ { "DEC", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* DF */ { "DCP", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* E0 */ { "CPX", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* E1 */ { "SBC", ADDR_INDIRECT_X,   2, 6, OPCODE_READ },
+	/* E2 */ { "NOP", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* E3 */ { "ISC", ADDR_INDIRECT_X,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* E4 */ { "CPX", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* E5 */ { "SBC", ADDR_ZEROPAGE,     2, 3, OPCODE_READ },
+	/* E6 */ { "INC", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE },
+	/* E7 */ { "ISC", ADDR_ZEROPAGE,     2, 5, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* E8 */ { "INX", ADDR_IMPLIED,      1, 2, 0 },
+	/* E9 */ { "SBC", ADDR_IMMEDIATE,    2, 2, OPCODE_READ },
+	/* EA */ { "NOP", ADDR_IMPLIED,      1, 2, 0 },
+	/* EB */ { "SBC", ADDR_IMMEDIATE,    2, 2, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* EC */ { "CPX", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* ED */ { "SBC", ADDR_ABSOLUTE,     3, 4, OPCODE_READ },
+	/* EE */ { "INC", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE },
+	/* EF */ { "ISC", ADDR_ABSOLUTE,     3, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* F0 */ { "BEQ", ADDR_RELATIVE,     2, 2, OPCODE_BRANCH },
+	/* F1 */ { "SBC", ADDR_INDIRECT_Y,   2, 5, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* F2 */ { "JAM", ADDR_IMPLIED,      1, 2, OPCODE_HALT | OPCODE_UNOFFICIAL },
+	/* F3 */ { "ISC", ADDR_INDIRECT_Y,   2, 8, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* F4 */ { "NOP", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ | OPCODE_UNOFFICIAL },
+	/* F5 */ { "SBC", ADDR_ZEROPAGE_X,   2, 4, OPCODE_READ },
+	/* F6 */ { "INC", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE },
+	/* F7 */ { "ISC", ADDR_ZEROPAGE_X,   2, 6, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* F8 */ { "SED", ADDR_IMPLIED,      1, 2, 0 },
+	/* F9 */ { "SBC", ADDR_ABSOLUTE_Y,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* FA */ { "NOP", ADDR_IMPLIED,      1, 2, OPCODE_UNOFFICIAL },
+	/* FB */ { "ISC", ADDR_ABSOLUTE_Y,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+	/* FC */ { "NOP", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY | OPCODE_UNOFFICIAL },
+	/* FD */ { "SBC", ADDR_ABSOLUTE_X,   3, 4, OPCODE_READ | OPCODE_PAGE_PENALTY },
+	/* FE */ { "INC", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE },
+	/* FF */ { "ISC", ADDR_ABSOLUTE_X,   3, 7, OPCODE_READ | OPCODE_WRITE | OPCODE_UNOFFICIAL },
+};
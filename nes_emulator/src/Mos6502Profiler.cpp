@@ -0,0 +1,150 @@
+#include "Mos6502Profiler.h"
+#include "Mos6502OpCodes.h"
+
+#include <string.h>
+#include <algorithm>
+
+static const char *s_addressingModeNames[] =
+{
+	"implied", "accumulator", "immediate", "zeropage", "zeropage,X", "zeropage,Y", "relative",
+	"absolute", "absolute,X", "absolute,Y", "indirect", "(indirect,X)", "(indirect),Y",
+};
+
+static const char *MnemonicOf(uint8_t opCode)
+{
+	const char *mnemonic = Mos6502OpCodeTable[opCode].mnemonic;
+	return mnemonic != nullptr ? mnemonic : "???";
+}
+
+Mos6502Profiler::Mos6502Profiler()
+{
+	Reset();
+}
+
+Mos6502Profiler::~Mos6502Profiler()
+{
+
+}
+
+void Mos6502Profiler::Reset()
+{
+	memset(m_opCount, 0, sizeof(m_opCount));
+	memset(m_opCycles, 0, sizeof(m_opCycles));
+	m_pcCount.assign(0x10000, 0);
+	m_pcCycles.assign(0x10000, 0);
+}
+
+uint64_t Mos6502Profiler::GetTotalInstructions() const
+{
+	uint64_t total = 0;
+	for (int i = 0; i < 256; i++)
+		total += m_opCount[i];
+	return total;
+}
+
+uint64_t Mos6502Profiler::GetTotalCycles() const
+{
+	uint64_t total = 0;
+	for (int i = 0; i < 256; i++)
+		total += m_opCycles[i];
+	return total;
+}
+
+void Mos6502Profiler::WriteReport(FILE *output, uint32_t numAddresses) const
+{
+	uint64_t totalInstructions = GetTotalInstructions();
+	uint64_t totalCycles = GetTotalCycles();
+	double percentScale = totalCycles > 0 ? 100.0 / totalCycles : 0.0;
+
+	fprintf(output, "%llu instructions, %llu cycles\n\n", (unsigned long long)totalInstructions, (unsigned long long)totalCycles);
+
+	// opcodes
+	std::vector<int> opCodes;
+	for (int i = 0; i < 256; i++)
+	{
+		if (m_opCount[i] > 0)
+			opCodes.push_back(i);
+	}
+	std::sort(opCodes.begin(), opCodes.end(), [this](int a, int b) { return m_opCycles[a] > m_opCycles[b]; });
+
+	fprintf(output, "op  mnemonic  mode            count           cycles          %%cycles\n");
+	for (int op : opCodes)
+	{
+		fprintf(output, "%02X  %-8s  %-14s  %-14llu  %-14llu  %6.2f\n", op, MnemonicOf((uint8_t)op),
+			s_addressingModeNames[Mos6502OpCodeTable[op].mode],
+			(unsigned long long)m_opCount[op], (unsigned long long)m_opCycles[op], m_opCycles[op] * percentScale);
+	}
+
+	// addressing modes
+	uint64_t modeCount[13] = {};
+	uint64_t modeCycles[13] = {};
+	for (int op : opCodes)
+	{
+		modeCount[Mos6502OpCodeTable[op].mode] += m_opCount[op];
+		modeCycles[Mos6502OpCodeTable[op].mode] += m_opCycles[op];
+	}
+
+	std::vector<int> modes;
+	for (int i = 0; i < 13; i++)
+	{
+		if (modeCount[i] > 0)
+			modes.push_back(i);
+	}
+	std::sort(modes.begin(), modes.end(), [&](int a, int b) { return modeCycles[a] > modeCycles[b]; });
+
+	fprintf(output, "\nmode            count           cycles          %%cycles\n");
+	for (int mode : modes)
+	{
+		fprintf(output, "%-14s  %-14llu  %-14llu  %6.2f\n", s_addressingModeNames[mode],
+			(unsigned long long)modeCount[mode], (unsigned long long)modeCycles[mode], modeCycles[mode] * percentScale);
+	}
+
+	// hottest addresses
+	std::vector<uint32_t> addresses;
+	for (uint32_t pc = 0; pc < 0x10000; pc++)
+	{
+		if (m_pcCount[pc] > 0)
+			addresses.push_back(pc);
+	}
+
+	numAddresses = std::min<uint32_t>(numAddresses, (uint32_t)addresses.size());
+	std::partial_sort(addresses.begin(), addresses.begin() + numAddresses, addresses.end(),
+		[this](uint32_t a, uint32_t b) { return m_pcCycles[a] > m_pcCycles[b]; });
+
+	fprintf(output, "\npc    count           cycles          %%cycles\n");
+	for (uint32_t i = 0; i < numAddresses; i++)
+	{
+		uint32_t pc = addresses[i];
+		fprintf(output, "%04X  %-14llu  %-14llu  %6.2f\n", pc,
+			(unsigned long long)m_pcCount[pc], (unsigned long long)m_pcCycles[pc], m_pcCycles[pc] * percentScale);
+	}
+}
+
+bool Mos6502Profiler::WriteCsv(const char *filename) const
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "type,key,mnemonic,mode,count,cycles\n");
+
+	for (int op = 0; op < 256; op++)
+	{
+		if (m_opCount[op] == 0)
+			continue;
+
+		fprintf(file, "opcode,%02X,%s,\"%s\",%llu,%llu\n", op, MnemonicOf((uint8_t)op),
+			s_addressingModeNames[Mos6502OpCodeTable[op].mode],
+			(unsigned long long)m_opCount[op], (unsigned long long)m_opCycles[op]);
+	}
+
+	for (uint32_t pc = 0; pc < 0x10000; pc++)
+	{
+		if (m_pcCount[pc] == 0)
+			continue;
+
+		fprintf(file, "pc,%04X,,,%llu,%llu\n", pc, (unsigned long long)m_pcCount[pc], (unsigned long long)m_pcCycles[pc]);
+	}
+
+	return fclose(file) == 0;
+}
@@ -0,0 +1,304 @@
+#include "Mos6502TestRunner.h"
+#include "Mos6502Tracer.h"
+#include "Mos6502Disassembler.h"
+#include "NesConsole.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+template<typename Variant>
+static void CaptureCpuEntry(Mos6502Core<Variant> &cpu, Mos6502TraceEntry &entry)
+{
+	// flat binaries have no ppu, the position is left at 0
+	const NesCpuBus &bus = cpu.GetBus();
+	uint16_t pc = cpu.GetPC();
+
+	memset(&entry, 0, sizeof(entry));
+	entry.cycles = cpu.GetCycles();
+	entry.pc = pc;
+	entry.bytes[0] = bus.Peek(pc);
+	entry.bytes[1] = bus.Peek((uint16_t)(pc + 1));
+	entry.bytes[2] = bus.Peek((uint16_t)(pc + 2));
+	entry.a = cpu.GetA();
+	entry.x = cpu.GetX();
+	entry.y = cpu.GetY();
+	entry.p = cpu.GetStatus();
+	entry.sp = cpu.GetSP();
+}
+
+Mos6502TestRunner::Mos6502TestRunner()
+{
+
+}
+
+Mos6502TestRunner::~Mos6502TestRunner()
+{
+
+}
+
+bool Mos6502TestRunner::LoadGoldenLog(const char *filename)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
+
+	m_golden.clear();
+
+	char text[256];
+	uint32_t lineNumber = 0;
+	while (fgets(text, sizeof(text), file) != nullptr)
+	{
+		lineNumber++;
+
+		size_t length = strcspn(text, "\r\n");
+		text[length] = '\0';
+		if (length == 0)
+			continue;
+
+		GoldenLine line;
+		if (!ParseGoldenLine(text, line))
+		{
+			printf("%s(%u): not a nestest.log line\n", filename, lineNumber);
+			fclose(file);
+			return false;
+		}
+		m_golden.push_back(line);
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool Mos6502TestRunner::ParseGoldenLine(const char *text, GoldenLine &line)
+{
+	// C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+	char *end;
+	line.pc = (uint16_t)strtoul(text, &end, 16);
+	if (end != text + 4)
+		return false;
+
+	const char *registers = strstr(text, "A:");
+	if (registers == nullptr)
+		return false;
+
+	unsigned int a, x, y, p, sp;
+	if (sscanf(registers, "A:%2x X:%2x Y:%2x P:%2x SP:%2x", &a, &x, &y, &p, &sp) != 5)
+		return false;
+
+	line.a = (uint8_t)a;
+	line.x = (uint8_t)x;
+	line.y = (uint8_t)y;
+	line.p = (uint8_t)p;
+	line.sp = (uint8_t)sp;
+
+	// older logs have no cycle count
+	const char *cycles = strstr(registers, "CYC:");
+	line.hasCycles = cycles != nullptr;
+	line.cycles = cycles != nullptr ? strtoull(cycles + 4, nullptr, 10) : 0;
+
+	line.text = text;
+	return true;
+}
+
+bool Mos6502TestRunner::CheckGolden(size_t index, const Mos6502TraceEntry &entry, Mos6502TestResult &result)
+{
+	const GoldenLine &golden = m_golden[index];
+	if (golden.pc == entry.pc && golden.a == entry.a && golden.x == entry.x && golden.y == entry.y &&
+		golden.p == entry.p && golden.sp == entry.sp && (!golden.hasCycles || golden.cycles == entry.cycles))
+	{
+		return true;
+	}
+
+	Mos6502Disassembler line(256);
+	Mos6502TraceReader::FormatNestestLine(entry, line);
+
+	char message[512];
+	snprintf(message, sizeof(message), "differs from the golden log at line %u\n  expected: %s\n  actual:   %.*s",
+		(unsigned int)(index + 1), golden.text.c_str(), (int)line.GetLength() - 1, line.GetText());
+	result.message = message;
+	return false;
+}
+
+bool Mos6502TestRunner::RunFlatBinary(const char *filename, const Mos6502TestOptions &options, Mos6502TestResult &result)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
+
+	std::vector<uint8_t> memory(0x10000, 0);
+	size_t size = fread(memory.data() + options.loadAddress, 1, 0x10000 - options.loadAddress, file);
+	fclose(file);
+
+	if (size == 0)
+	{
+		printf("%s is empty\n", filename);
+		return false;
+	}
+
+	if (options.decimalMode)
+		RunFlatMemory<Nmos6502>(memory, options, result);
+	else
+		RunFlatMemory<Ricoh2A03>(memory, options, result);
+	return true;
+}
+
+template<typename Variant>
+void Mos6502TestRunner::RunFlatMemory(std::vector<uint8_t> &memory, const Mos6502TestOptions &options, Mos6502TestResult &result)
+{
+	// the whole address space is ram
+	Mos6502Core<Variant> *cpu = new Mos6502Core<Variant>;
+	cpu->GetBus().MapMemory(0x00, 256, memory.data(), 0x10000, true);
+	cpu->Reset();
+
+	if (options.startPc >= 0)
+		cpu->SetPC((uint16_t)options.startPc);
+	else if (!m_golden.empty())
+		cpu->SetPC(m_golden[0].pc);
+
+	result = Mos6502TestResult();
+	bool checkGolden = !m_golden.empty();
+	uint64_t firstCycle = cpu->GetCycles();
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	uint64_t instructions = 0;
+	bool trapped = false;
+	for (; instructions < options.maxInstructions; instructions++)
+	{
+		if (checkGolden)
+		{
+			if (instructions == m_golden.size())
+				break;
+
+			Mos6502TraceEntry entry;
+			CaptureCpuEntry(*cpu, entry);
+			if (!CheckGolden((size_t)instructions, entry, result))
+				break;
+		}
+
+		uint16_t pc = cpu->GetPC();
+		cpu->Tick();
+
+		if (cpu->GetPC() == pc)
+		{
+			trapped = true;
+			instructions++;
+			break;
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	result.instructions = instructions;
+	result.cycles = cpu->GetCycles() - firstCycle;
+	result.stopPc = cpu->GetPC();
+
+	if (result.message.empty())
+	{
+		char message[128];
+		if (trapped)
+		{
+			result.passed = options.successPc < 0 || result.stopPc == options.successPc;
+			snprintf(message, sizeof(message), "trapped at $%04X", result.stopPc);
+		}
+		else if (checkGolden && instructions == m_golden.size())
+		{
+			result.passed = true;
+			snprintf(message, sizeof(message), "matched all %u golden log lines", (unsigned int)m_golden.size());
+		}
+		else
+			snprintf(message, sizeof(message), "no trap after %llu instructions", (unsigned long long)instructions);
+		result.message = message;
+	}
+
+	delete cpu;
+}
+
+bool Mos6502TestRunner::RunNesRom(NesCartridge &rom, const Mos6502TestOptions &options, Mos6502TestResult &result)
+{
+	NesConsole *console = new NesConsole;
+	console->LoadCartridge(rom);
+	console->Reset();
+
+	Mos6502CPU &cpu = console->GetCpu();
+
+	// nestest runs without a ppu from $C000, its log starts there
+	if (options.startPc >= 0)
+		cpu.SetPC((uint16_t)options.startPc);
+	else if (!m_golden.empty())
+		cpu.SetPC(m_golden[0].pc);
+
+	result = Mos6502TestResult();
+	bool checkGolden = !m_golden.empty();
+	uint64_t firstCycle = cpu.GetCycles();
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	uint64_t instructions = 0;
+	bool trapped = false;
+	while (instructions < options.maxInstructions)
+	{
+		// interrupt entry is not an instruction, nestest.log leaves it out
+		if (cpu.IsInterruptPending())
+		{
+			console->Step();
+			continue;
+		}
+
+		if (checkGolden)
+		{
+			if (instructions == m_golden.size())
+				break;
+
+			Mos6502TraceEntry entry;
+			console->CaptureTraceEntry(entry);
+			if (!CheckGolden((size_t)instructions, entry, result))
+				break;
+		}
+
+		uint16_t pc = cpu.GetPC();
+		console->Step();
+		instructions++;
+
+		if (cpu.GetPC() == pc && !cpu.IsInterruptPending())
+		{
+			trapped = true;
+			break;
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	result.instructions = instructions;
+	result.cycles = cpu.GetCycles() - firstCycle;
+	result.stopPc = cpu.GetPC();
+
+	if (result.message.empty())
+	{
+		char message[128];
+		if (checkGolden && instructions == m_golden.size())
+		{
+			result.passed = true;
+			snprintf(message, sizeof(message), "matched all %u golden log lines", (unsigned int)m_golden.size());
+		}
+		else
+		{
+			// nestest leaves the number of the first failed test in $02 (official) and $03 (unofficial opcodes)
+			uint8_t official = cpu.GetBus().Peek(0x0002);
+			uint8_t unofficial = cpu.GetBus().Peek(0x0003);
+			result.passed = official == 0 && unofficial == 0;
+			snprintf(message, sizeof(message), "%s at $%04X, result codes $02 = $%02X, $03 = $%02X",
+				trapped ? "trapped" : "stopped", result.stopPc, official, unofficial);
+		}
+		result.message = message;
+	}
+
+	delete console;
+	return true;
+}
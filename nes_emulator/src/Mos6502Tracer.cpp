@@ -0,0 +1,415 @@
+#include "Mos6502Tracer.h"
+#include "Mos6502Disassembler.h"
+#include "Mos6502OpCodes.h"
+#include "NesPpu.h"
+#include "NesRegion.h"
+
+#include <string.h>
+#include <chrono>
+
+// change mask bits
+enum TraceFieldBits : uint8_t
+{
+	TRACE_PC		= 1 << 0,	// not the previous pc + instruction length
+	TRACE_A			= 1 << 1,
+	TRACE_X			= 1 << 2,
+	TRACE_Y			= 1 << 3,
+	TRACE_P			= 1 << 4,
+	TRACE_SP		= 1 << 5,
+	TRACE_BYTES		= 1 << 6,	// differ from the last instruction seen at this pc
+	TRACE_PPU		= 1 << 7,	// ppu position not where the cycle delta puts it
+};
+
+// encoder and decoder share the prediction state, both are reset at the start of each chunk
+struct TraceCodec
+{
+	// mask, 10 byte varint, pc, 5 registers, 3 opcode bytes, ppu position
+	static const size_t MaxEncodedSize = 1 + 10 + 2 + 5 + 3 + 4;
+
+	Mos6502TraceEntry		previous;
+	std::vector<uint8_t>	bytesAtPc;
+
+	TraceCodec() : bytesAtPc(0x10000 * 3) { Reset(); }
+
+	void Reset()
+	{
+		memset(&previous, 0, sizeof(previous));
+		memset(bytesAtPc.data(), 0, bytesAtPc.size());
+	}
+
+	void Predict(Mos6502TraceEntry &predicted, uint64_t cycleDelta) const
+	{
+		predicted = previous;
+		predicted.pc = (uint16_t)(previous.pc + Mos6502OpCodeTable[previous.bytes[0]].bytes);
+		predicted.cycles = previous.cycles + cycleDelta;
+
+		// deltas are a few cycles, apart from DMA, so this avoids dividing for every entry.
+		// the ppu position is predicted with NTSC timing, other regions only cost a few bytes more
+		uint64_t dot = previous.dot + cycleDelta * 3;
+		uint64_t scanline = previous.scanline;
+		if (dot >= NesPpu::DotsPerScanline * 8)
+		{
+			scanline += dot / NesPpu::DotsPerScanline;
+			dot %= NesPpu::DotsPerScanline;
+		}
+		while (dot >= NesPpu::DotsPerScanline)
+		{
+			dot -= NesPpu::DotsPerScanline;
+			scanline++;
+		}
+		if (scanline >= NesRegionNtsc::ScanlinesPerFrame)
+			scanline %= NesRegionNtsc::ScanlinesPerFrame;
+
+		predicted.dot = (uint16_t)dot;
+		predicted.scanline = (uint16_t)scanline;
+	}
+
+	// writes at most MaxEncodedSize bytes to 'output' and returns the end of the encoded entry
+	uint8_t *Encode(const Mos6502TraceEntry &entry, uint8_t *output)
+	{
+		uint64_t cycleDelta = entry.cycles - previous.cycles;
+		Mos6502TraceEntry predicted;
+		Predict(predicted, cycleDelta);
+
+		uint8_t *cached = &bytesAtPc[entry.pc * 3];
+
+		uint8_t mask = 0;
+		if (entry.pc != predicted.pc)							mask |= TRACE_PC;
+		if (entry.a != previous.a)								mask |= TRACE_A;
+		if (entry.x != previous.x)								mask |= TRACE_X;
+		if (entry.y != previous.y)								mask |= TRACE_Y;
+		if (entry.p != previous.p)								mask |= TRACE_P;
+		if (entry.sp != previous.sp)							mask |= TRACE_SP;
+		if (memcmp(entry.bytes, cached, 3) != 0)				mask |= TRACE_BYTES;
+		if (entry.scanline != predicted.scanline || entry.dot != predicted.dot)
+			mask |= TRACE_PPU;
+
+		*output++ = mask;
+
+		// cycle delta as a little endian base 128 varint, almost always one byte
+		uint64_t delta = cycleDelta;
+		while (delta >= 0x80)
+		{
+			*output++ = (uint8_t)(delta | 0x80);
+			delta >>= 7;
+		}
+		*output++ = (uint8_t)delta;
+
+		if (mask & TRACE_PC)	{ output[0] = (uint8_t)entry.pc; output[1] = (uint8_t)(entry.pc >> 8); output += 2; }
+		if (mask & TRACE_A)		*output++ = entry.a;
+		if (mask & TRACE_X)		*output++ = entry.x;
+		if (mask & TRACE_Y)		*output++ = entry.y;
+		if (mask & TRACE_P)		*output++ = entry.p;
+		if (mask & TRACE_SP)	*output++ = entry.sp;
+		if (mask & TRACE_BYTES)	{ memcpy(output, entry.bytes, 3); memcpy(cached, entry.bytes, 3); output += 3; }
+		if (mask & TRACE_PPU)
+		{
+			output[0] = (uint8_t)entry.scanline;
+			output[1] = (uint8_t)(entry.scanline >> 8);
+			output[2] = (uint8_t)entry.dot;
+			output[3] = (uint8_t)(entry.dot >> 8);
+			output += 4;
+		}
+
+		previous = entry;
+		return output;
+	}
+
+	// returns false if the data runs out mid entry
+	bool Decode(const uint8_t *&data, const uint8_t *end, Mos6502TraceEntry &entry)
+	{
+		if (data >= end)
+			return false;
+		uint8_t mask = *data++;
+
+		uint64_t cycleDelta = 0;
+		for (int shift = 0; ; shift += 7)
+		{
+			if (data >= end || shift > 63)
+				return false;
+			uint8_t b = *data++;
+			cycleDelta |= (uint64_t)(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				break;
+		}
+
+		static const uint8_t fieldSizes[8] = { 2, 1, 1, 1, 1, 1, 3, 4 };
+		size_t size = 0;
+		for (int bit = 0; bit < 8; bit++)
+		{
+			if (mask & (1 << bit))
+				size += fieldSizes[bit];
+		}
+		if ((size_t)(end - data) < size)
+			return false;
+
+		Predict(entry, cycleDelta);
+
+		if (mask & TRACE_PC)	{ entry.pc = (uint16_t)(data[0] | (data[1] << 8)); data += 2; }
+		if (mask & TRACE_A)		entry.a = *data++;
+		if (mask & TRACE_X)		entry.x = *data++;
+		if (mask & TRACE_Y)		entry.y = *data++;
+		if (mask & TRACE_P)		entry.p = *data++;
+		if (mask & TRACE_SP)	entry.sp = *data++;
+
+		uint8_t *cached = &bytesAtPc[entry.pc * 3];
+		if (mask & TRACE_BYTES)	{ memcpy(cached, data, 3); data += 3; }
+		memcpy(entry.bytes, cached, 3);
+
+		if (mask & TRACE_PPU)
+		{
+			entry.scanline = (uint16_t)(data[0] | (data[1] << 8));
+			entry.dot = (uint16_t)(data[2] | (data[3] << 8));
+			data += 4;
+		}
+
+		previous = entry;
+		return true;
+	}
+};
+
+//=============================================================================
+// Writer
+//=============================================================================
+Mos6502TraceWriter::Mos6502TraceWriter() : m_stop(false)
+{
+
+}
+
+Mos6502TraceWriter::~Mos6502TraceWriter()
+{
+	Close();
+}
+
+bool Mos6502TraceWriter::Open(const char *filename, size_t ringEntries)
+{
+	Close();
+
+	m_file = fopen(filename, "wb");
+	if (m_file == nullptr)
+	{
+		printf("failed to open %s for writing\n", filename);
+		return false;
+	}
+
+	TraceFileHeader header;
+	memcpy(header.magic, "NTRC", 4);
+	header.version = TraceVersion;
+	header.entrySize = sizeof(Mos6502TraceEntry);
+	header.reserved = 0;
+	fwrite(&header, sizeof(header), 1, m_file);
+
+	m_ring.Resize(ringEntries);
+	m_entryCount = 0;
+	m_bytesWritten = sizeof(header);
+	m_writeFailed = false;
+	m_stop = false;
+	m_thread = std::thread(&Mos6502TraceWriter::WriterThread, this);
+	return true;
+}
+
+bool Mos6502TraceWriter::Close()
+{
+	if (m_file == nullptr)
+		return true;
+
+	m_stop = true;
+	m_thread.join();
+
+	bool ok = !m_writeFailed;
+	if (fclose(m_file) != 0)
+		ok = false;
+	m_file = nullptr;
+	return ok;
+}
+
+void Mos6502TraceWriter::RecordFull(const Mos6502TraceEntry &entry)
+{
+	while (!m_ring.TryPush(entry))
+		std::this_thread::yield();
+}
+
+void Mos6502TraceWriter::WriterThread()
+{
+	TraceCodec codec;
+	std::vector<Mos6502TraceEntry> chunk(ChunkEntries);
+	std::vector<uint8_t> compressed(ChunkEntries * TraceCodec::MaxEncodedSize);
+
+	size_t count = 0;
+	for (;;)
+	{
+		// stop is checked before popping so nothing recorded ahead of Close() is missed
+		bool stopping = m_stop;
+
+		size_t popped = m_ring.Pop(chunk.data() + count, ChunkEntries - count);
+		count += popped;
+
+		if (count < ChunkEntries && !(stopping && popped == 0))
+		{
+			if (popped == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			continue;
+		}
+
+		if (count > 0)
+		{
+			codec.Reset();
+			uint8_t *end = compressed.data();
+			for (size_t i = 0; i < count; i++)
+				end = codec.Encode(chunk[i], end);
+
+			TraceChunkHeader header;
+			header.numEntries = (uint32_t)count;
+			header.compressedSize = (uint32_t)(end - compressed.data());
+			if (fwrite(&header, sizeof(header), 1, m_file) != 1 || fwrite(compressed.data(), 1, header.compressedSize, m_file) != header.compressedSize)
+				m_writeFailed = true;
+
+			m_entryCount += count;
+			m_bytesWritten += sizeof(header) + header.compressedSize;
+			count = 0;
+		}
+
+		if (stopping && popped == 0)
+			break;
+	}
+}
+
+//=============================================================================
+// Reader
+//=============================================================================
+Mos6502TraceReader::Mos6502TraceReader()
+{
+
+}
+
+Mos6502TraceReader::~Mos6502TraceReader()
+{
+	Close();
+}
+
+bool Mos6502TraceReader::Open(const char *filename)
+{
+	Close();
+
+	m_file = fopen(filename, "rb");
+	if (m_file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
+
+	TraceFileHeader header;
+	if (fread(&header, sizeof(header), 1, m_file) != 1 || memcmp(header.magic, "NTRC", 4) != 0 ||
+		header.version != Mos6502TraceWriter::TraceVersion || header.entrySize != sizeof(Mos6502TraceEntry))
+	{
+		printf("%s is not a trace file, or was written by a different version\n", filename);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void Mos6502TraceReader::Close()
+{
+	if (m_file != nullptr)
+		fclose(m_file);
+
+	m_file = nullptr;
+	m_entries.clear();
+	m_position = 0;
+	m_failed = false;
+}
+
+bool Mos6502TraceReader::ReadChunk()
+{
+	if (m_file == nullptr)
+		return false;
+
+	if (m_failed)
+		return false;
+
+	// nothing at all left is the end of the trace, anything short of a whole chunk is a failure
+	TraceChunkHeader header;
+	size_t headerSize = fread(&header, 1, sizeof(header), m_file);
+	if (headerSize == 0 && !ferror(m_file))
+		return false;
+
+	if (headerSize != sizeof(header))
+	{
+		printf("truncated trace chunk\n");
+		m_failed = true;
+		return false;
+	}
+
+	if (header.numEntries == 0 || header.numEntries > Mos6502TraceWriter::ChunkEntries ||
+		header.compressedSize > header.numEntries * TraceCodec::MaxEncodedSize)
+	{
+		printf("damaged trace chunk\n");
+		m_failed = true;
+		return false;
+	}
+
+	m_compressed.resize(header.compressedSize);
+	if (fread(m_compressed.data(), 1, header.compressedSize, m_file) != header.compressedSize)
+	{
+		printf("truncated trace chunk\n");
+		m_failed = true;
+		return false;
+	}
+
+	static thread_local TraceCodec codec;
+	codec.Reset();
+
+	m_entries.resize(header.numEntries);
+	const uint8_t *data = m_compressed.data();
+	const uint8_t *end = data + m_compressed.size();
+	for (uint32_t i = 0; i < header.numEntries; i++)
+	{
+		if (!codec.Decode(data, end, m_entries[i]))
+		{
+			printf("damaged trace chunk\n");
+			m_entries.clear();
+			m_position = 0;
+			m_failed = true;
+			return false;
+		}
+	}
+
+	m_position = 0;
+	return true;
+}
+
+bool Mos6502TraceReader::WriteNestestLog(FILE *output)
+{
+	// lines are formatted one at a time and written out through a second, buffered disassembler
+	Mos6502Disassembler line(256);
+	Mos6502Disassembler writer;
+	writer.SetOutput(output);
+
+	Mos6502TraceEntry entry;
+	while (Next(entry))
+	{
+		FormatNestestLine(entry, line);
+		writer.AppendText(line.GetText(), line.GetLength());
+	}
+
+	writer.Flush();
+	return ferror(output) == 0 && !m_failed;
+}
+
+void Mos6502TraceReader::FormatNestestLine(const Mos6502TraceEntry &entry, Mos6502Disassembler &line)
+{
+	// nestest.log puts the registers at column 48
+	static const size_t RegisterColumn = 48;
+
+	line.Clear();
+	line.FormatInstruction(entry.bytes, 3, entry.pc, false);
+
+	char registers[128];
+	int pad = line.GetLength() < RegisterColumn ? (int)(RegisterColumn - line.GetLength()) : 1;
+	int length = snprintf(registers, sizeof(registers), "%*sA:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3u,%3u CYC:%llu\n", pad, "",
+		entry.a, entry.x, entry.y, entry.p, entry.sp, entry.scanline, entry.dot, (unsigned long long)entry.cycles);
+
+	line.AppendText(registers, length);
+}
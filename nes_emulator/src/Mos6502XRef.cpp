@@ -0,0 +1,141 @@
+#include "Mos6502XRef.h"
+#include "Mos6502CodeAnalyzer.h"
+#include "Mos6502OpCodes.h"
+#include "Crc32.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static bool CompareEntries(const XRefEntry &a, const XRefEntry &b)
+{
+	if (a.target != b.target)
+		return a.target < b.target;
+	return a.sourcePrgOffset < b.sourcePrgOffset;
+}
+
+Mos6502XRefIndex::Mos6502XRefIndex()
+{
+
+}
+
+Mos6502XRefIndex::~Mos6502XRefIndex()
+{
+
+}
+
+void Mos6502XRefIndex::Build(const Mos6502CodeAnalyzer &analyzer)
+{
+	const uint8_t *prg = analyzer.GetPrg();
+	uint32_t prgSize = analyzer.GetPrgSize();
+
+	m_file.Close();
+	m_built.clear();
+
+	for (uint32_t offset = 0; offset < prgSize; offset++)
+	{
+		if (!analyzer.IsInstructionStart(offset))
+			continue;
+
+		const Mos6502OpCode &op = Mos6502OpCodeTable[prg[offset]];
+		uint16_t source = analyzer.PrgOffsetToCpu(offset);
+		// the analyzer only marks instructions that fit in their bank, a 1 byte opcode can still be the last prg byte
+		uint16_t operand = 0;
+		if (op.bytes == 3)
+			operand = (uint16_t)(prg[offset + 1] | (prg[offset + 2] << 8));
+		else if (op.bytes == 2)
+			operand = prg[offset + 1];
+
+		XRefEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.sourceAddress = source;
+		entry.sourcePrgOffset = offset;
+		entry.opCode = prg[offset];
+		entry.target = operand;
+
+		if (op.flags & OPCODE_BRANCH)
+		{
+			entry.kind = XREF_BRANCH;
+			entry.target = (uint16_t)(source + 2 + (int8_t)operand);
+		}
+		else if (op.flags & OPCODE_CALL)
+			entry.kind = XREF_CALL;
+		else if (op.flags & OPCODE_JUMP)
+			entry.kind = op.mode == ADDR_INDIRECT ? XREF_READ : XREF_JUMP;
+		else if (op.mode != ADDR_IMMEDIATE && (op.flags & (OPCODE_READ | OPCODE_WRITE)))
+		{
+			if (op.flags & OPCODE_READ)		entry.kind |= XREF_READ;
+			if (op.flags & OPCODE_WRITE)	entry.kind |= XREF_WRITE;
+		}
+		else
+			continue;
+
+		m_built.push_back(entry);
+	}
+
+	std::sort(m_built.begin(), m_built.end(), CompareEntries);
+
+	m_entries = m_built.data();
+	m_count = m_built.size();
+	m_prgSize = prgSize;
+	m_prgCrc32 = Crc32(prg, prgSize);
+}
+
+bool Mos6502XRefIndex::Save(const char *filename) const
+{
+	XRefFileHeader header;
+	memcpy(header.magic, "NXRF", 4);
+	header.version = IndexVersion;
+	header.prgCrc32 = m_prgCrc32;
+	header.prgSize = m_prgSize;
+	header.numEntries = (uint32_t)m_count;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (m_count > 0)
+		ok = ok && fwrite(m_entries, sizeof(XRefEntry), m_count, file) == m_count;
+
+	return (fclose(file) == 0) && ok;
+}
+
+bool Mos6502XRefIndex::Load(const char *filename, uint32_t prgCrc32)
+{
+	if (!m_file.Open(filename))
+		return false;
+
+	const XRefFileHeader *header = (const XRefFileHeader *)m_file.GetData();
+	bool valid = m_file.GetSize() >= sizeof(XRefFileHeader) &&
+		memcmp(header->magic, "NXRF", 4) == 0 &&
+		header->version == IndexVersion &&
+		header->prgCrc32 == prgCrc32 &&
+		sizeof(XRefFileHeader) + (size_t)header->numEntries * sizeof(XRefEntry) <= m_file.GetSize();
+
+	if (!valid)
+	{
+		m_file.Close();
+		return false;
+	}
+
+	m_built.clear();
+	m_entries = (const XRefEntry *)(header + 1);
+	m_count = header->numEntries;
+	m_prgCrc32 = header->prgCrc32;
+	m_prgSize = header->prgSize;
+	return true;
+}
+
+std::pair<const XRefEntry *, const XRefEntry *> Mos6502XRefIndex::Find(uint16_t target) const
+{
+	const XRefEntry *end = m_entries + m_count;
+
+	const XRefEntry *first = std::lower_bound(m_entries, end, target,
+		[](const XRefEntry &e, uint16_t value) { return e.target < value; });
+
+	const XRefEntry *last = std::upper_bound(first, end, target,
+		[](uint16_t value, const XRefEntry &e) { return value < e.target; });
+
+	return std::make_pair(first, last);
+}
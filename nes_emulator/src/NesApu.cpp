@@ -0,0 +1,578 @@
+#include "NesApu.h"
+#include <string.h>
+
+static const uint8_t LengthTable[32] =
+{
+	10, 254, 20, 2, 40, 4, 80, 6, 160, 8, 60, 10, 14, 12, 26, 14,
+	12, 16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
+};
+
+static const uint8_t DutyTable[4][8] =
+{
+	{ 0, 1, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 1, 0, 0, 0, 0, 0 },
+	{ 0, 1, 1, 1, 1, 0, 0, 0 },
+	{ 1, 0, 0, 1, 1, 1, 1, 1 },
+};
+
+// full scale of the mixed output before the high pass
+static const double OutputScale = 28000.0;
+
+// the non linear dac curves, indexed by pulse1 + pulse2 and 3 * triangle + 2 * noise + dmc
+// https://wiki.nesdev.com/w/index.php/APU_Mixer
+struct NesApuMixer
+{
+	int32_t		pulse[31];
+	int32_t		tnd[203];
+
+	NesApuMixer()
+	{
+		pulse[0] = 0;
+		for (int i = 1; i < 31; i++)
+			pulse[i] = (int32_t)(95.52 / (8128.0 / i + 100.0) * OutputScale + 0.5);
+
+		tnd[0] = 0;
+		for (int i = 1; i < 203; i++)
+			tnd[i] = (int32_t)(163.67 / (24329.0 / i + 100.0) * OutputScale + 0.5);
+	}
+};
+
+static const NesApuMixer &GetMixer()
+{
+	static const NesApuMixer mixer;
+	return mixer;
+}
+
+template<typename Region>
+void NesApuT<Region>::Envelope::Clock()
+{
+	if (start)
+	{
+		start = false;
+		decay = 15;
+		divider = volume;
+	}
+	else if (divider == 0)
+	{
+		divider = volume;
+		if (decay != 0)
+			decay--;
+		else if (loop)
+			decay = 15;
+	}
+	else
+		divider--;
+}
+
+template<typename Region>
+uint16_t NesApuT<Region>::Pulse::SweepTarget(bool onesComplement) const
+{
+	int32_t change = period >> sweepShift;
+	if (!sweepNegate)
+		return (uint16_t)(period + change);
+
+	// pulse 1 negates with one's complement, pulse 2 with two's
+	int32_t target = period - change - (onesComplement ? 1 : 0);
+	return (uint16_t)(target < 0 ? 0 : target);
+}
+
+template<typename Region>
+uint8_t NesApuT<Region>::Pulse::Output(bool onesComplement) const
+{
+	if (length == 0 || period < 8 || SweepTarget(onesComplement) > 0x7FF || !DutyTable[duty][sequence])
+		return 0;
+	return envelope.Output();
+}
+
+template<typename Region>
+NesApuT<Region>::NesApuT()
+	: m_mixer(&GetMixer())
+{
+	Reset(0);
+}
+
+template<typename Region>
+NesApuT<Region>::~NesApuT()
+{
+
+}
+
+template<typename Region>
+void NesApuT<Region>::SetSampleRate(uint32_t sampleRate)
+{
+	m_blip.SetRates(CpuClockRate, sampleRate);
+}
+
+template<typename Region>
+void NesApuT<Region>::Reset(uint64_t cycle)
+{
+	memset(m_pulse, 0, sizeof(m_pulse));
+	memset(&m_triangle, 0, sizeof(m_triangle));
+	memset(&m_noise, 0, sizeof(m_noise));
+	memset(&m_dmc, 0, sizeof(m_dmc));
+
+	m_pulse[0].nextClock = m_pulse[1].nextClock = Never;
+	m_triangle.nextClock = Never;
+	m_noise.shift = 1;
+	m_noise.period = Region::NoisePeriods[0];
+	m_noise.nextClock = Never;
+	m_dmc.period = Region::DmcPeriods[0];
+	m_dmc.bitsRemaining = 8;
+	m_dmc.silence = true;
+	m_dmc.nextClock = Never;
+
+	m_enabled = 0;
+	m_fiveStep = false;
+	m_irqInhibit = false;
+	m_frameIrq = false;
+	m_dmcIrq = false;
+	m_frameStep = 0;
+	m_frameSequenceStart = cycle;
+	m_nextFrameStep = cycle + Region::FourStepCycles[0];
+
+	m_cycle = cycle;
+	m_frameStartCycle = cycle;
+
+	// the starting level is the reference, only changes from it are output
+	m_level = m_mixer->pulse[0] + m_mixer->tnd[3 * 15];
+	m_blip.Clear();
+
+	UpdateNextIrqCycle();
+}
+
+template<typename Region>
+void NesApuT<Region>::Run(uint64_t cycle)
+{
+	for (;;)
+	{
+		uint64_t next = m_nextFrameStep;
+		next = m_pulse[0].nextClock < next ? m_pulse[0].nextClock : next;
+		next = m_pulse[1].nextClock < next ? m_pulse[1].nextClock : next;
+		next = m_triangle.nextClock < next ? m_triangle.nextClock : next;
+		next = m_noise.nextClock < next ? m_noise.nextClock : next;
+		next = m_dmc.nextClock < next ? m_dmc.nextClock : next;
+
+		if (next > cycle)
+			break;
+
+		m_cycle = next;
+
+		if (m_pulse[0].nextClock == next)
+			ClockPulse(m_pulse[0]);
+		if (m_pulse[1].nextClock == next)
+			ClockPulse(m_pulse[1]);
+		if (m_triangle.nextClock == next)
+			ClockTriangle();
+		if (m_noise.nextClock == next)
+			ClockNoise();
+		if (m_dmc.nextClock == next)
+			ClockDmc();
+
+		if (m_nextFrameStep == next)
+		{
+			const uint32_t *steps = m_fiveStep ? Region::FiveStepCycles : Region::FourStepCycles;
+			uint32_t numSteps = m_fiveStep ? 5 : 4;
+
+			// 4 step: quarter, half, quarter, half + irq. 5 step: quarter, half, quarter, -, half
+			bool half = m_frameStep == 1 || m_frameStep == numSteps - 1;
+			if (!m_fiveStep || m_frameStep != 3)
+				ClockQuarterFrame();
+			if (half)
+				ClockHalfFrame();
+			if (!m_fiveStep && m_frameStep == 3 && !m_irqInhibit)
+				m_frameIrq = true;
+
+			if (++m_frameStep == numSteps)
+			{
+				m_frameStep = 0;
+				m_frameSequenceStart += steps[numSteps];
+			}
+			m_nextFrameStep = m_frameSequenceStart + steps[m_frameStep];
+
+			WakeChannels();
+		}
+
+		UpdateOutput();
+	}
+
+	m_cycle = cycle;
+	UpdateNextIrqCycle();
+}
+
+template<typename Region>
+void NesApuT<Region>::EndFrame(uint64_t cycle)
+{
+	Run(cycle);
+	m_blip.EndFrame((uint32_t)(cycle - m_frameStartCycle));
+	m_frameStartCycle = cycle;
+}
+
+template<typename Region>
+uint8_t NesApuT<Region>::ReadStatus()
+{
+	uint8_t status = (uint8_t)((m_pulse[0].length != 0 ? 0x01 : 0) | (m_pulse[1].length != 0 ? 0x02 : 0) |
+		(m_triangle.length != 0 ? 0x04 : 0) | (m_noise.length != 0 ? 0x08 : 0) | (m_dmc.bytesRemaining != 0 ? 0x10 : 0) |
+		(m_frameIrq ? 0x40 : 0) | (m_dmcIrq ? 0x80 : 0));
+
+	// reading acknowledges the frame irq
+	m_frameIrq = false;
+	UpdateNextIrqCycle();
+	return status;
+}
+
+template<typename Region>
+void NesApuT<Region>::WriteRegister(uint16_t address, uint8_t value)
+{
+	switch (address)
+	{
+	case 0x4000:
+	case 0x4004:
+	{
+		Pulse &pulse = m_pulse[(address >> 2) & 1];
+		pulse.duty = value >> 6;
+		pulse.envelope.loop = (value & 0x20) != 0;
+		pulse.envelope.constant = (value & 0x10) != 0;
+		pulse.envelope.volume = value & 0x0F;
+	}
+	break;
+
+	case 0x4001:
+	case 0x4005:
+	{
+		Pulse &pulse = m_pulse[(address >> 2) & 1];
+		pulse.sweepEnabled = (value & 0x80) != 0;
+		pulse.sweepPeriod = (value >> 4) & 0x07;
+		pulse.sweepNegate = (value & 0x08) != 0;
+		pulse.sweepShift = value & 0x07;
+		pulse.sweepReload = true;
+	}
+	break;
+
+	case 0x4002:
+	case 0x4006:
+	{
+		Pulse &pulse = m_pulse[(address >> 2) & 1];
+		pulse.period = (uint16_t)((pulse.period & 0x0700) | value);
+	}
+	break;
+
+	case 0x4003:
+	case 0x4007:
+	{
+		Pulse &pulse = m_pulse[(address >> 2) & 1];
+		pulse.period = (uint16_t)((pulse.period & 0x00FF) | ((value & 0x07) << 8));
+		if (m_enabled & (1 << ((address >> 2) & 1)))
+			pulse.length = LengthTable[value >> 3];
+		pulse.sequence = 0;
+		pulse.envelope.start = true;
+	}
+	break;
+
+	case 0x4008:
+		m_triangle.control = (value & 0x80) != 0;
+		m_triangle.linearLoad = value & 0x7F;
+		break;
+
+	case 0x400A:
+		m_triangle.period = (uint16_t)((m_triangle.period & 0x0700) | value);
+		break;
+
+	case 0x400B:
+		m_triangle.period = (uint16_t)((m_triangle.period & 0x00FF) | ((value & 0x07) << 8));
+		if (m_enabled & 0x04)
+			m_triangle.length = LengthTable[value >> 3];
+		m_triangle.linearReload = true;
+		break;
+
+	case 0x400C:
+		m_noise.envelope.loop = (value & 0x20) != 0;
+		m_noise.envelope.constant = (value & 0x10) != 0;
+		m_noise.envelope.volume = value & 0x0F;
+		break;
+
+	case 0x400E:
+		m_noise.shortMode = (value & 0x80) != 0;
+		m_noise.period = Region::NoisePeriods[value & 0x0F];
+		break;
+
+	case 0x400F:
+		if (m_enabled & 0x08)
+			m_noise.length = LengthTable[value >> 3];
+		m_noise.envelope.start = true;
+		break;
+
+	case 0x4010:
+		m_dmc.irqEnabled = (value & 0x80) != 0;
+		m_dmc.loop = (value & 0x40) != 0;
+		m_dmc.period = Region::DmcPeriods[value & 0x0F];
+		if (!m_dmc.irqEnabled)
+			m_dmcIrq = false;
+		break;
+
+	case 0x4011:
+		m_dmc.output = value & 0x7F;
+		break;
+
+	case 0x4012:
+		m_dmc.sampleAddress = (uint16_t)(0xC000 + value * 64);
+		break;
+
+	case 0x4013:
+		m_dmc.sampleLength = (uint16_t)(value * 16 + 1);
+		break;
+
+	case 0x4015:
+		m_enabled = value & 0x1F;
+		if (!(value & 0x01))
+			m_pulse[0].length = 0;
+		if (!(value & 0x02))
+			m_pulse[1].length = 0;
+		if (!(value & 0x04))
+			m_triangle.length = 0;
+		if (!(value & 0x08))
+			m_noise.length = 0;
+
+		if (!(value & 0x10))
+			m_dmc.bytesRemaining = 0;
+		else if (m_dmc.bytesRemaining == 0)
+		{
+			m_dmc.address = m_dmc.sampleAddress;
+			m_dmc.bytesRemaining = m_dmc.sampleLength;
+			FetchDmcSample();
+		}
+		m_dmcIrq = false;
+		break;
+
+	case 0x4017:
+		m_fiveStep = (value & 0x80) != 0;
+		m_irqInhibit = (value & 0x40) != 0;
+		if (m_irqInhibit)
+			m_frameIrq = false;
+
+		m_frameStep = 0;
+		m_frameSequenceStart = m_cycle;
+		m_nextFrameStep = m_cycle + Region::FourStepCycles[0];
+
+		// the 5 step mode clocks everything straight away
+		if (m_fiveStep)
+		{
+			ClockQuarterFrame();
+			ClockHalfFrame();
+		}
+		break;
+
+	default:
+		return;
+	}
+
+	WakeChannels();
+	UpdateOutput();
+	UpdateNextIrqCycle();
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockQuarterFrame()
+{
+	m_pulse[0].envelope.Clock();
+	m_pulse[1].envelope.Clock();
+	m_noise.envelope.Clock();
+
+	if (m_triangle.linearReload)
+		m_triangle.linear = m_triangle.linearLoad;
+	else if (m_triangle.linear != 0)
+		m_triangle.linear--;
+
+	if (!m_triangle.control)
+		m_triangle.linearReload = false;
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockHalfFrame()
+{
+	// the envelope loop flag doubles as length counter halt
+	if (m_pulse[0].length != 0 && !m_pulse[0].envelope.loop)
+		m_pulse[0].length--;
+	if (m_pulse[1].length != 0 && !m_pulse[1].envelope.loop)
+		m_pulse[1].length--;
+	if (m_triangle.length != 0 && !m_triangle.control)
+		m_triangle.length--;
+	if (m_noise.length != 0 && !m_noise.envelope.loop)
+		m_noise.length--;
+
+	ClockSweep(m_pulse[0], true);
+	ClockSweep(m_pulse[1], false);
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockSweep(Pulse &pulse, bool onesComplement)
+{
+	uint16_t target = pulse.SweepTarget(onesComplement);
+	if (pulse.sweepDivider == 0 && pulse.sweepEnabled && pulse.sweepShift != 0 && pulse.period >= 8 && target <= 0x7FF)
+		pulse.period = target;
+
+	if (pulse.sweepDivider == 0 || pulse.sweepReload)
+	{
+		pulse.sweepDivider = pulse.sweepPeriod;
+		pulse.sweepReload = false;
+	}
+	else
+		pulse.sweepDivider--;
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockPulse(Pulse &pulse)
+{
+	// the sequencer counts down
+	pulse.sequence = (pulse.sequence - 1) & 7;
+
+	bool onesComplement = &pulse == &m_pulse[0];
+	if (pulse.length != 0 && pulse.period >= 8 && pulse.SweepTarget(onesComplement) <= 0x7FF)
+		pulse.nextClock += (pulse.period + 1) * 2;
+	else
+		pulse.nextClock = Never;
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockTriangle()
+{
+	m_triangle.sequence = (m_triangle.sequence + 1) & 31;
+
+	// the sequencer holds its position while stopped, periods below 2 are ultrasonic and held too
+	if (m_triangle.IsRunning())
+		m_triangle.nextClock += m_triangle.period + 1;
+	else
+		m_triangle.nextClock = Never;
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockNoise()
+{
+	uint16_t feedback = (m_noise.shift ^ (m_noise.shift >> (m_noise.shortMode ? 6 : 1))) & 1;
+	m_noise.shift = (uint16_t)((m_noise.shift >> 1) | (feedback << 14));
+
+	if (m_noise.length != 0)
+		m_noise.nextClock += m_noise.period;
+	else
+		m_noise.nextClock = Never;
+}
+
+template<typename Region>
+void NesApuT<Region>::ClockDmc()
+{
+	if (!m_dmc.silence)
+	{
+		if (m_dmc.shift & 1)
+		{
+			if (m_dmc.output <= 125)
+				m_dmc.output += 2;
+		}
+		else if (m_dmc.output >= 2)
+			m_dmc.output -= 2;
+	}
+	m_dmc.shift >>= 1;
+
+	if (--m_dmc.bitsRemaining == 0)
+	{
+		m_dmc.bitsRemaining = 8;
+		m_dmc.silence = !m_dmc.bufferFull;
+		if (m_dmc.bufferFull)
+		{
+			m_dmc.shift = m_dmc.buffer;
+			m_dmc.bufferFull = false;
+			FetchDmcSample();
+		}
+	}
+
+	if (!m_dmc.IsIdle())
+		m_dmc.nextClock += m_dmc.period;
+	else
+		m_dmc.nextClock = Never;
+}
+
+template<typename Region>
+void NesApuT<Region>::FetchDmcSample()
+{
+	if (m_dmc.bufferFull || m_dmc.bytesRemaining == 0)
+		return;
+
+	m_dmc.buffer = m_memoryReader != nullptr ? m_memoryReader(m_memoryContext, m_dmc.address) : 0;
+	m_dmc.bufferFull = true;
+	m_dmc.address = m_dmc.address == 0xFFFF ? 0x8000 : (uint16_t)(m_dmc.address + 1);
+
+	if (--m_dmc.bytesRemaining == 0)
+	{
+		if (m_dmc.loop)
+		{
+			m_dmc.address = m_dmc.sampleAddress;
+			m_dmc.bytesRemaining = m_dmc.sampleLength;
+		}
+		else if (m_dmc.irqEnabled)
+			m_dmcIrq = true;
+	}
+}
+
+template<typename Region>
+void NesApuT<Region>::WakeChannels()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		Pulse &pulse = m_pulse[i];
+		if (pulse.nextClock == Never && pulse.length != 0 && pulse.period >= 8 && pulse.SweepTarget(i == 0) <= 0x7FF)
+			pulse.nextClock = m_cycle + (pulse.period + 1) * 2;
+	}
+
+	if (m_triangle.nextClock == Never && m_triangle.IsRunning())
+		m_triangle.nextClock = m_cycle + m_triangle.period + 1;
+
+	if (m_noise.nextClock == Never && m_noise.length != 0)
+		m_noise.nextClock = m_cycle + m_noise.period;
+
+	if (m_dmc.nextClock == Never && !m_dmc.IsIdle())
+		m_dmc.nextClock = m_cycle + m_dmc.period;
+}
+
+template<typename Region>
+void NesApuT<Region>::UpdateNextIrqCycle()
+{
+	m_nextIrqCycle = Never;
+
+	if (!m_fiveStep && !m_irqInhibit && !m_frameIrq)
+		m_nextIrqCycle = m_frameSequenceStart + Region::FourStepCycles[3];
+
+	// the dmc irq comes from a sample fetch, which only happens on a dmc clock
+	if (m_dmc.irqEnabled && !m_dmc.loop && !m_dmcIrq && m_dmc.bytesRemaining != 0 && m_dmc.nextClock < m_nextIrqCycle)
+		m_nextIrqCycle = m_dmc.nextClock;
+}
+
+template<typename Region>
+void NesApuT<Region>::UpdateOutput()
+{
+	uint8_t triangle = m_triangle.sequence < 16 ? 15 - m_triangle.sequence : m_triangle.sequence - 16;
+	uint8_t noise = (m_noise.length != 0 && !(m_noise.shift & 1)) ? m_noise.envelope.Output() : 0;
+
+	int32_t level = m_mixer->pulse[m_pulse[0].Output(true) + m_pulse[1].Output(false)] +
+		m_mixer->tnd[3 * triangle + 2 * noise + m_dmc.output];
+
+	if (level != m_level)
+	{
+		m_blip.AddDelta((uint32_t)(m_cycle - m_frameStartCycle), level - m_level);
+		m_level = level;
+	}
+}
+
+template<typename Region>
+void NesApuT<Region>::HashState(NesStateHasher &hasher) const
+{
+	hasher.Add(m_pulse, sizeof(m_pulse));
+	hasher.Add(&m_triangle, sizeof(m_triangle));
+	hasher.Add(&m_noise, sizeof(m_noise));
+	hasher.Add(&m_dmc, sizeof(m_dmc));
+	hasher.Add(((uint64_t)m_enabled << 32) | ((uint64_t)m_fiveStep << 24) | ((uint64_t)m_irqInhibit << 16) |
+		((uint64_t)m_frameIrq << 9) | ((uint64_t)m_dmcIrq << 8) | m_frameStep);
+	hasher.Add(m_frameSequenceStart);
+	hasher.Add(m_cycle);
+}
+
+template class NesApuT<NesRegionNtsc>;
+template class NesApuT<NesRegionPal>;
+template class NesApuT<NesRegionDendy>;
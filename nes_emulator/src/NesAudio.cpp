@@ -0,0 +1,235 @@
+#include "NesAudio.h"
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+//=============================================================================
+// NesWavSink
+//=============================================================================
+bool NesWavSink::Open(uint32_t sampleRate)
+{
+	Close();
+
+	m_file = fopen(m_filename, "wb");
+	if (m_file == nullptr)
+	{
+		printf("failed to open %s for writing\n", m_filename);
+		return false;
+	}
+
+	m_sampleRate = sampleRate;
+	m_dataBytes = 0;
+	m_writeFailed = false;
+	return WriteHeader(0);
+}
+
+bool NesWavSink::Write(const int16_t *samples, size_t count)
+{
+	if (m_file == nullptr)
+		return false;
+
+	// wav is little endian, like every platform this builds on
+	if (fwrite(samples, sizeof(int16_t), count, m_file) != count)
+		m_writeFailed = true;
+	m_dataBytes += count * sizeof(int16_t);
+	return !m_writeFailed;
+}
+
+bool NesWavSink::Close()
+{
+	if (m_file == nullptr)
+		return true;
+
+	// the riff sizes are 32 bit, a longer recording keeps playing but reports the wrong length
+	bool ok = !m_writeFailed;
+	if (fseek(m_file, 0, SEEK_SET) != 0 || !WriteHeader(m_dataBytes > 0xFFFFFFDBull ? 0xFFFFFFDBu : (uint32_t)m_dataBytes))
+		ok = false;
+	if (fclose(m_file) != 0)
+		ok = false;
+	m_file = nullptr;
+	return ok;
+}
+
+bool NesWavSink::WriteHeader(uint32_t dataBytes)
+{
+	struct WavField { const void *data; size_t size; };
+
+	uint32_t riffSize = 36 + dataBytes;
+	uint32_t formatSize = 16;
+	uint16_t format = 1;		// pcm
+	uint16_t channels = 1;
+	uint32_t byteRate = m_sampleRate * 2;
+	uint16_t blockAlign = 2;
+	uint16_t bitsPerSample = 16;
+
+	const WavField fields[] =
+	{
+		{ "RIFF", 4 }, { &riffSize, 4 }, { "WAVE", 4 },
+		{ "fmt ", 4 }, { &formatSize, 4 }, { &format, 2 }, { &channels, 2 }, { &m_sampleRate, 4 },
+		{ &byteRate, 4 }, { &blockAlign, 2 }, { &bitsPerSample, 2 },
+		{ "data", 4 }, { &dataBytes, 4 },
+	};
+
+	for (const WavField &field : fields)
+	{
+		if (fwrite(field.data, 1, field.size, m_file) != field.size)
+			return false;
+	}
+	return true;
+}
+
+//=============================================================================
+// NesAudioStream
+//=============================================================================
+NesAudioStream::NesAudioStream()
+	: m_stop(false)
+	, m_sinkFailed(false)
+	, m_underrunSamples(0)
+{
+}
+
+NesAudioStream::~NesAudioStream()
+{
+	Stop();
+}
+
+bool NesAudioStream::Start(NesAudioSink *sink, uint32_t sampleRate, uint32_t latencyMs, uint32_t periodSamples)
+{
+	Stop();
+
+	if (!sink->Open(sampleRate))
+		return false;
+
+	m_sink = sink;
+	m_clocked = sink->IsClocked();
+	m_sampleRate = sampleRate;
+	m_periodSamples = periodSamples;
+	m_targetFill = (size_t)sampleRate * latencyMs / 1000;
+
+	// room for the target plus a few frames of jitter on either side
+	m_ring.Resize(m_targetFill * 2 + periodSamples + sampleRate / 15);
+
+	m_stop.store(false, std::memory_order_relaxed);
+	m_sinkFailed.store(false, std::memory_order_relaxed);
+	m_underrunSamples.store(0, std::memory_order_relaxed);
+	m_droppedSamples = 0;
+	m_fillSum = 0;
+	m_fillCount = 0;
+	m_maxFill = 0;
+	m_lastRatio = 1.0;
+
+	m_thread = std::thread(&NesAudioStream::DeviceThread, this);
+	return true;
+}
+
+bool NesAudioStream::Stop()
+{
+	if (m_sink == nullptr)
+		return true;
+
+	m_stop.store(true, std::memory_order_relaxed);
+	m_thread.join();
+
+	// the tail of the run, without any underrun padding
+	std::vector<int16_t> period(m_periodSamples);
+	size_t popped;
+	while ((popped = m_ring.Pop(period.data(), period.size())) != 0)
+	{
+		if (!m_sink->Write(period.data(), popped))
+			m_sinkFailed.store(true, std::memory_order_relaxed);
+	}
+
+	bool ok = m_sink->Close() && !m_sinkFailed.load(std::memory_order_relaxed);
+	m_sink = nullptr;
+	return ok;
+}
+
+double NesAudioStream::Push(const int16_t *samples, size_t count)
+{
+	size_t pushed = m_ring.Push(samples, count);
+
+	// a file takes everything, the emulation waits for the device thread to make room
+	while (!m_clocked && pushed < count && !m_sinkFailed.load(std::memory_order_relaxed))
+	{
+		std::this_thread::yield();
+		pushed += m_ring.Push(samples + pushed, count - pushed);
+	}
+	m_droppedSamples += count - pushed;
+
+	size_t fill = m_ring.GetCount();
+	m_fillSum += fill;
+	m_fillCount++;
+	if (fill > m_maxFill)
+		m_maxFill = fill;
+
+	if (!m_clocked)
+		return m_lastRatio = 1.0;
+
+	// above the target the next frame makes fewer samples, below it more
+	double error = ((double)m_targetFill - (double)fill) / (double)m_targetFill;
+	if (error > 1.0)
+		error = 1.0;
+	else if (error < -1.0)
+		error = -1.0;
+
+	m_lastRatio = 1.0 + error * MaxRateDelta;
+	return m_lastRatio;
+}
+
+double NesAudioStream::GetAverageLatencyMs() const
+{
+	return m_fillCount != 0 ? m_fillSum * 1000.0 / m_fillCount / m_sampleRate : 0.0;
+}
+
+double NesAudioStream::GetMaxLatencyMs() const
+{
+	return m_sampleRate != 0 ? m_maxFill * 1000.0 / m_sampleRate : 0.0;
+}
+
+void NesAudioStream::DeviceThread()
+{
+	std::vector<int16_t> period(m_periodSamples, 0);
+	int16_t lastSample = 0;
+
+	// without a clock the ring is drained as fast as it fills, Stop() writes the rest
+	if (!m_clocked)
+	{
+		while (!m_stop.load(std::memory_order_relaxed))
+		{
+			size_t popped = m_ring.Pop(period.data(), m_periodSamples);
+			if (popped == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			else if (!m_sink->Write(period.data(), popped))
+				m_sinkFailed.store(true, std::memory_order_relaxed);
+		}
+		return;
+	}
+
+	// prebuffer to the target fill
+	while (!m_stop.load(std::memory_order_relaxed) && m_ring.GetCount() < m_targetFill)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	// a sound card pulls a period every periodSamples / sampleRate seconds, timed from the start
+	auto start = std::chrono::steady_clock::now();
+	uint64_t periods = 0;
+
+	while (!m_stop.load(std::memory_order_relaxed))
+	{
+		size_t popped = m_ring.Pop(period.data(), m_periodSamples);
+		if (popped != 0)
+			lastSample = period[popped - 1];
+
+		if (popped < m_periodSamples)
+		{
+			m_underrunSamples.fetch_add(m_periodSamples - popped, std::memory_order_relaxed);
+			for (size_t i = popped; i < m_periodSamples; i++)
+				period[i] = lastSample;
+		}
+
+		if (!m_sink->Write(period.data(), m_periodSamples))
+			m_sinkFailed.store(true, std::memory_order_relaxed);
+
+		periods++;
+		std::this_thread::sleep_until(start + std::chrono::microseconds(periods * m_periodSamples * 1000000ull / m_sampleRate));
+	}
+}
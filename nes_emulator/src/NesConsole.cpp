@@ -0,0 +1,320 @@
+#include "NesConsole.h"
+#include "Mos6502CallStackProfiler.h"
+#include "Mos6502Tracer.h"
+#include "Mos6502OpCodes.h"
+#include "NesDebugger.h"
+#include "NesHeatmap.h"
+
+template<typename Region>
+NesConsoleT<Region>::NesConsoleT()
+{
+	m_cpu.GetBus().MapHandlers(0x20, 0x20, PpuRead, PpuWrite, this);
+	m_cpu.GetBus().MapHandlers(0x40, 0x01, IoRead, IoWrite, this);
+	m_apu.SetMemoryReader(ApuMemoryRead, this);
+}
+
+template<typename Region>
+NesConsoleT<Region>::~NesConsoleT()
+{
+
+}
+
+template<typename Region>
+void NesConsoleT<Region>::LoadCartridge(NesCartridge &cartridge)
+{
+	m_cpu.SetRomData(cartridge.GetRomBanks(), cartridge.GetRomBankCount());
+	m_ppu.SetChrData(cartridge.GetVRomBanks(), cartridge.GetVRomBankCount(), cartridge.GetHeader()->mirroringModeBit != 0);
+}
+
+template<typename Region>
+void NesConsoleT<Region>::Reset()
+{
+	m_ppu.Reset();
+	m_cpu.Reset();
+	m_apu.Reset(m_cpu.GetCycles());
+	m_cpu.SetIRQLine(false);
+	m_instructions = 0;
+	m_dotRemainder = 0;
+	m_ppuEventCycle = 0;
+
+	// the ppu runs through the cpu's reset sequence
+	StepPpu((uint32_t)m_cpu.GetCycles());
+
+	if (m_callStackProfiler != nullptr)
+	{
+		m_callStackProfiler->Reset(m_cpu.GetPC(), m_cpu.GetSP());
+		m_nextSampleCycle = m_cpu.GetCycles() + m_sampleCycles;
+	}
+}
+
+template<typename Region>
+void NesConsoleT<Region>::RunFrame()
+{
+	m_ppu.ClearFrameComplete();
+
+	if (m_callStackProfiler != nullptr || m_tracer != nullptr || m_hashInterval != 0 || m_debugger != nullptr || m_heatmap != nullptr)
+		RunFrameInstrumented();
+	else
+	{
+		while (!m_ppu.IsFrameComplete())
+			StepFused();
+	}
+
+	// a debugger break can stop part way through the frame
+	if (!m_ppu.IsFrameComplete())
+		return;
+
+	m_apu.EndFrame(m_cpu.GetCycles());
+	m_cpu.SetIRQLine(m_apu.IsIrqActive());
+
+	if (m_stateHashLog != nullptr)
+		m_stateHashLog->Append(m_ppu.GetFrameCount(), m_instructions, m_cpu.GetCycles(), HashState());
+
+	if (m_heatmap != nullptr)
+		m_heatmap->EndFrame();
+}
+
+template<typename Region>
+void NesConsoleT<Region>::RunFrameInstrumented()
+{
+	while (!m_ppu.IsFrameComplete())
+	{
+		if (m_debugger != nullptr && DebugInstruction())
+			return;
+
+		// interrupt entry is not an instruction, nestest style traces leave it out
+		if (m_tracer != nullptr && !m_cpu.IsInterruptPending())
+		{
+			uint64_t cycles = m_cpu.GetCycles();
+			if (cycles >= m_traceFirstCycle && cycles <= m_traceLastCycle)
+			{
+				Mos6502TraceEntry entry;
+				CaptureTraceEntry(entry);
+				m_tracer->Record(entry);
+			}
+		}
+
+		if (m_heatmap != nullptr && !m_cpu.IsInterruptPending())
+		{
+			uint16_t pc = m_cpu.GetPC();
+			m_heatmap->CountExecute(pc, Mos6502OpCodeTable[m_cpu.GetBus().Peek(pc)].bytes);
+		}
+
+		Step();
+		m_instructions++;
+
+		if (m_hashInterval != 0 && --m_hashCountdown == 0)
+		{
+			NesStateHasher hasher;
+			m_cpu.HashState(hasher, true);
+			m_stateHashLog->Append(m_ppu.GetFrameCount(), m_instructions, m_cpu.GetCycles(), hasher.GetHash());
+			m_hashCountdown = m_hashInterval;
+		}
+
+		if (m_callStackProfiler != nullptr && m_cpu.GetCycles() >= m_nextSampleCycle)
+		{
+			m_callStackProfiler->Sample(m_cpu.GetSP());
+			m_nextSampleCycle += m_sampleCycles;
+		}
+
+		// watchpoints break after the instruction that hit them
+		if (m_debugger != nullptr && m_debugger->IsBreakPending())
+			return;
+	}
+}
+
+template<typename Region>
+bool NesConsoleT<Region>::DebugInstruction()
+{
+	// the interrupt handler starts a new block
+	if (m_cpu.IsInterruptPending())
+	{
+		m_checkBlock = true;
+		return false;
+	}
+
+	uint16_t pc = m_cpu.GetPC();
+	m_debugger->SetInstructionPc(pc);
+
+	if (m_checkBlock)
+	{
+		m_checkBlock = false;
+		m_stepBreakpoints = m_debugger->BlockHasBreakpoint(pc);
+	}
+
+	if (m_stepBreakpoints && m_debugger->IsBreakpoint(pc) && m_debugger->CheckBreakpoint(pc))
+		return true;
+
+	if (Mos6502OpCodeTable[m_debugger->Peek(pc)].flags & OPCODE_BLOCK_END)
+		m_checkBlock = true;
+
+	return false;
+}
+
+template<typename Region>
+void NesConsoleT<Region>::SetDebugger(NesDebugger *debugger)
+{
+	if (m_debugger != nullptr)
+		m_debugger->Detach();
+
+	m_debugger = debugger;
+	m_checkBlock = true;
+	m_stepBreakpoints = false;
+
+	if (debugger != nullptr)
+		debugger->Attach(m_cpu);
+}
+
+template<typename Region>
+void NesConsoleT<Region>::SetHeatmap(NesHeatmap *heatmap)
+{
+	// the debugger traps whatever the heatmap left in the page table, so it comes off first
+	if (m_debugger != nullptr)
+		m_debugger->Detach();
+	if (m_heatmap != nullptr)
+		m_heatmap->Detach();
+
+	m_heatmap = heatmap;
+	m_ppu.SetHeatmap(heatmap);
+
+	if (heatmap != nullptr)
+		heatmap->Attach(m_cpu);
+	if (m_debugger != nullptr)
+		m_debugger->Attach(m_cpu);
+}
+
+template<typename Region>
+void NesConsoleT<Region>::SetStateHashLog(NesStateHashLog *log, uint32_t instructionInterval)
+{
+	m_stateHashLog = log;
+	m_hashInterval = log != nullptr ? instructionInterval : 0;
+	m_hashCountdown = m_hashInterval;
+
+	if (log != nullptr)
+		log->Reset(m_hashInterval);
+}
+
+template<typename Region>
+uint64_t NesConsoleT<Region>::HashState()
+{
+	NesStateHasher hasher;
+	m_cpu.HashState(hasher, true);
+	m_ppu.HashState(hasher);
+	m_apu.HashState(hasher);
+	return hasher.GetHash();
+}
+
+template<typename Region>
+void NesConsoleT<Region>::CaptureTraceEntry(Mos6502TraceEntry &entry)
+{
+	const NesCpuBus &bus = m_cpu.GetBus();
+	uint16_t pc = m_cpu.GetPC();
+
+	entry.cycles = m_cpu.GetCycles();
+	entry.pc = pc;
+	entry.bytes[0] = bus.Peek(pc);
+	entry.bytes[1] = bus.Peek((uint16_t)(pc + 1));
+	entry.bytes[2] = bus.Peek((uint16_t)(pc + 2));
+	entry.a = m_cpu.GetA();
+	entry.x = m_cpu.GetX();
+	entry.y = m_cpu.GetY();
+	entry.p = m_cpu.GetStatus();
+	entry.sp = m_cpu.GetSP();
+	entry.scanline = (uint16_t)m_ppu.GetScanline();
+	entry.dot = (uint16_t)m_ppu.GetDot();
+	entry.reserved[0] = 0;
+	entry.reserved[1] = 0;
+}
+
+template<typename Region>
+void NesConsoleT<Region>::SetCallStackProfiler(Mos6502CallStackProfiler *profiler, uint32_t sampleCycles)
+{
+	m_callStackProfiler = profiler;
+	m_sampleCycles = sampleCycles > 0 ? sampleCycles : 1;
+	m_cpu.SetCallObserver(profiler);
+
+	if (profiler != nullptr)
+	{
+		profiler->Reset(m_cpu.GetPC(), m_cpu.GetSP());
+		m_nextSampleCycle = m_cpu.GetCycles() + m_sampleCycles;
+	}
+}
+
+template<typename Region>
+uint8_t NesConsoleT<Region>::PpuRead(void *context, uint16_t address)
+{
+	return ((NesConsoleT *)context)->m_ppu.ReadRegister(address);
+}
+
+template<typename Region>
+void NesConsoleT<Region>::PpuWrite(void *context, uint16_t address, uint8_t value)
+{
+	((NesConsoleT *)context)->m_ppu.WriteRegister(address, value);
+}
+
+template<typename Region>
+uint8_t NesConsoleT<Region>::ApuMemoryRead(void *context, uint16_t address)
+{
+	return ((NesConsoleT *)context)->m_cpu.GetBus().Read(address);
+}
+
+template<typename Region>
+uint8_t NesConsoleT<Region>::IoRead(void *context, uint16_t address)
+{
+	NesConsoleT *console = (NesConsoleT *)context;
+
+	switch (address)
+	{
+	case 0x4015:	// apu status, reading acknowledges the frame irq
+	{
+		console->RunApu();
+		uint8_t status = console->m_apu.ReadStatus();
+		console->m_cpu.SetIRQLine(console->m_apu.IsIrqActive());
+		return status;
+	}
+
+	case 0x4016:	// controllers, no buttons pressed. bit 6 is usually open bus ($40)
+	case 0x4017:
+		return 0x40;
+
+	default:
+		return (uint8_t)(address >> 8);
+	}
+}
+
+template<typename Region>
+void NesConsoleT<Region>::IoWrite(void *context, uint16_t address, uint8_t value)
+{
+	NesConsoleT *console = (NesConsoleT *)context;
+
+	switch (address)
+	{
+	case 0x4014:	// OAM DMA, copies a 256 byte page to oam and halts the cpu for 513 / 514 cycles
+	{
+		uint8_t page[256];
+		uint16_t source = (uint16_t)(value << 8);
+		for (int i = 0; i < 256; i++)
+			page[i] = console->m_cpu.GetBus().Read((uint16_t)(source + i));
+
+		console->m_ppu.WriteOam(page);
+
+		uint64_t cycles = console->m_cpu.GetCycles();
+		console->m_cpu.AddCycles(513 + (uint32_t)(cycles & 1));
+	}
+	break;
+
+	default:
+		// $4000 - $4013 apu channels, $4015 channel enables, $4017 frame counter
+		if (address <= 0x4013 || address == 0x4015 || address == 0x4017)
+		{
+			console->RunApu();
+			console->m_apu.WriteRegister(address, value);
+			console->m_cpu.SetIRQLine(console->m_apu.IsIrqActive());
+		}
+		break;
+	}
+}
+
+template class NesConsoleT<NesRegionNtsc>;
+template class NesConsoleT<NesRegionPal>;
+template class NesConsoleT<NesRegionDendy>;
@@ -0,0 +1,106 @@
+#include "NesCpuBus.h"
+#include <string.h>
+
+NesCpuBus::NesCpuBus()
+{
+	memset(&m_workRam, 0, sizeof(m_workRam));
+	memset(&m_cartridgeRam, 0, sizeof(m_cartridgeRam));
+
+	MapHandlers(0x00, 256, OpenBusRead, IgnoreWrite, nullptr);
+	MapMemory(0x00, 0x20, m_workRam.data, sizeof(m_workRam), true);
+	MapMemory(0x60, 0x20, m_cartridgeRam.data, sizeof(m_cartridgeRam), true);
+}
+
+NesCpuBus::~NesCpuBus()
+{
+
+}
+
+void NesCpuBus::MapRomBanks(const RomBankMem *romBanks, uint8_t numRomBanks)
+{
+	if (numRomBanks == 0)
+	{
+		MapHandlers(0x80, 0x80, OpenBusRead, IgnoreWrite, nullptr);
+		return;
+	}
+
+	MapMemory(0x80, 0x40, (uint8_t *)romBanks[0].data, sizeof(RomBankMem), false);
+	MapMemory(0xC0, 0x40, (uint8_t *)romBanks[numRomBanks - 1].data, sizeof(RomBankMem), false);
+}
+
+void NesCpuBus::MapMemory(uint32_t firstPage, uint32_t numPages, uint8_t *memory, uint32_t size, bool writable)
+{
+	for (uint32_t i = 0; i < numPages && firstPage + i < 256; i++)
+	{
+		uint8_t *page = memory + ((i * 256) % size);
+		m_readPages[firstPage + i] = page;
+		m_writePages[firstPage + i] = writable ? page : nullptr;
+		m_peekPages[firstPage + i] = page;
+
+		// read only pages still need somewhere to send writes
+		m_handlers[firstPage + i].read = OpenBusRead;
+		m_handlers[firstPage + i].write = IgnoreWrite;
+		m_handlers[firstPage + i].context = nullptr;
+	}
+
+	UpdateLowPages();
+}
+
+void NesCpuBus::MapHandlers(uint32_t firstPage, uint32_t numPages, ReadHandler read, WriteHandler write, void *context)
+{
+	for (uint32_t i = 0; i < numPages && firstPage + i < 256; i++)
+	{
+		m_readPages[firstPage + i] = nullptr;
+		m_writePages[firstPage + i] = nullptr;
+		m_peekPages[firstPage + i] = nullptr;
+		m_handlers[firstPage + i].read = read;
+		m_handlers[firstPage + i].write = write;
+		m_handlers[firstPage + i].context = context;
+	}
+
+	UpdateLowPages();
+}
+
+NesCpuBus::PageMapping NesCpuBus::GetPageMapping(uint32_t page) const
+{
+	PageMapping mapping;
+	mapping.read = m_readPages[page];
+	mapping.write = m_writePages[page];
+	mapping.peek = m_peekPages[page];
+	mapping.readHandler = m_handlers[page].read;
+	mapping.writeHandler = m_handlers[page].write;
+	mapping.context = m_handlers[page].context;
+	return mapping;
+}
+
+void NesCpuBus::SetPageMapping(uint32_t page, const PageMapping &mapping)
+{
+	m_readPages[page] = mapping.read;
+	m_writePages[page] = mapping.write;
+	m_peekPages[page] = mapping.peek;
+	m_handlers[page].read = mapping.readHandler;
+	m_handlers[page].write = mapping.writeHandler;
+	m_handlers[page].context = mapping.context;
+
+	UpdateLowPages();
+}
+
+void NesCpuBus::UpdateLowPages()
+{
+	// the work ram on the NES, a flat 64kb image in the test runner. Debugger traps and the fuzz
+	// targets route them through handlers
+	bool direct = m_readPages[0] != nullptr && m_readPages[0] == m_writePages[0] &&
+		m_readPages[1] == m_writePages[1] && m_readPages[1] == m_readPages[0] + 256;
+	m_lowPages = direct ? m_writePages[0] : nullptr;
+}
+
+uint8_t NesCpuBus::OpenBusRead(void *context, uint16_t address)
+{
+	// nothing drives the data bus, the high byte of the address is usually what is left on it
+	return (uint8_t)(address >> 8);
+}
+
+void NesCpuBus::IgnoreWrite(void *context, uint16_t address, uint8_t value)
+{
+
+}
@@ -0,0 +1,364 @@
+#include "NesDebugCondition.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum DebugConditionOp : uint8_t
+{
+	COND_CONST,		// followed by a 16 bit little endian value
+	COND_A,
+	COND_X,
+	COND_Y,
+	COND_SP,
+	COND_P,
+	COND_PC,
+	COND_VALUE,
+	COND_ADDRESS,
+	COND_PEEK,
+	COND_NOT,
+	COND_NEGATE,
+	COND_ADD,
+	COND_SUB,
+	COND_AND,
+	COND_OR,
+	COND_XOR,
+	COND_EQUAL,
+	COND_NOT_EQUAL,
+	COND_LESS,
+	COND_LESS_EQUAL,
+	COND_GREATER,
+	COND_GREATER_EQUAL,
+	COND_LOGICAL_AND,
+	COND_LOGICAL_OR,
+};
+
+NesDebugCondition::NesDebugCondition()
+{
+
+}
+
+NesDebugCondition::~NesDebugCondition()
+{
+
+}
+
+bool NesDebugCondition::Compile(const char *expression, std::string &error)
+{
+	m_code.clear();
+	m_text = expression;
+	m_position = expression;
+	m_depth = 0;
+	m_maxDepth = 0;
+	m_error.clear();
+
+	SkipSpaces();
+	if (*m_position == '\0')
+		return true;
+
+	bool ok = ParseOr();
+	SkipSpaces();
+	if (ok && *m_position != '\0')
+		ok = Fail("unexpected text");
+
+	if (ok && m_maxDepth > MaxStackDepth)
+		ok = Fail("expression is too deeply nested");
+
+	if (!ok)
+	{
+		m_code.clear();
+		error = m_error;
+	}
+	return ok;
+}
+
+bool NesDebugCondition::Evaluate(const NesDebugContext &context) const
+{
+	if (m_code.empty())
+		return true;
+
+	int32_t stack[MaxStackDepth];
+	int top = -1;
+
+	const uint8_t *code = m_code.data();
+	const uint8_t *end = code + m_code.size();
+	while (code < end)
+	{
+		uint8_t op = *code++;
+		switch (op)
+		{
+		case COND_CONST:	stack[++top] = code[0] | (code[1] << 8); code += 2; break;
+		case COND_A:		stack[++top] = context.a; break;
+		case COND_X:		stack[++top] = context.x; break;
+		case COND_Y:		stack[++top] = context.y; break;
+		case COND_SP:		stack[++top] = context.sp; break;
+		case COND_P:		stack[++top] = context.p; break;
+		case COND_PC:		stack[++top] = context.pc; break;
+		case COND_VALUE:	stack[++top] = context.value; break;
+		case COND_ADDRESS:	stack[++top] = context.address; break;
+		case COND_PEEK:		stack[top] = context.peek(context.peekContext, (uint16_t)stack[top]); break;
+		case COND_NOT:		stack[top] = !stack[top]; break;
+		case COND_NEGATE:	stack[top] = -stack[top]; break;
+
+		default:
+		{
+			int32_t right = stack[top--];
+			int32_t &left = stack[top];
+			switch (op)
+			{
+			case COND_ADD:				left = left + right; break;
+			case COND_SUB:				left = left - right; break;
+			case COND_AND:				left = left & right; break;
+			case COND_OR:				left = left | right; break;
+			case COND_XOR:				left = left ^ right; break;
+			case COND_EQUAL:			left = left == right; break;
+			case COND_NOT_EQUAL:		left = left != right; break;
+			case COND_LESS:				left = left < right; break;
+			case COND_LESS_EQUAL:		left = left <= right; break;
+			case COND_GREATER:			left = left > right; break;
+			case COND_GREATER_EQUAL:	left = left >= right; break;
+			case COND_LOGICAL_AND:		left = left && right; break;
+			case COND_LOGICAL_OR:		left = left || right; break;
+			}
+		}
+		break;
+		}
+	}
+
+	return stack[0] != 0;
+}
+
+bool NesDebugCondition::ParseOr()
+{
+	if (!ParseAnd())
+		return false;
+
+	while (Match("||"))
+	{
+		if (!ParseAnd())
+			return false;
+		Emit(COND_LOGICAL_OR, -1);
+	}
+	return true;
+}
+
+bool NesDebugCondition::ParseAnd()
+{
+	if (!ParseCompare())
+		return false;
+
+	while (Match("&&"))
+	{
+		if (!ParseCompare())
+			return false;
+		Emit(COND_LOGICAL_AND, -1);
+	}
+	return true;
+}
+
+bool NesDebugCondition::ParseCompare()
+{
+	if (!ParseBitwise())
+		return false;
+
+	// longer operators are tried first so "<=" is not read as "<"
+	static const struct { const char *token; uint8_t op; } compares[] =
+	{
+		{ "==", COND_EQUAL }, { "!=", COND_NOT_EQUAL }, { "<=", COND_LESS_EQUAL },
+		{ ">=", COND_GREATER_EQUAL }, { "<", COND_LESS }, { ">", COND_GREATER },
+	};
+
+	for (const auto &compare : compares)
+	{
+		if (Match(compare.token))
+		{
+			if (!ParseBitwise())
+				return false;
+			Emit(compare.op, -1);
+			break;
+		}
+	}
+	return true;
+}
+
+bool NesDebugCondition::ParseBitwise()
+{
+	if (!ParseSum())
+		return false;
+
+	for (;;)
+	{
+		SkipSpaces();
+
+		// '&&' and '||' belong to the logical operators
+		uint8_t op;
+		if (m_position[0] == '&' && m_position[1] != '&')		op = COND_AND;
+		else if (m_position[0] == '|' && m_position[1] != '|')	op = COND_OR;
+		else if (m_position[0] == '^')							op = COND_XOR;
+		else
+			return true;
+
+		m_position++;
+		if (!ParseSum())
+			return false;
+		Emit(op, -1);
+	}
+}
+
+bool NesDebugCondition::ParseSum()
+{
+	if (!ParseUnary())
+		return false;
+
+	for (;;)
+	{
+		uint8_t op;
+		if (Match("+"))			op = COND_ADD;
+		else if (Match("-"))	op = COND_SUB;
+		else
+			return true;
+
+		if (!ParseUnary())
+			return false;
+		Emit(op, -1);
+	}
+}
+
+bool NesDebugCondition::ParseUnary()
+{
+	SkipSpaces();
+	if (m_position[0] == '!' && m_position[1] != '=')
+	{
+		m_position++;
+		if (!ParseUnary())
+			return false;
+		Emit(COND_NOT, 0);
+		return true;
+	}
+
+	if (Match("-"))
+	{
+		if (!ParseUnary())
+			return false;
+		Emit(COND_NEGATE, 0);
+		return true;
+	}
+
+	return ParsePrimary();
+}
+
+bool NesDebugCondition::ParsePrimary()
+{
+	SkipSpaces();
+
+	if (Match("("))
+	{
+		if (!ParseOr())
+			return false;
+		return Match(")") ? true : Fail("expected ')'");
+	}
+
+	if (Match("["))
+	{
+		if (!ParseOr())
+			return false;
+		Emit(COND_PEEK, 0);
+		return Match("]") ? true : Fail("expected ']'");
+	}
+
+	// numbers
+	if (*m_position == '$' || isdigit((unsigned char)*m_position))
+	{
+		// $hex, 0xhex or decimal, a leading zero is not octal
+		const char *digits = m_position;
+		bool hex = true;
+		if (*digits == '$')
+			digits++;
+		else if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+			digits += 2;
+		else
+			hex = false;
+
+		char *end;
+		unsigned long value = strtoul(digits, &end, hex ? 16 : 10);
+		if (end == digits)
+			return Fail("expected a number");
+		if (value > 0xFFFF)
+			return Fail("numbers are limited to 16 bits");
+
+		m_position = end;
+		Emit(COND_CONST, 1);
+		m_code.push_back((uint8_t)value);
+		m_code.push_back((uint8_t)(value >> 8));
+		return true;
+	}
+
+	// names
+	static const struct { const char *name; uint8_t op; } names[] =
+	{
+		{ "value", COND_VALUE }, { "addr", COND_ADDRESS }, { "sp", COND_SP }, { "pc", COND_PC },
+		{ "a", COND_A }, { "x", COND_X }, { "y", COND_Y }, { "p", COND_P },
+	};
+
+	const char *start = m_position;
+	while (isalnum((unsigned char)*m_position) || *m_position == '_')
+		m_position++;
+	size_t length = m_position - start;
+
+	for (const auto &name : names)
+	{
+		if (strlen(name.name) != length)
+			continue;
+
+		size_t i = 0;
+		while (i < length && tolower((unsigned char)start[i]) == name.name[i])
+			i++;
+
+		if (i == length)
+		{
+			Emit(name.op, 1);
+			return true;
+		}
+	}
+
+	m_position = start;
+	return Fail("expected a number, register or [address]");
+}
+
+void NesDebugCondition::SkipSpaces()
+{
+	while (*m_position == ' ' || *m_position == '\t')
+		m_position++;
+}
+
+bool NesDebugCondition::Match(const char *token)
+{
+	SkipSpaces();
+	size_t length = strlen(token);
+	if (strncmp(m_position, token, length) != 0)
+		return false;
+
+	m_position += length;
+	return true;
+}
+
+void NesDebugCondition::Emit(uint8_t op, int stackChange)
+{
+	m_code.push_back(op);
+	m_depth += stackChange;
+	if (m_depth > m_maxDepth)
+		m_maxDepth = m_depth;
+}
+
+bool NesDebugCondition::Fail(const char *message)
+{
+	// only the first error is kept, it is the closest to the problem
+	if (m_error.empty())
+	{
+		char text[160];
+		snprintf(text, sizeof(text), "%s at column %d", message, (int)(m_position - m_text) + 1);
+		m_error = text;
+	}
+	return false;
+}
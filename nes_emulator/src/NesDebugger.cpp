@@ -0,0 +1,257 @@
+#include "NesDebugger.h"
+#include "Mos6502OpCodes.h"
+
+#include <string.h>
+
+NesDebugger::NesDebugger() :
+	m_breakpointBits(0x10000, 0),
+	m_watchKinds(0x10000, 0),
+	m_blockCache(0x10000, -1)
+{
+	memset(m_trapped, 0, sizeof(m_trapped));
+	memset(m_originalPages, 0, sizeof(m_originalPages));
+}
+
+NesDebugger::~NesDebugger()
+{
+	Detach();
+}
+
+bool NesDebugger::AddBreakpoint(uint16_t address, const char *condition, std::string &error)
+{
+	Breakpoint breakpoint;
+	breakpoint.address = address;
+	if (!breakpoint.condition.Compile(condition, error))
+		return false;
+
+	m_breakpoints.push_back(breakpoint);
+	m_breakpointBits[address] = 1;
+
+	// cached blocks may now contain a breakpoint
+	std::fill(m_blockCache.begin(), m_blockCache.end(), (int8_t)-1);
+	return true;
+}
+
+bool NesDebugger::AddWatchpoint(uint16_t first, uint16_t last, uint8_t kinds, const char *condition, std::string &error)
+{
+	Watchpoint watchpoint;
+	watchpoint.first = CanonicalAddress(first);
+	watchpoint.last = CanonicalAddress(last);
+	watchpoint.kinds = kinds;
+	if (watchpoint.last < watchpoint.first)
+	{
+		error = "the watch range is empty";
+		return false;
+	}
+	if (!watchpoint.condition.Compile(condition, error))
+		return false;
+
+	m_watchpoints.push_back(watchpoint);
+
+	for (uint32_t address = 0; address < 0x10000; address++)
+	{
+		uint16_t canonical = CanonicalAddress((uint16_t)address);
+		if (canonical >= watchpoint.first && canonical <= watchpoint.last)
+			m_watchKinds[address] |= kinds;
+	}
+
+	// pick up the new pages if already attached
+	if (m_cpu != nullptr)
+	{
+		Mos6502CPU &cpu = *m_cpu;
+		Detach();
+		Attach(cpu);
+	}
+	return true;
+}
+
+void NesDebugger::Attach(Mos6502CPU &cpu)
+{
+	Detach();
+	m_cpu = &cpu;
+
+	NesCpuBus &bus = cpu.GetBus();
+	for (uint32_t page = 0; page < 256; page++)
+	{
+		bool watched = false;
+		for (uint32_t offset = 0; offset < 256 && !watched; offset++)
+			watched = m_watchKinds[page * 256 + offset] != 0;
+
+		if (!watched)
+			continue;
+
+		m_originalPages[page] = bus.GetPageMapping(page);
+		m_trapped[page] = true;
+
+		NesCpuBus::PageMapping trap;
+		trap.read = nullptr;
+		trap.write = nullptr;
+		trap.peek = m_originalPages[page].peek;
+		trap.readHandler = TrapRead;
+		trap.writeHandler = TrapWrite;
+		trap.context = this;
+		bus.SetPageMapping(page, trap);
+	}
+}
+
+void NesDebugger::Detach()
+{
+	if (m_cpu == nullptr)
+		return;
+
+	NesCpuBus &bus = m_cpu->GetBus();
+	for (uint32_t page = 0; page < 256; page++)
+	{
+		if (m_trapped[page])
+			bus.SetPageMapping(page, m_originalPages[page]);
+		m_trapped[page] = false;
+	}
+
+	m_cpu = nullptr;
+}
+
+bool NesDebugger::BlockHasBreakpoint(uint16_t pc)
+{
+	// rom blocks never change so their answer is cached, code in ram is decoded every time
+	bool cacheable = pc >= 0x8000;
+	if (cacheable && m_blockCache[pc] >= 0)
+		return m_blockCache[pc] != 0;
+
+	bool found = false;
+	uint16_t address = pc;
+	for (int i = 0; i < 256 && !found; i++)
+	{
+		found = m_breakpointBits[address] != 0;
+
+		const Mos6502OpCode &op = Mos6502OpCodeTable[Peek(address)];
+		if (op.mnemonic == nullptr || (op.flags & OPCODE_BLOCK_END))
+			break;
+		address = (uint16_t)(address + op.bytes);
+	}
+
+	if (cacheable)
+		m_blockCache[pc] = found ? 1 : 0;
+	return found;
+}
+
+bool NesDebugger::CheckBreakpoint(uint16_t pc)
+{
+	// the instruction a break stopped on runs once on resume
+	if (m_skipOnce)
+	{
+		m_skipOnce = false;
+		if (pc == m_skipAddress)
+			return false;
+	}
+
+	NesDebugContext context;
+	FillContext(context, pc, 0);
+
+	for (uint32_t i = 0; i < m_breakpoints.size(); i++)
+	{
+		if (m_breakpoints[i].address == pc && m_breakpoints[i].condition.Evaluate(context))
+		{
+			RaiseBreak(0, pc, 0, i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void NesDebugger::Resume()
+{
+	if (m_breakPending && m_hit.kind == 0)
+	{
+		m_skipOnce = true;
+		m_skipAddress = m_hit.address;
+	}
+	m_breakPending = false;
+}
+
+uint8_t NesDebugger::PeekCallback(const void *context, uint16_t address)
+{
+	return ((const NesDebugger *)context)->Peek(address);
+}
+
+uint16_t NesDebugger::CanonicalAddress(uint16_t address)
+{
+	if (address < 0x2000)
+		return address & 0x07FF;
+	if (address < 0x4000)
+		return 0x2000 | (address & 0x0007);
+	return address;
+}
+
+uint8_t NesDebugger::TrapRead(void *context, uint16_t address)
+{
+	NesDebugger *debugger = (NesDebugger *)context;
+	const NesCpuBus::PageMapping &page = debugger->m_originalPages[address >> 8];
+
+	uint8_t value = page.read != nullptr ? page.read[address & 0xFF] : page.readHandler(page.context, address);
+
+	if (debugger->m_watchKinds[address] & WATCH_READ)
+		debugger->OnAccess(WATCH_READ, address, value);
+	return value;
+}
+
+void NesDebugger::TrapWrite(void *context, uint16_t address, uint8_t value)
+{
+	NesDebugger *debugger = (NesDebugger *)context;
+	const NesCpuBus::PageMapping &page = debugger->m_originalPages[address >> 8];
+
+	if (debugger->m_watchKinds[address] & WATCH_WRITE)
+		debugger->OnAccess(WATCH_WRITE, address, value);
+
+	if (page.write != nullptr)
+		page.write[address & 0xFF] = value;
+	else
+		page.writeHandler(page.context, address, value);
+}
+
+void NesDebugger::OnAccess(uint8_t kind, uint16_t address, uint8_t value)
+{
+	// the first hit stops the instruction, later accesses in it are not reported
+	if (m_breakPending)
+		return;
+
+	uint16_t canonical = CanonicalAddress(address);
+
+	NesDebugContext context;
+	FillContext(context, address, value);
+
+	for (uint32_t i = 0; i < m_watchpoints.size(); i++)
+	{
+		const Watchpoint &watchpoint = m_watchpoints[i];
+		if ((watchpoint.kinds & kind) && canonical >= watchpoint.first && canonical <= watchpoint.last &&
+			watchpoint.condition.Evaluate(context))
+		{
+			RaiseBreak(kind, address, value, i);
+			return;
+		}
+	}
+}
+
+void NesDebugger::FillContext(NesDebugContext &context, uint16_t address, uint8_t value) const
+{
+	context.pc = m_instructionPc;
+	context.a = m_cpu->GetA();
+	context.x = m_cpu->GetX();
+	context.y = m_cpu->GetY();
+	context.sp = m_cpu->GetSP();
+	context.p = m_cpu->GetStatus();
+	context.value = value;
+	context.address = address;
+	context.peek = PeekCallback;
+	context.peekContext = this;
+}
+
+void NesDebugger::RaiseBreak(uint8_t kind, uint16_t address, uint8_t value, uint32_t index)
+{
+	m_breakPending = true;
+	m_hit.kind = kind;
+	m_hit.address = address;
+	m_hit.value = value;
+	m_hit.pc = m_instructionPc;
+	m_hit.index = index;
+	m_hitCount++;
+}
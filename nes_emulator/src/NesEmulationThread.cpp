@@ -0,0 +1,91 @@
+#include "NesEmulationThread.h"
+
+#include <chrono>
+
+template<typename Region>
+NesEmulationThreadT<Region>::NesEmulationThreadT()
+	: m_stop(false)
+	, m_finished(true)
+	, m_emulatedFrames(0)
+{
+}
+
+template<typename Region>
+NesEmulationThreadT<Region>::~NesEmulationThreadT()
+{
+	Stop();
+}
+
+template<typename Region>
+bool NesEmulationThreadT<Region>::Start(NesConsoleT<Region> &console, uint64_t numFrames, NesFramePacer *pacer,
+	NesAudioStream *audio)
+{
+	if (m_thread.joinable())
+		return false;
+
+	m_console = &console;
+	m_numFrames = numFrames;
+	m_pacer = pacer;
+	m_audio = audio;
+	m_frames.Reset();
+	m_stop.store(false, std::memory_order_relaxed);
+	m_finished.store(false, std::memory_order_relaxed);
+	m_emulatedFrames.store(0, std::memory_order_relaxed);
+
+	m_thread = std::thread(&NesEmulationThreadT::Run, this);
+	return true;
+}
+
+template<typename Region>
+void NesEmulationThreadT<Region>::Stop()
+{
+	if (!m_thread.joinable())
+		return;
+
+	m_stop.store(true, std::memory_order_relaxed);
+	m_thread.join();
+	m_console->GetPpu().SetFrameBuffer(nullptr);
+}
+
+template<typename Region>
+void NesEmulationThreadT<Region>::Run()
+{
+	NesPpu &ppu = m_console->GetPpu();
+	uint64_t frames = 0;
+	auto startTime = std::chrono::steady_clock::now();
+
+	while (frames < m_numFrames && !m_stop.load(std::memory_order_relaxed))
+	{
+		// a skipped frame still runs all the timing, only the pixels are not composed
+		bool draw = m_pacer == nullptr || m_pacer->BeginFrame();
+		ppu.SetFrameBuffer(draw ? &m_frames.GetBack() : nullptr);
+
+		uint64_t frameCount = m_console->GetFrameCount();
+		m_console->RunFrame();
+
+		// RunFrame() returns early when a debugger breaks, which ends the run
+		if (m_console->GetFrameCount() == frameCount)
+			break;
+
+		if (draw)
+			m_frames.Publish();
+		m_emulatedFrames.store(++frames, std::memory_order_relaxed);
+
+		if (m_audio != nullptr)
+		{
+			NesApuT<Region> &apu = m_console->GetApu();
+			const std::vector<int16_t> &samples = apu.GetSamples();
+			apu.SetRateAdjust(m_audio->Push(samples.data(), samples.size()));
+		}
+
+		if (m_pacer != nullptr)
+			m_pacer->EndFrame();
+	}
+
+	m_runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	m_finished.store(true, std::memory_order_release);
+}
+
+template class NesEmulationThreadT<NesRegionNtsc>;
+template class NesEmulationThreadT<NesRegionPal>;
+template class NesEmulationThreadT<NesRegionDendy>;
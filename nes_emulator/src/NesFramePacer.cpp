@@ -0,0 +1,71 @@
+#include "NesFramePacer.h"
+#include <string.h>
+#include <thread>
+
+bool NesFramePacer::ParseMode(const char *name, NesPacingMode &mode)
+{
+	static const struct { const char *name; NesPacingMode mode; } modes[] =
+	{
+		{ "realtime", PACING_REALTIME },
+		{ "unthrottled", PACING_UNTHROTTLED },
+		{ "turbo", PACING_TURBO },
+	};
+
+	for (const auto &entry : modes)
+	{
+		if (strcmp(name, entry.name) == 0)
+		{
+			mode = entry.mode;
+			return true;
+		}
+	}
+	return false;
+}
+
+void NesFramePacer::Start(NesPacingMode mode, double frameRate, uint32_t frameskip)
+{
+	m_mode = mode;
+	m_frameskip = frameskip;
+	m_framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frameRate));
+	m_nextFrame = Clock::now() + m_framePeriod;
+	m_frames = 0;
+	m_skippedFrames = 0;
+}
+
+bool NesFramePacer::BeginFrame()
+{
+	bool draw = true;
+	switch (m_mode)
+	{
+	case PACING_REALTIME:
+		// a frame that is already late is not drawn, the time goes into catching up
+		draw = Clock::now() <= m_nextFrame;
+		break;
+
+	case PACING_TURBO:
+		draw = m_frames % (m_frameskip + 1) == 0;
+		break;
+
+	default:
+		break;
+	}
+
+	m_frames++;
+	if (!draw)
+		m_skippedFrames++;
+	return draw;
+}
+
+void NesFramePacer::EndFrame()
+{
+	if (m_mode != PACING_REALTIME)
+		return;
+
+	Clock::time_point now = Clock::now();
+	if (now < m_nextFrame)
+		std::this_thread::sleep_until(m_nextFrame);
+	else if (now - m_nextFrame > m_framePeriod * MaxFramesBehind)
+		m_nextFrame = now;
+
+	m_nextFrame += m_framePeriod;
+}
@@ -0,0 +1,277 @@
+#include "NesHeatmap.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+NesHeatmap::NesHeatmap()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		m_frames[i].assign(NumEntries, 0);
+		m_touched[i].assign(NumPages, 0);
+	}
+	m_totals.assign(NumEntries, 0);
+
+	Reset();
+}
+
+NesHeatmap::~NesHeatmap()
+{
+	Detach();
+}
+
+void NesHeatmap::Reset()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		std::fill(m_frames[i].begin(), m_frames[i].end(), 0);
+		std::fill(m_touched[i].begin(), m_touched[i].end(), 0);
+	}
+	std::fill(m_totals.begin(), m_totals.end(), 0);
+
+	m_backIndex = 0;
+	m_back = m_frames[0].data();
+	m_backTouched = m_touched[0].data();
+	m_front = m_frames[1].data();
+	m_numFrames = 0;
+}
+
+void NesHeatmap::Attach(Mos6502CPU &cpu)
+{
+	Detach();
+	m_cpu = &cpu;
+
+	NesCpuBus &bus = cpu.GetBus();
+	for (uint32_t page = 0; page < 256; page++)
+	{
+		m_originalPages[page] = bus.GetPageMapping(page);
+
+		NesCpuBus::PageMapping counter;
+		counter.read = nullptr;
+		counter.write = nullptr;
+		counter.peek = m_originalPages[page].peek;
+		counter.readHandler = CountRead;
+		counter.writeHandler = CountWrite;
+		counter.context = this;
+		bus.SetPageMapping(page, counter);
+	}
+}
+
+void NesHeatmap::Detach()
+{
+	if (m_cpu == nullptr)
+		return;
+
+	NesCpuBus &bus = m_cpu->GetBus();
+	for (uint32_t page = 0; page < 256; page++)
+		bus.SetPageMapping(page, m_originalPages[page]);
+
+	m_cpu = nullptr;
+}
+
+void NesHeatmap::EndFrame()
+{
+	// only pages that were counted into need adding up and clearing
+	for (uint32_t page = 0; page < NumPages; page++)
+	{
+		if (!m_backTouched[page])
+			continue;
+
+		const uint16_t *counts = m_back + page * 256;
+		uint64_t *totals = m_totals.data() + page * 256;
+		for (uint32_t i = 0; i < 256; i++)
+			totals[i] += counts[i];
+	}
+
+	m_front = m_back;
+	m_backIndex ^= 1;
+	m_back = m_frames[m_backIndex].data();
+	m_backTouched = m_touched[m_backIndex].data();
+
+	for (uint32_t page = 0; page < NumPages; page++)
+	{
+		if (!m_backTouched[page])
+			continue;
+
+		memset(m_back + page * 256, 0, 256 * sizeof(uint16_t));
+		m_backTouched[page] = 0;
+	}
+
+	m_numFrames++;
+}
+
+bool NesHeatmap::WriteBinary(const char *filename) const
+{
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	HeatmapFileHeader header;
+	memcpy(header.id, "NHMP", 4);
+	header.version = 1;
+	header.numFrames = m_numFrames;
+	header.numCounters = HEATMAP_COUNTERS;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(m_totals.data(), sizeof(uint64_t), NumEntries, file) == NumEntries &&
+		fwrite(m_front, sizeof(uint16_t), NumEntries, file) == NumEntries;
+
+	return fclose(file) == 0 && ok;
+}
+
+bool NesHeatmap::WriteCpuPpm(const char *filename, bool lastFrame) const
+{
+	static const NesHeatmapCounter channels[3] = { HEATMAP_CPU_WRITE, HEATMAP_CPU_READ, HEATMAP_CPU_EXECUTE };
+	return WritePpm(filename, 256, channels, CpuAddresses, lastFrame);
+}
+
+bool NesHeatmap::WritePpuPpm(const char *filename, bool lastFrame) const
+{
+	static const NesHeatmapCounter channels[3] = { HEATMAP_PPU_WRITE, HEATMAP_PPU_READ, HEATMAP_COUNTERS };
+	return WritePpm(filename, 128, channels, PpuAddresses, lastFrame);
+}
+
+bool NesHeatmap::WritePpm(const char *filename, uint32_t width, const NesHeatmapCounter *channels, uint32_t numEntries, bool lastFrame) const
+{
+	// one r, g, b channel per counter, HEATMAP_COUNTERS leaves the channel black
+	const uint64_t *totals = m_totals.data();
+	auto countOf = [&](NesHeatmapCounter counter, uint32_t address) -> uint64_t
+	{
+		uint32_t index = EntryIndex(counter, (uint16_t)address);
+		return lastFrame ? m_front[index] : totals[index];
+	};
+
+	// each channel is scaled on its own, log scale so rarely touched addresses still show up
+	double scale[3] = {};
+	for (int c = 0; c < 3; c++)
+	{
+		if (channels[c] == HEATMAP_COUNTERS)
+			continue;
+
+		uint64_t maxCount = 0;
+		for (uint32_t address = 0; address < numEntries; address++)
+			maxCount = std::max(maxCount, countOf(channels[c], address));
+
+		scale[c] = maxCount > 0 ? 255.0 / log(1.0 + (double)maxCount) : 0.0;
+	}
+
+	std::vector<uint8_t> pixels(numEntries * 3, 0);
+	for (uint32_t address = 0; address < numEntries; address++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			if (channels[c] == HEATMAP_COUNTERS)
+				continue;
+
+			uint64_t count = countOf(channels[c], address);
+			if (count > 0)
+				pixels[address * 3 + c] = (uint8_t)std::max(1.0, log(1.0 + (double)count) * scale[c] + 0.5);
+		}
+	}
+
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "P6\n%u %u\n255\n", width, numEntries / width);
+	bool ok = fwrite(pixels.data(), 1, pixels.size(), file) == pixels.size();
+
+	return fclose(file) == 0 && ok;
+}
+
+void NesHeatmap::WriteReport(FILE *output) const
+{
+	double frames = m_numFrames > 0 ? (double)m_numFrames : 1.0;
+
+	// work ram folded over its mirrors
+	std::vector<uint64_t> ramReads(0x800, 0), ramWrites(0x800, 0);
+	for (uint32_t address = 0; address < 0x2000; address++)
+	{
+		ramReads[address & 0x7FF] += GetTotalAccesses(HEATMAP_CPU_READ, (uint16_t)address);
+		ramWrites[address & 0x7FF] += GetTotalAccesses(HEATMAP_CPU_WRITE, (uint16_t)address);
+	}
+
+	fprintf(output, "%u frames\n", m_numFrames);
+
+	// zero page bytes nothing touches are free, bytes only ever written are wasted
+	uint32_t unused = 0, writeOnly = 0;
+	for (uint32_t address = 0; address < 0x100; address++)
+	{
+		if (ramReads[address] == 0 && ramWrites[address] == 0)
+			unused++;
+		else if (ramReads[address] == 0)
+			writeOnly++;
+	}
+	fprintf(output, "\nzero page: %u bytes unused, %u written but never read\n", unused, writeOnly);
+
+	if (writeOnly > 0)
+	{
+		fprintf(output, "  write only:");
+		for (uint32_t address = 0; address < 0x100; address++)
+		{
+			if (ramReads[address] == 0 && ramWrites[address] != 0)
+				fprintf(output, " $%02X", address);
+		}
+		fprintf(output, "\n");
+	}
+
+	// hottest ram
+	std::vector<uint32_t> addresses;
+	for (uint32_t address = 0; address < 0x800; address++)
+	{
+		if (ramReads[address] + ramWrites[address] > 0)
+			addresses.push_back(address);
+	}
+
+	uint32_t numAddresses = std::min<uint32_t>(16, (uint32_t)addresses.size());
+	std::partial_sort(addresses.begin(), addresses.begin() + numAddresses, addresses.end(),
+		[&](uint32_t a, uint32_t b) { return ramReads[a] + ramWrites[a] > ramReads[b] + ramWrites[b]; });
+
+	fprintf(output, "\nram     reads/frame   writes/frame\n");
+	for (uint32_t i = 0; i < numAddresses; i++)
+	{
+		uint32_t address = addresses[i];
+		fprintf(output, "$%04X   %-12.1f  %-12.1f\n", address, ramReads[address] / frames, ramWrites[address] / frames);
+	}
+
+	// io registers, ppu registers folded over their mirrors. many reads per frame of the same
+	// register usually means the rom is spinning on it
+	fprintf(output, "\nio      reads/frame   writes/frame\n");
+	for (uint32_t address = 0x2000; address < 0x4020; address++)
+	{
+		if (address >= 0x2008 && address < 0x4000)
+			continue;
+
+		uint64_t reads = 0, writes = 0;
+		for (uint32_t mirror = address; mirror < (address < 0x2008 ? 0x4000u : address + 1); mirror += 8)
+		{
+			reads += GetTotalAccesses(HEATMAP_CPU_READ, (uint16_t)mirror);
+			writes += GetTotalAccesses(HEATMAP_CPU_WRITE, (uint16_t)mirror);
+		}
+
+		if (reads + writes > 0)
+			fprintf(output, "$%04X   %-12.1f  %-12.1f\n", address, reads / frames, writes / frames);
+	}
+}
+
+uint8_t NesHeatmap::CountRead(void *context, uint16_t address)
+{
+	NesHeatmap *heatmap = (NesHeatmap *)context;
+	const NesCpuBus::PageMapping &page = heatmap->m_originalPages[address >> 8];
+
+	heatmap->Count(HEATMAP_CPU_READ, address);
+	return page.read != nullptr ? page.read[address & 0xFF] : page.readHandler(page.context, address);
+}
+
+void NesHeatmap::CountWrite(void *context, uint16_t address, uint8_t value)
+{
+	NesHeatmap *heatmap = (NesHeatmap *)context;
+	const NesCpuBus::PageMapping &page = heatmap->m_originalPages[address >> 8];
+
+	heatmap->Count(HEATMAP_CPU_WRITE, address);
+	if (page.write != nullptr)
+		page.write[address & 0xFF] = value;
+	else
+		page.writeHandler(page.context, address, value);
+}
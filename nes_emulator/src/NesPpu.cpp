@@ -0,0 +1,449 @@
+#include "NesPpu.h"
+#include "NesHeatmap.h"
+#include <string.h>
+
+static const uint32_t VisibleScanlines = 240;
+static const uint32_t ScanlineEndDot = 257;
+
+// frame positions in dots for a region
+template<typename Region>
+struct NesPpuTiming
+{
+	static const uint32_t VBlankStartDot = Region::VBlankScanline * NesPpu::DotsPerScanline + 1;
+	static const uint32_t VBlankEndDot = Region::PreRenderScanline * NesPpu::DotsPerScanline + 1;
+	static const uint32_t FrameDots = Region::ScanlinesPerFrame * NesPpu::DotsPerScanline;
+	static const uint32_t VerticalReloadDot = Region::PreRenderScanline * NesPpu::DotsPerScanline + 304;
+};
+
+NesPpu::NesPpu()
+{
+	memset(&m_chrRam, 0, sizeof(m_chrRam));
+	m_chr = m_chrRam.data;
+	m_chrWritable = true;
+	Reset();
+}
+
+NesPpu::~NesPpu()
+{
+
+}
+
+void NesPpu::SetChrData(const VRomBankMem *chrBanks, uint8_t numChrBanks, bool verticalMirroring)
+{
+	// only the first 8kb is visible until mappers are supported
+	m_chr = numChrBanks > 0 ? chrBanks[0].data : m_chrRam.data;
+	m_chrWritable = numChrBanks == 0;
+	m_verticalMirroring = verticalMirroring;
+}
+
+void NesPpu::Reset()
+{
+	m_control = 0;
+	m_mask = 0;
+	m_status = 0;
+	m_oamAddress = 0;
+	m_readBuffer = 0;
+	m_openBus = 0;
+	m_vramAddress = 0;
+	m_tempAddress = 0;
+	m_fineX = 0;
+	m_writeLatch = false;
+	m_nmiPending = false;
+
+	m_frameDot = 0;
+	m_frameCount = 0;
+	m_frameComplete = false;
+
+	memset(&m_nametables, 0, sizeof(m_nametables));
+	memset(&m_palette, 0, sizeof(m_palette));
+	memset(&m_oam, 0, sizeof(m_oam));
+}
+
+template<typename Region>
+void NesPpu::Step(uint32_t dots)
+{
+	typedef NesPpuTiming<Region> Timing;
+
+	uint32_t previous = m_frameDot;
+	m_frameDot += dots;
+
+	if ((m_mask & 0x18) || m_frame != nullptr)
+		RunScanlines<Region>(previous, m_frameDot < Timing::FrameDots ? m_frameDot : Timing::FrameDots);
+
+	// sprite 0 hit is approximated at the top left pixel of sprite 0, when rendering is on
+	uint32_t sprite0Dot = (m_oam.data[0] + 1u) * DotsPerScanline + m_oam.data[3] + 1u;
+	if (previous < sprite0Dot && m_frameDot >= sprite0Dot && m_oam.data[0] < 239 && (m_mask & 0x18) == 0x18)
+		m_status |= 0x40;
+
+	if (previous < Timing::VBlankStartDot && m_frameDot >= Timing::VBlankStartDot)
+	{
+		m_status |= 0x80;
+		if (m_control & 0x80)
+			m_nmiPending = true;
+	}
+
+	// vblank, sprite 0 and overflow flags are cleared on the pre-render line
+	if (previous < Timing::VBlankEndDot && m_frameDot >= Timing::VBlankEndDot)
+		m_status &= 0x1F;
+
+	if (m_frameDot >= Timing::FrameDots)
+	{
+		m_frameDot -= Timing::FrameDots;
+		m_frameCount++;
+		m_frameComplete = true;
+
+		if (m_frame != nullptr)
+			m_frame->number = m_frameCount;
+
+		// a long step (OAM DMA) can run into the next frame's first lines
+		if ((m_mask & 0x18) || m_frame != nullptr)
+			RunScanlines<Region>(0, m_frameDot);
+	}
+}
+
+template<typename Region>
+void NesPpu::RunScanlines(uint32_t from, uint32_t to)
+{
+	typedef NesPpuTiming<Region> Timing;
+
+	// visible lines are rendered as the ppu passes dot 257, the end of their pixels
+	uint32_t line = from < ScanlineEndDot ? 0 : (from - ScanlineEndDot) / DotsPerScanline + 1;
+	for (; line < VisibleScanlines && line * DotsPerScanline + ScanlineEndDot <= to; line++)
+		RenderScanline(line);
+
+	// the pre-render line reloads the vertical scroll for the next frame
+	if ((m_mask & 0x18) && from < Timing::VerticalReloadDot && to >= Timing::VerticalReloadDot)
+		m_vramAddress = (uint16_t)((m_vramAddress & 0x841F) | (m_tempAddress & 0x7BE0));
+}
+
+void NesPpu::RenderScanline(uint32_t line)
+{
+	if (m_frame != nullptr)
+		DrawScanline(line);
+
+	if (!(m_mask & 0x18))
+		return;
+
+	// fine y, then coarse y, wrapping at row 30 into the other vertical nametable
+	uint16_t v = m_vramAddress;
+	if ((v & 0x7000) != 0x7000)
+		v += 0x1000;
+	else
+	{
+		v &= ~0x7000;
+		uint16_t coarseY = (v >> 5) & 0x1F;
+		if (coarseY == 29)
+		{
+			coarseY = 0;
+			v ^= 0x0800;
+		}
+		else if (coarseY == 31)
+			coarseY = 0;
+		else
+			coarseY++;
+		v = (uint16_t)((v & ~0x03E0) | (coarseY << 5));
+	}
+
+	// horizontal scroll is reloaded from t for the next line
+	m_vramAddress = (uint16_t)((v & ~0x041F) | (m_tempAddress & 0x041F));
+}
+
+void NesPpu::DrawScanline(uint32_t line)
+{
+	uint8_t *output = m_frame->pixels + line * NesFrame::Width;
+	uint8_t colourMask = (m_mask & 0x01) ? 0x30 : 0x3F;
+
+	if (!(m_mask & 0x18))
+	{
+		memset(output, ReadPalette(0) & colourMask, NesFrame::Width);
+		return;
+	}
+
+	// background, 33 tiles to cover the fine x scroll. 2 bit colour in the low bits, palette above
+	uint8_t background[NesFrame::Width];
+	memset(background, 0, sizeof(background));
+
+	if (m_mask & 0x08)
+	{
+		uint16_t v = m_vramAddress;
+		uint32_t fineY = (v >> 12) & 7;
+		const uint8_t *patterns = m_chr + ((m_control & 0x10) ? 0x1000 : 0);
+
+		for (uint32_t tile = 0; tile < 33; tile++)
+		{
+			uint8_t tileIndex = m_nametables.data[NametableOffset((uint16_t)(0x2000 | (v & 0x0FFF)))];
+			uint8_t attribute = m_nametables.data[NametableOffset((uint16_t)(0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07)))];
+			uint8_t palette = (uint8_t)(((attribute >> (((v >> 4) & 4) | (v & 2))) & 3) << 2);
+
+			const uint8_t *pattern = patterns + tileIndex * 16 + fineY;
+			uint8_t lo = pattern[0];
+			uint8_t hi = pattern[8];
+
+			for (uint32_t pixel = 0; pixel < 8; pixel++)
+			{
+				int x = (int)(tile * 8 + pixel) - m_fineX;
+				if (x < 0 || x >= (int)NesFrame::Width)
+					continue;
+
+				uint8_t colour = (uint8_t)(((lo >> (7 - pixel)) & 1) | (((hi >> (7 - pixel)) & 1) << 1));
+				background[x] = colour != 0 ? (uint8_t)(palette | colour) : 0;
+			}
+
+			// coarse x, wrapping into the other horizontal nametable
+			if ((v & 0x001F) == 31)
+				v = (uint16_t)((v & ~0x001F) ^ 0x0400);
+			else
+				v++;
+		}
+
+		if (!(m_mask & 0x02))
+			memset(background, 0, 8);
+	}
+
+	// sprites, the first 8 on the line in oam order. Earlier sprites are in front of later ones
+	uint8_t sprites[NesFrame::Width];
+	uint8_t behind[NesFrame::Width];
+	memset(sprites, 0, sizeof(sprites));
+
+	if (m_mask & 0x10)
+	{
+		uint32_t height = (m_control & 0x20) ? 16 : 8;
+		uint32_t found = 0;
+
+		for (uint32_t i = 0; i < 64 && found < 8; i++)
+		{
+			const uint8_t *sprite = m_oam.data + i * 4;
+			uint32_t row = line - (sprite[0] + 1u);
+			if (row >= height)
+				continue;
+			found++;
+
+			uint8_t attributes = sprite[2];
+			if (attributes & 0x80)
+				row = height - 1 - row;
+
+			uint32_t tileIndex = sprite[1];
+			uint32_t table = (m_control & 0x08) ? 0x1000 : 0;
+			if (height == 16)
+			{
+				table = (tileIndex & 1) ? 0x1000 : 0;
+				tileIndex = (tileIndex & 0xFE) + (row >> 3);
+				row &= 7;
+			}
+
+			const uint8_t *pattern = m_chr + table + tileIndex * 16 + row;
+			uint8_t lo = pattern[0];
+			uint8_t hi = pattern[8];
+			uint8_t palette = (uint8_t)(0x10 | ((attributes & 3) << 2));
+
+			for (uint32_t pixel = 0; pixel < 8; pixel++)
+			{
+				uint32_t x = sprite[3] + pixel;
+				if (x >= NesFrame::Width || sprites[x] != 0)
+					continue;
+
+				uint32_t bit = (attributes & 0x40) ? pixel : 7 - pixel;
+				uint8_t colour = (uint8_t)(((lo >> bit) & 1) | (((hi >> bit) & 1) << 1));
+				if (colour != 0)
+				{
+					sprites[x] = (uint8_t)(palette | colour);
+					behind[x] = attributes & 0x20;
+				}
+			}
+		}
+
+		if (!(m_mask & 0x04))
+			memset(sprites, 0, 8);
+	}
+
+	for (uint32_t x = 0; x < NesFrame::Width; x++)
+	{
+		uint8_t index = background[x];
+		if (sprites[x] != 0 && (index == 0 || !behind[x]))
+			index = sprites[x];
+		output[x] = ReadPalette(index) & colourMask;
+	}
+}
+
+uint8_t NesPpu::ReadRegister(uint16_t address)
+{
+	switch (address & 7)
+	{
+	case 2:		// PPUSTATUS, reading clears vblank and the $2005 / $2006 write latch
+		m_openBus = (uint8_t)((m_status & 0xE0) | (m_openBus & 0x1F));
+		m_status &= 0x7F;
+		m_writeLatch = false;
+		break;
+
+	case 4:		// OAMDATA
+		m_openBus = m_oam.data[m_oamAddress];
+		break;
+
+	case 7:		// PPUDATA
+		if ((m_vramAddress & 0x3FFF) < 0x3F00)
+		{
+			m_openBus = m_readBuffer;
+			m_readBuffer = ReadVram(m_vramAddress);
+		}
+		else
+		{
+			// palette reads are not buffered, the buffer gets the nametable byte underneath
+			m_openBus = ReadVram(m_vramAddress);
+			m_readBuffer = ReadVram((uint16_t)(m_vramAddress - 0x1000));
+		}
+		m_vramAddress = (uint16_t)(m_vramAddress + ((m_control & 0x04) ? 32 : 1));
+		break;
+
+	default:	// write only registers return whatever was last on the ppu bus
+		break;
+	}
+
+	return m_openBus;
+}
+
+void NesPpu::WriteRegister(uint16_t address, uint8_t value)
+{
+	m_openBus = value;
+
+	switch (address & 7)
+	{
+	case 0:		// PPUCTRL
+		// enabling NMI during vblank raises it straight away
+		if (!(m_control & 0x80) && (value & 0x80) && (m_status & 0x80))
+			m_nmiPending = true;
+		m_control = value;
+		m_tempAddress = (uint16_t)((m_tempAddress & 0xF3FF) | ((value & 0x03) << 10));
+		break;
+
+	case 1:		// PPUMASK
+		m_mask = value;
+		break;
+
+	case 3:		// OAMADDR
+		m_oamAddress = value;
+		break;
+
+	case 4:		// OAMDATA
+		m_oam.data[m_oamAddress++] = value;
+		break;
+
+	case 5:		// PPUSCROLL
+		if (!m_writeLatch)
+		{
+			m_tempAddress = (uint16_t)((m_tempAddress & 0xFFE0) | (value >> 3));
+			m_fineX = value & 0x07;
+		}
+		else
+		{
+			m_tempAddress = (uint16_t)((m_tempAddress & 0x8C1F) | ((value & 0x07) << 12) | ((value & 0xF8) << 2));
+		}
+		m_writeLatch = !m_writeLatch;
+		break;
+
+	case 6:		// PPUADDR
+		if (!m_writeLatch)
+		{
+			m_tempAddress = (uint16_t)((m_tempAddress & 0x00FF) | ((value & 0x3F) << 8));
+		}
+		else
+		{
+			m_tempAddress = (uint16_t)((m_tempAddress & 0xFF00) | value);
+			m_vramAddress = m_tempAddress;
+		}
+		m_writeLatch = !m_writeLatch;
+		break;
+
+	case 7:		// PPUDATA
+		WriteVram(m_vramAddress, value);
+		m_vramAddress = (uint16_t)(m_vramAddress + ((m_control & 0x04) ? 32 : 1));
+		break;
+
+	default:	// PPUSTATUS is read only
+		break;
+	}
+}
+
+void NesPpu::WriteOam(const uint8_t *data)
+{
+	for (int i = 0; i < 256; i++)
+		m_oam.data[(uint8_t)(m_oamAddress + i)] = data[i];
+}
+
+void NesPpu::HashState(NesStateHasher &hasher) const
+{
+	hasher.Add(((uint64_t)m_control << 56) | ((uint64_t)m_mask << 48) | ((uint64_t)m_status << 40) | ((uint64_t)m_oamAddress << 32) |
+		((uint64_t)m_readBuffer << 24) | ((uint64_t)m_openBus << 16) | ((uint64_t)m_fineX << 8) | ((uint64_t)m_writeLatch << 1) | m_nmiPending);
+	hasher.Add(((uint64_t)m_vramAddress << 48) | ((uint64_t)m_tempAddress << 32) | m_frameDot);
+	hasher.Add(m_frameCount);
+
+	if (m_chrWritable)
+		hasher.Add(m_chrRam.data, sizeof(m_chrRam));
+	hasher.Add(m_nametables.data, sizeof(m_nametables));
+	hasher.Add(m_palette.data, sizeof(m_palette));
+	hasher.Add(m_oam.data, sizeof(m_oam));
+}
+
+uint8_t NesPpu::ReadVram(uint16_t address)
+{
+	address &= 0x3FFF;
+
+	if (m_heatmap != nullptr)
+		m_heatmap->CountPpuRead(address);
+
+	if (address < 0x2000)
+		return m_chr[address];
+
+	if (address < 0x3F00)
+		return m_nametables.data[NametableOffset(address)];
+
+	return ReadPalette(address);
+}
+
+void NesPpu::WriteVram(uint16_t address, uint8_t value)
+{
+	address &= 0x3FFF;
+
+	if (m_heatmap != nullptr)
+		m_heatmap->CountPpuWrite(address);
+
+	if (address < 0x2000)
+	{
+		if (m_chrWritable)
+			m_chrRam.data[address] = value;
+		return;
+	}
+
+	if (address < 0x3F00)
+	{
+		m_nametables.data[NametableOffset(address)] = value;
+		return;
+	}
+
+	uint16_t index = address & 0x1F;
+	if ((index & 0x13) == 0x10)
+		index &= 0x0F;
+	m_palette.data[index] = value & 0x3F;
+}
+
+uint8_t NesPpu::ReadPalette(uint32_t index) const
+{
+	// $3F10 / $3F14 / $3F18 / $3F1C mirror the background entries
+	index &= 0x1F;
+	if ((index & 0x13) == 0x10)
+		index &= 0x0F;
+	return m_palette.data[index];
+}
+
+uint16_t NesPpu::NametableOffset(uint16_t address) const
+{
+	// 4 logical nametables share 2kb of vram
+	//	vertical mirroring:   $2000 = $2800, $2400 = $2C00
+	//	horizontal mirroring: $2000 = $2400, $2800 = $2C00
+	uint16_t table = (address >> 10) & 3;
+	uint16_t physical = m_verticalMirroring ? (table & 1) : (table >> 1);
+	return (uint16_t)(physical * 0x400 + (address & 0x3FF));
+}
+
+template void NesPpu::Step<NesRegionNtsc>(uint32_t dots);
+template void NesPpu::Step<NesRegionPal>(uint32_t dots);
+template void NesPpu::Step<NesRegionDendy>(uint32_t dots);
@@ -1,52 +1,88 @@
 #include "NesRom.h"
 #include <stdio.h>
+#include <string.h>
 #include <stddef.h>     /* offsetof */
-#include <iostream>
 
 NesCartridge::NesCartridge()
 {
-
+	memset(&m_emptyHeader, 0, sizeof(m_emptyHeader));
+	m_data = &m_emptyHeader;
+	m_rawRomData = nullptr;
+	m_rawRomDataLength = 0;
 }
 
 NesCartridge::~NesCartridge()
 {
-
+	delete[] m_fileData;
 }
 
-void NesCartridge::LoadFromFile(const char *filename)
+bool NesCartridge::LoadFromFile(const char *filename)
 {
 	// open file in "read binary" mode
 	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
 	
 	// get the size in bytes of the file
 	fseek(file, 0, SEEK_END);
 	long filesize = ftell(file);
 	fseek(file, 0, SEEK_SET);
 
+	if (filesize <= 0)
+	{
+		fclose(file);
+		printf("%s is empty\n", filename);
+		return false;
+	}
+
 	// allocate memory for the file to be loaded into
 	uint8_t *buffer = new uint8_t[filesize];
 	
 	// read the file into memory then close
-	fread(buffer, 1, filesize, file);
+	size_t bytesRead = fread(buffer, 1, filesize, file);
 	fclose(file);
 	
+	// a previously loaded file is released
+	delete[] m_fileData;
+	m_fileData = buffer;
+
 	// continue parsing the file
-	LoadFromBytes(buffer, filesize);
+	if (!LoadFromBytes(buffer, (unsigned int)bytesRead))
+	{
+		printf("%s is not a valid .nes file\n", filename);
+		return false;
+	}
+	return true;
 }
 
-void NesCartridge::LoadFromBytes(uint8_t *data, unsigned int length)
+bool NesCartridge::LoadFromBytes(uint8_t *data, unsigned int length)
 {
 	m_rawRomData = data;
 	m_rawRomDataLength = length;
 
+	m_data = &m_emptyHeader;
+	m_numRomBanks = 0;
+	m_numVRomBanks = 0;
+	trainer = nullptr;
+	ROM_Banks = nullptr;
+	VROM_Banks = nullptr;
+
+	if (data == nullptr || length < sizeof(NesRomFileHeader) || memcmp(data, "NES\x1A", 4) != 0)
+		return false;
+
 	// the first 15 bytes should overlay the data passed in perfectly
 	// the trainer, rom banks and vrom banks vary in number and are set to point
 	// at the approprate location within the data.
-	std::cout << sizeof(NesRomFileHeader) << std::endl;
 	m_data = (NesRomFileHeader *)m_rawRomData;
-	trainer = nullptr;
-	ROM_Banks = nullptr;
-	VROM_Banks = nullptr;
+
+	// the header can claim more than the file holds, nothing past the end may be pointed at
+	size_t requiredSize = sizeof(NesRomFileHeader) + (m_data->trainerBit ? sizeof(TrainerMem) : 0) +
+		m_data->num16kbRomBanks * sizeof(RomBankMem) + m_data->num8kbVRomBanks * sizeof(VRomBankMem);
+	if (length < requiredSize)
+		return false;
 
 	// address to the 16th byte
 	uint8_t *nextMemoryLoc = (m_rawRomData + 16);
@@ -62,4 +98,8 @@ void NesCartridge::LoadFromBytes(uint8_t *data, unsigned int length)
 
 	VROM_Banks = (VRomBankMem *)nextMemoryLoc;
 	nextMemoryLoc = (uint8_t *)(VROM_Banks + m_data->num8kbVRomBanks);
+
+	m_numRomBanks = m_data->num16kbRomBanks;
+	m_numVRomBanks = m_data->num8kbVRomBanks;
+	return true;
 }
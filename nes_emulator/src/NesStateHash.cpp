@@ -0,0 +1,92 @@
+#include "NesStateHash.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+NesStateHashLog::NesStateHashLog()
+{
+
+}
+
+NesStateHashLog::~NesStateHashLog()
+{
+
+}
+
+void NesStateHashLog::Reset(uint32_t instructionInterval)
+{
+	m_entries.clear();
+	m_instructionInterval = instructionInterval;
+}
+
+bool NesStateHashLog::Save(const char *filename) const
+{
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+
+	StateHashFileHeader header;
+	memcpy(header.magic, "NSHS", 4);
+	header.version = HashLogVersion;
+	header.instructionInterval = m_instructionInterval;
+	header.numEntries = (uint32_t)m_entries.size();
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (!m_entries.empty())
+		ok = ok && fwrite(m_entries.data(), sizeof(StateHashEntry), m_entries.size(), file) == m_entries.size();
+
+	if (fclose(file) != 0)
+		ok = false;
+	return ok;
+}
+
+bool NesStateHashLog::Load(const char *filename)
+{
+	m_entries.clear();
+
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s\n", filename);
+		return false;
+	}
+
+	StateHashFileHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "NSHS", 4) != 0 || header.version != HashLogVersion)
+	{
+		printf("%s is not a state hash file, or was written by a different version\n", filename);
+		fclose(file);
+		return false;
+	}
+
+	m_instructionInterval = header.instructionInterval;
+	m_entries.resize(header.numEntries);
+	size_t entriesRead = header.numEntries > 0 ? fread(m_entries.data(), sizeof(StateHashEntry), header.numEntries, file) : 0;
+	fclose(file);
+
+	if (entriesRead != header.numEntries)
+	{
+		printf("%s is truncated\n", filename);
+		m_entries.clear();
+		return false;
+	}
+
+	return true;
+}
+
+size_t NesStateHashLog::FindDivergence(const NesStateHashLog &a, const NesStateHashLog &b)
+{
+	// the hashes are chained, so entries match up to the divergence and differ after it
+	size_t low = 0;
+	size_t high = std::min(a.m_entries.size(), b.m_entries.size());
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		if (a.m_entries[middle].hash == b.m_entries[middle].hash)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
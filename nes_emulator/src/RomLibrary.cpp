@@ -0,0 +1,247 @@
+#include "RomLibrary.h"
+#include "NesRom.h"
+#include "MappedFile.h"
+#include "Crc32.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static bool HasNesExtension(const fs::path &path)
+{
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+	return ext == ".nes";
+}
+
+
+RomLibraryScanner::RomLibraryScanner()
+{
+
+}
+
+RomLibraryScanner::~RomLibraryScanner()
+{
+
+}
+
+bool RomLibraryScanner::Scan(const char *directory, const char *indexFilename, unsigned int numThreads)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	m_items.clear();
+	m_stats = RomLibraryStats();
+
+	// walk the directory tree, only the size and modified time are read here
+	std::error_code ec;
+	for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end; it != end; it.increment(ec))
+	{
+		if (ec)
+			break;
+
+		if (!it->is_regular_file(ec) || !HasNesExtension(it->path()))
+			continue;
+
+		ScanItem item;
+		memset(&item.entry, 0, sizeof(item.entry));
+		item.path = it->path().generic_string();
+		item.entry.fileSize = it->file_size(ec);
+		item.entry.modifiedTime = (int64_t)it->last_write_time(ec).time_since_epoch().count();
+		item.needsScan = true;
+		m_items.push_back(item);
+	}
+
+	if (ec)
+	{
+		printf("failed to scan %s: %s\n", directory, ec.message().c_str());
+		return false;
+	}
+
+	std::sort(m_items.begin(), m_items.end(), [](const ScanItem &a, const ScanItem &b) { return a.path < b.path; });
+	m_stats.filesFound = (uint32_t)m_items.size();
+
+	// reuse entries from the previous index for files that have not changed.
+	// the entries are sorted by path so each lookup is a binary search on the mapped file
+	{
+		MappedFile previous;
+		if (previous.Open(indexFilename) && previous.GetSize() >= sizeof(RomIndexFileHeader))
+		{
+			const RomIndexFileHeader *header = (const RomIndexFileHeader *)previous.GetData();
+			size_t entriesSize = (size_t)header->numEntries * sizeof(RomIndexEntry);
+			bool valid = memcmp(header->magic, "NIDX", 4) == 0 && header->version == IndexVersion &&
+				sizeof(RomIndexFileHeader) + entriesSize + header->stringTableSize <= previous.GetSize();
+
+			if (valid)
+			{
+				const RomIndexEntry *entries = (const RomIndexEntry *)(header + 1);
+				const char *strings = (const char *)(entries + header->numEntries);
+
+				auto pathOf = [&](const RomIndexEntry &e) {
+					if ((size_t)e.pathOffset + e.pathLength > header->stringTableSize)
+						return std::string_view();
+					return std::string_view(strings + e.pathOffset, e.pathLength);
+				};
+
+				for (ScanItem &item : m_items)
+				{
+					const RomIndexEntry *found = std::lower_bound(entries, entries + header->numEntries, item.path,
+						[&](const RomIndexEntry &e, const std::string &path) { return pathOf(e) < std::string_view(path); });
+
+					if (found == entries + header->numEntries || pathOf(*found) != item.path)
+						continue;
+
+					if (found->fileSize == item.entry.fileSize && found->modifiedTime == item.entry.modifiedTime)
+					{
+						item.entry = *found;
+						item.needsScan = false;
+						m_stats.filesReused++;
+					}
+				}
+			}
+		}
+	}
+
+	// parse the changed files in parallel, each thread pulls the next item from a shared counter
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::atomic<size_t> nextItem(0);
+	std::atomic<uint64_t> bytesHashed(0);
+
+	auto worker = [&]() {
+		std::vector<uint8_t> buffer;
+		for (size_t i = nextItem++; i < m_items.size(); i = nextItem++)
+		{
+			if (!m_items[i].needsScan)
+				continue;
+
+			ScanFile(m_items[i], buffer);
+			bytesHashed += buffer.size();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < numThreads; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread &t : threads)
+		t.join();
+
+	for (const ScanItem &item : m_items)
+	{
+		if (item.needsScan)
+			m_stats.filesScanned++;
+		if (item.entry.flags & ROM_INDEX_INVALID)
+			m_stats.filesInvalid++;
+	}
+	m_stats.bytesHashed = bytesHashed;
+
+	bool result = WriteIndex(indexFilename);
+
+	m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return result;
+}
+
+void RomLibraryScanner::ScanFile(ScanItem &item, std::vector<uint8_t> &buffer)
+{
+	RomIndexEntry &entry = item.entry;
+	entry.flags = ROM_INDEX_INVALID;
+	buffer.clear();
+
+	FILE *file = fopen(item.path.c_str(), "rb");
+	if (file == nullptr)
+		return;
+
+	buffer.resize((size_t)entry.fileSize);
+	size_t bytesRead = fread(buffer.data(), 1, buffer.size(), file);
+	fclose(file);
+	buffer.resize(bytesRead);
+
+	if (bytesRead < sizeof(NesRomFileHeader) || memcmp(buffer.data(), "NES\x1A", 4) != 0)
+		return;
+
+	// header fields are read through the same path the emulator uses
+	NesCartridge cartridge;
+	cartridge.LoadFromBytes(buffer.data(), (unsigned int)buffer.size());
+	const NesRomFileHeader *header = cartridge.GetHeader();
+
+	entry.mapperType = cartridge.GetMapperType();
+	// truncated files fail to load but their header is still indexed
+	entry.num16kbRomBanks = header->num16kbRomBanks;
+	entry.num8kbVRomBanks = header->num8kbVRomBanks;
+	entry.flags = 0;
+	if (header->isPALVideoMode)			entry.flags |= ROM_INDEX_PAL;
+	if (header->mirroringModeBit)		entry.flags |= ROM_INDEX_VERTICAL_MIRROR;
+	if (header->batteryBackedRamBit)	entry.flags |= ROM_INDEX_BATTERY;
+	if (header->trainerBit)				entry.flags |= ROM_INDEX_TRAINER;
+	if (header->vramLayoutBit)			entry.flags |= ROM_INDEX_FOUR_SCREEN;
+
+	size_t expectedSize = sizeof(NesRomFileHeader) +
+		(header->trainerBit ? sizeof(TrainerMem) : 0) +
+		entry.num16kbRomBanks * sizeof(RomBankMem) +
+		entry.num8kbVRomBanks * sizeof(VRomBankMem);
+
+	if (bytesRead < expectedSize)
+		entry.flags |= ROM_INDEX_INVALID;
+
+	entry.crc32 = Crc32(buffer.data() + sizeof(NesRomFileHeader), bytesRead - sizeof(NesRomFileHeader));
+}
+
+bool RomLibraryScanner::WriteIndex(const char *indexFilename)
+{
+	std::vector<RomIndexEntry> entries;
+	std::string strings;
+	entries.reserve(m_items.size());
+
+	for (ScanItem &item : m_items)
+	{
+		RomIndexEntry entry = item.entry;
+		entry.pathOffset = (uint32_t)strings.size();
+		entry.pathLength = (uint16_t)std::min<size_t>(item.path.size(), 0xFFFF);
+		strings.append(item.path, 0, entry.pathLength);
+		entries.push_back(entry);
+	}
+
+	RomIndexFileHeader header;
+	memcpy(header.magic, "NIDX", 4);
+	header.version = IndexVersion;
+	header.numEntries = (uint32_t)entries.size();
+	header.stringTableSize = (uint32_t)strings.size();
+
+	// write to a temporary file first so an interrupted scan never leaves a broken index behind
+	std::string tempFilename = std::string(indexFilename) + ".tmp";
+	FILE *file = fopen(tempFilename.c_str(), "wb");
+	if (file == nullptr)
+	{
+		printf("failed to open %s for writing\n", tempFilename.c_str());
+		return false;
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (!entries.empty())
+		ok = ok && fwrite(entries.data(), sizeof(RomIndexEntry), entries.size(), file) == entries.size();
+	if (!strings.empty())
+		ok = ok && fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+	ok = (fclose(file) == 0) && ok;
+
+	std::error_code ec;
+	if (ok)
+		fs::rename(tempFilename, indexFilename, ec);
+
+	if (!ok || ec)
+	{
+		printf("failed to write %s\n", indexFilename);
+		fs::remove(tempFilename, ec);
+		return false;
+	}
+
+	return true;
+}
@@ -1,33 +1,216 @@
 
 #include <iostream>
 #include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
 
 #include "NesRom.h"
 #include "Mos6502CPU.h"
+#include "RomLibrary.h"
+#include "Mos6502CodeAnalyzer.h"
+#include "Mos6502Disassembler.h"
+#include "Mos6502XRef.h"
+#include "Crc32.h"
+#include "Mos6502Profiler.h"
+#include "Mos6502CallStackProfiler.h"
+#include "NesConsole.h"
+#include "Cc65DebugInfo.h"
+#include "Cc65SourceProfile.h"
+#include "Mos6502Tracer.h"
+#include "NesStateHash.h"
+#include "NesDebugger.h"
+#include "NesHeatmap.h"
+#include "Mos6502TestRunner.h"
+#include "NesEmulationThread.h"
+#include "NesAudio.h"
+#include "NesFramePacer.h"
+#include "NesRegion.h"
+
+#include <chrono>
+#include <algorithm>
+#include <thread>
 
 std::string RomFileFromCmdLineArgs(int argc, char **argv, const char *fallbackFilename);
+const char *CmdLineOption(int argc, char **argv, const char *name, const char *fallback = nullptr);
+bool CmdLineFlag(int argc, char **argv, const char *name);
+std::vector<const char *> CmdLineOptions(int argc, char **argv, const char *name);
+
+int RunLibraryScan(const char *directory, const char *indexFile, unsigned int numThreads);
+void PrintAnalyzedProgram(NesCartridge &rom, FILE *output);
+int RunXRef(NesCartridge &rom, const char *indexFile, const char *address);
+struct RunOptions
+{
+	uint64_t	 numFrames;
+	const char	*profileCsvFile;
+	const char	*callStackFile;		// optional
+	uint32_t	 sampleCycles;
+	const char	*debugInfoFile;
+	const char	*traceFile;			// optional
+	uint64_t	 traceFirstCycle;
+	uint64_t	 traceLastCycle;
+	const char	*hashFile;			// optional
+	uint32_t	 hashInterval;
+	std::vector<const char *> breakpoints;
+	std::vector<const char *> watchpoints;
+	bool		 breakContinue;
+	const char	*heatmapFile;		// optional, file name prefix
+	const char	*presentFile;		// optional
+	uint32_t	 presentDelayMs;
+	const char	*audioFile;			// optional, "null" for no output
+	uint32_t	 audioRate;
+	uint32_t	 audioLatencyMs;
+	NesPacingMode pacing;
+	uint32_t	 frameskip;
+	NesRegionId	 region;
+};
+
+int RunProgram(NesCartridge &rom, const RunOptions &options);
+template<typename Region>
+int RunConsole(NesCartridge &rom, const RunOptions &options);
+int ExportTrace(const char *traceFile, const char *logFile);
+bool AddDebugPoints(NesDebugger &debugger, const RunOptions &options);
+template<typename Region>
+void PrintDebugHit(NesConsoleT<Region> &console, NesDebugger &debugger);
+int RunCpuTest(int argc, char **argv, const char *testFile);
+int BisectStateHashes(const char *hashFileA, const char *hashFileB);
+int DiffTraces(const char *traceFileA, const char *traceFileB);
 
 //=============================================================================
 // Program Entry point
 //=============================================================================
 int main(int argc, char **argv)
 {
+	// --scan-library <directory> [--index <file>] [--threads <n>]
+	// builds or refreshes the rom library index then exits
+	if (const char *libraryDir = CmdLineOption(argc, argv, "--scan-library"))
+	{
+		const char *indexFile = CmdLineOption(argc, argv, "--index", "roms.idx");
+		unsigned int numThreads = (unsigned int)atoi(CmdLineOption(argc, argv, "--threads", "0"));
+		return RunLibraryScan(libraryDir, indexFile, numThreads);
+	}
+
+	// --trace-export <trace file> [--out <file>]
+	// converts a binary trace recorded with --trace to nestest.log text
+	if (const char *traceFile = CmdLineOption(argc, argv, "--trace-export"))
+		return ExportTrace(traceFile, CmdLineOption(argc, argv, "--out"));
+
+	// --hash-bisect <hash file> --with <hash file>
+	// finds the first frame (or instruction interval) where two runs recorded with --hashes diverge
+	if (const char *hashFile = CmdLineOption(argc, argv, "--hash-bisect"))
+		return BisectStateHashes(hashFile, CmdLineOption(argc, argv, "--with", ""));
+
+	// --trace-diff <trace file> --with <trace file>
+	// prints the first instruction that differs between two traces
+	if (const char *traceFile = CmdLineOption(argc, argv, "--trace-diff"))
+		return DiffTraces(traceFile, CmdLineOption(argc, argv, "--with", ""));
+
+	// --cpu-test <.bin or .nes> [--golden <nestest.log>] [--start <pc>] [--success <pc>] [--load <address>] [--max-instructions <n>]
+	//		[--decimal]
+	// runs a cpu conformance test headless at full speed and reports pass / fail, returns 0 on a pass.
+	// flat binaries pass by trapping at --success, .nes roms by matching the golden log.
+	// --decimal runs flat binaries on an NMOS 6502 with decimal mode instead of the 2A03
+	if (const char *testFile = CmdLineOption(argc, argv, "--cpu-test"))
+		return RunCpuTest(argc, argv, testFile);
+
 	// detect rom to load from command line arguments
 	// or use default filename
 	std::string romFile = RomFileFromCmdLineArgs(argc, argv, "assets\\roms\\helloWorld\\hello.nes");
 
 	// load rom carterage from file
 	NesCartridge rom;
-	rom.LoadFromFile(romFile.c_str());
+	if (!rom.LoadFromFile(romFile.c_str()))
+		return 1;
 
 	// Load CPU
 	Mos6502CPU cpu;
 	cpu.SetRomData(rom.GetRomBanks(), rom.GetRomBankCount());
 
-	// Print CPU Instructions to console window.
-	cpu.PrintProgram();
+	// --xref <index file> [--who <address>]
+	// builds (or reuses) the cross reference index and optionally lists the references to an address
+	if (const char *xrefFile = CmdLineOption(argc, argv, "--xref"))
+		return RunXRef(rom, xrefFile, CmdLineOption(argc, argv, "--who"));
+
+	// --run <frames> [--callstack <file> [--sample-cycles <n>]] [--dbg <file>]
+	//		[--trace <file> [--trace-from <cycle>] [--trace-to <cycle>]] [--hashes <file> [--hash-interval <n>]]
+	//		[--break "<address> [if <condition>]"]... [--watch "<r|w|rw> <address>[-<address>] [if <condition>]"]... [--break-continue]
+	//		[--heatmap <prefix>] [--present <file.ppm> [--present-delay <ms>]]
+	//		[--audio <file.wav | null> [--audio-rate <hz>] [--audio-latency <ms>]]
+	//		[--pace <realtime | unthrottled | turbo> [--frameskip <n>]] [--region <ntsc | pal | dendy>]
+	// executes the rom from its reset vector for the given number of frames,
+	// --callstack samples the guest call stack every n cpu cycles into a folded stack file,
+	// --trace records every instruction (optionally only a window of cycles) into a compressed binary trace,
+	// --hashes records a state hash every frame and optionally every n instructions,
+	// --break / --watch stop at the first hit and print it, or log every hit with --break-continue,
+	// --heatmap counts every memory access and writes <prefix>.bin, <prefix>-cpu.ppm and <prefix>-ppu.ppm,
+	// --present emulates on a separate thread and writes every frame it picks up to a ppm, taking at least
+	// --present-delay ms per frame to stand in for a slow display,
+	// --audio records the apu output into a wav file at any speed, or plays it nowhere at the pace of a sound card, reporting underruns and latency,
+	// --pace runs at the rom's frame rate (the default with --audio), as fast as possible (the default otherwise),
+	// or as fast as possible drawing only every (frameskip + 1)th frame.
+	// --region overrides the console timing, by default NTSC or PAL from the rom header.
+	// ld65 debug info is picked up from next to the rom (hello.nes -> hello.dbg) unless --dbg is given
+	if (const char *frames = CmdLineOption(argc, argv, "--run"))
+	{
+		std::string debugInfoFile = romFile.substr(0, romFile.length() - 4) + ".dbg";
+
+		RunOptions options;
+		options.numFrames = strtoull(frames, nullptr, 10);
+		options.profileCsvFile = CmdLineOption(argc, argv, "--profile-csv", "cpu_profile.csv");
+		options.callStackFile = CmdLineOption(argc, argv, "--callstack");
+		options.sampleCycles = (uint32_t)strtoul(CmdLineOption(argc, argv, "--sample-cycles", "1000"), nullptr, 10);
+		options.debugInfoFile = CmdLineOption(argc, argv, "--dbg", debugInfoFile.c_str());
+		options.traceFile = CmdLineOption(argc, argv, "--trace");
+		options.traceFirstCycle = strtoull(CmdLineOption(argc, argv, "--trace-from", "0"), nullptr, 10);
+		options.traceLastCycle = strtoull(CmdLineOption(argc, argv, "--trace-to", "18446744073709551615"), nullptr, 10);
+		options.hashFile = CmdLineOption(argc, argv, "--hashes");
+		options.hashInterval = (uint32_t)strtoul(CmdLineOption(argc, argv, "--hash-interval", "0"), nullptr, 10);
+		options.breakpoints = CmdLineOptions(argc, argv, "--break");
+		options.watchpoints = CmdLineOptions(argc, argv, "--watch");
+		options.breakContinue = CmdLineFlag(argc, argv, "--break-continue");
+		options.heatmapFile = CmdLineOption(argc, argv, "--heatmap");
+		options.presentFile = CmdLineOption(argc, argv, "--present");
+		options.presentDelayMs = (uint32_t)strtoul(CmdLineOption(argc, argv, "--present-delay", "0"), nullptr, 10);
+		options.audioFile = CmdLineOption(argc, argv, "--audio");
+		options.audioRate = (uint32_t)strtoul(CmdLineOption(argc, argv, "--audio-rate", "48000"), nullptr, 10);
+		options.audioLatencyMs = (uint32_t)strtoul(CmdLineOption(argc, argv, "--audio-latency", "30"), nullptr, 10);
+		options.frameskip = (uint32_t)strtoul(CmdLineOption(argc, argv, "--frameskip", "8"), nullptr, 10);
+
+		const char *pacing = CmdLineOption(argc, argv, "--pace", options.audioFile != nullptr ? "realtime" : "unthrottled");
+		if (!NesFramePacer::ParseMode(pacing, options.pacing))
+		{
+			printf("unknown pacing mode %s, expected realtime, unthrottled or turbo\n", pacing);
+			return 1;
+		}
+
+		options.region = rom.GetHeader()->isPALVideoMode ? REGION_PAL : REGION_NTSC;
+		const char *region = CmdLineOption(argc, argv, "--region");
+		if (region != nullptr && !ParseNesRegion(region, options.region))
+		{
+			printf("unknown region %s, expected ntsc, pal or dendy\n", region);
+			return 1;
+		}
+		return RunProgram(rom, options);
+	}
+
+	// Print CPU Instructions to the console window, or to a file with --out <file>
+	const char *listingFile = CmdLineOption(argc, argv, "--out");
+	FILE *output = listingFile != nullptr ? fopen(listingFile, "wb") : stdout;
+	if (output == nullptr)
+	{
+		printf("failed to open %s for writing\n", listingFile);
+		return 1;
+	}
+
+	// --analyze follows the control flow from the vectors to separate code from data
+	if (CmdLineFlag(argc, argv, "--analyze"))
+		PrintAnalyzedProgram(rom, output);
+	else
+		cpu.PrintProgram(output);
+
+	if (output != stdout)
+		fclose(output);
 
-	system("pause");
 	return 0;
 }
 
@@ -45,6 +228,9 @@ std::string RomFileFromCmdLineArgs(int argc, char **argv, const char *fallbackFi
 	{
 		// extract filename and file extension
 		std::string arg = argv[i];
+		if (arg.length() < 4)
+			continue;
+
 		std::string ext = arg.substr(arg.length() - 4, 4);
 
 		// if one of the comandline args has the last 4 characters of .nes
@@ -55,4 +241,627 @@ std::string RomFileFromCmdLineArgs(int argc, char **argv, const char *fallbackFi
 
 	// if we get here, return the fallback filename.
 	return fallbackFilename;
-}
\ No newline at end of file
+}
+
+const char *CmdLineOption(int argc, char **argv, const char *name, const char *fallback)
+{
+	// options are passed as "--name value", returns the value following the name
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], name) == 0)
+			return argv[i + 1];
+	}
+
+	return fallback;
+}
+
+bool CmdLineFlag(int argc, char **argv, const char *name)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+std::vector<const char *> CmdLineOptions(int argc, char **argv, const char *name)
+{
+	// every value of an option that can be given more than once
+	std::vector<const char *> values;
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], name) == 0)
+			values.push_back(argv[++i]);
+	}
+
+	return values;
+}
+
+//=============================================================================
+// Rom library scan
+//=============================================================================
+int RunLibraryScan(const char *directory, const char *indexFile, unsigned int numThreads)
+{
+	RomLibraryScanner scanner;
+	bool ok = scanner.Scan(directory, indexFile, numThreads);
+
+	const RomLibraryStats &stats = scanner.GetStats();
+	printf("%u roms found, %u scanned, %u unchanged, %u invalid\n",
+		stats.filesFound, stats.filesScanned, stats.filesReused, stats.filesInvalid);
+	printf("%.1f MB hashed in %.3f seconds -> %s\n", stats.bytesHashed / (1024.0 * 1024.0), stats.seconds, indexFile);
+
+	return ok ? 0 : 1;
+}
+
+//=============================================================================
+// Code / data analysis
+//=============================================================================
+void PrintAnalyzedProgram(NesCartridge &rom, FILE *output)
+{
+	Mos6502CodeAnalyzer analyzer;
+	analyzer.Analyze(rom.GetRomBanks(), rom.GetRomBankCount());
+
+	Mos6502Disassembler disassembler;
+	disassembler.SetOutput(output);
+	analyzer.WriteListing(disassembler);
+	disassembler.Flush();
+
+	fprintf(stderr, "%u of %u bytes traced as code\n", analyzer.GetCodeByteCount(), analyzer.GetPrgSize());
+}
+
+//=============================================================================
+// Cross references
+//=============================================================================
+int RunXRef(NesCartridge &rom, const char *indexFile, const char *address)
+{
+	const uint8_t *prg = (const uint8_t *)rom.GetRomBanks();
+	uint32_t prgSize = sizeof(RomBankMem) * rom.GetRomBankCount();
+
+	// the saved index is only rebuilt when the prg data has changed
+	Mos6502XRefIndex index;
+	if (!index.Load(indexFile, Crc32(prg, prgSize)))
+	{
+		Mos6502CodeAnalyzer analyzer;
+		analyzer.Analyze(rom.GetRomBanks(), rom.GetRomBankCount());
+		index.Build(analyzer);
+
+		if (!index.Save(indexFile))
+		{
+			printf("failed to write %s\n", indexFile);
+			return 1;
+		}
+		printf("built %s: %u references\n", indexFile, (unsigned int)index.GetCount());
+	}
+
+	if (address == nullptr)
+		return 0;
+
+	// accepts $C123, 0xC123 or C123
+	if (address[0] == '$')
+		address++;
+	uint16_t target = (uint16_t)strtoul(address, nullptr, 16);
+
+	static const char *kindNames[] = { "call", "jump", "branch", "read", "write" };
+
+	auto refs = index.Find(target);
+	printf("%u references to $%04X\n", (unsigned int)(refs.second - refs.first), target);
+	for (const XRefEntry *ref = refs.first; ref != refs.second; ref++)
+	{
+		printf("  $%04X (prg %06X)", ref->sourceAddress, ref->sourcePrgOffset);
+		for (int bit = 0; bit < 5; bit++)
+		{
+			if (ref->kind & (1 << bit))
+				printf(" %s", kindNames[bit]);
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
+
+//=============================================================================
+// Run
+//=============================================================================
+int RunProgram(NesCartridge &rom, const RunOptions &options)
+{
+	// the only place the region is a runtime value, everything below runs on one instantiation
+	switch (options.region)
+	{
+	case REGION_PAL:	return RunConsole<NesRegionPal>(rom, options);
+	case REGION_DENDY:	return RunConsole<NesRegionDendy>(rom, options);
+	default:			return RunConsole<NesRegionNtsc>(rom, options);
+	}
+}
+
+template<typename Region>
+int RunConsole(NesCartridge &rom, const RunOptions &options)
+{
+	NesConsoleT<Region> console;
+	console.LoadCartridge(rom);
+	console.Reset();
+
+	Mos6502CPU &cpu = console.GetCpu();
+
+#if NES_CPU_PROFILER
+	Mos6502Profiler profiler;
+	cpu.SetProfiler(&profiler);
+#endif
+
+	// debug info is optional, without it routines are named by address
+	Cc65DebugInfo debugInfo;
+	FILE *debugInfoExists = fopen(options.debugInfoFile, "rb");
+	if (debugInfoExists != nullptr)
+	{
+		fclose(debugInfoExists);
+		if (debugInfo.Load(options.debugInfoFile))
+			printf("loaded %s\n", options.debugInfoFile);
+	}
+
+	Mos6502CallStackProfiler callStackProfiler;
+	if (options.callStackFile != nullptr)
+	{
+		console.SetCallStackProfiler(&callStackProfiler, options.sampleCycles);
+
+		if (debugInfo.IsLoaded())
+		{
+			callStackProfiler.SetSymbolResolver([](void *context, uint16_t address)
+			{
+				return ((Cc65DebugInfo *)context)->FindSymbol(address);
+			}, &debugInfo);
+		}
+	}
+
+	Mos6502TraceWriter tracer;
+	if (options.traceFile != nullptr)
+	{
+		if (!tracer.Open(options.traceFile))
+			return 1;
+		console.SetTracer(&tracer, options.traceFirstCycle, options.traceLastCycle);
+	}
+
+	NesStateHashLog hashLog;
+	if (options.hashFile != nullptr)
+		console.SetStateHashLog(&hashLog, options.hashInterval);
+
+	NesDebugger debugger;
+	if (!options.breakpoints.empty() || !options.watchpoints.empty())
+	{
+		if (!AddDebugPoints(debugger, options))
+			return 1;
+		console.SetDebugger(&debugger);
+	}
+
+	NesHeatmap heatmap;
+	if (options.heatmapFile != nullptr)
+		console.SetHeatmap(&heatmap);
+
+	NesNullSink nullSink;
+	NesWavSink wavSink(options.audioFile);
+	NesAudioStream audio;
+	if (options.audioFile != nullptr)
+	{
+		NesAudioSink *sink = strcmp(options.audioFile, "null") == 0 ? (NesAudioSink *)&nullSink : &wavSink;
+		console.SetAudioSampleRate(options.audioRate);
+		if (!audio.Start(sink, options.audioRate, options.audioLatencyMs))
+			return 1;
+	}
+
+	NesFramePacer pacer;
+	pacer.Start(options.pacing, Region::FrameRate, options.frameskip);
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	if (options.presentFile != nullptr)
+	{
+		// this thread plays the display, it only ever sees the newest finished frame
+		NesEmulationThreadT<Region> emulation;
+		emulation.Start(console, options.numFrames, &pacer, options.audioFile != nullptr ? &audio : nullptr);
+
+		uint64_t presented = 0;
+		bool writeOk = true;
+		for (;;)
+		{
+			bool finished = emulation.IsFinished();
+
+			const NesFrame *frame;
+			if (emulation.AcquireFrame(frame))
+			{
+				auto presentStart = std::chrono::steady_clock::now();
+				writeOk = WriteFramePpm(*frame, options.presentFile) && writeOk;
+				presented++;
+				std::this_thread::sleep_until(presentStart + std::chrono::milliseconds(options.presentDelayMs));
+			}
+			else if (finished)
+				break;
+			else
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		emulation.Stop();
+		if (debugger.IsBreakPending())
+			PrintDebugHit(console, debugger);
+
+		if (!writeOk)
+		{
+			printf("failed to write %s\n", options.presentFile);
+			return 1;
+		}
+		printf("%llu frames emulated in %.3f seconds, %llu presented, %llu dropped -> %s\n", (unsigned long long)emulation.GetEmulatedFrames(),
+			emulation.GetRunSeconds(), (unsigned long long)presented, (unsigned long long)emulation.GetDroppedFrames(), options.presentFile);
+	}
+	else
+	{
+		// nothing is drawn here, the pacer only sets the speed
+		pacer.BeginFrame();
+		while (console.GetFrameCount() < options.numFrames)
+		{
+			uint64_t frameCount = console.GetFrameCount();
+			console.RunFrame();
+
+			// a debugger break returns part way through a frame, the frame ends when it completes
+			if (console.GetFrameCount() != frameCount)
+			{
+				if (options.audioFile != nullptr)
+				{
+					const std::vector<int16_t> &samples = console.GetApu().GetSamples();
+					console.GetApu().SetRateAdjust(audio.Push(samples.data(), samples.size()));
+				}
+
+				pacer.EndFrame();
+				pacer.BeginFrame();
+			}
+
+			if (debugger.IsBreakPending())
+			{
+				PrintDebugHit(console, debugger);
+				if (!options.breakContinue)
+					break;
+				debugger.Resume();
+			}
+		}
+	}
+
+	console.SetDebugger(nullptr);
+	console.SetHeatmap(nullptr);
+
+	bool audioOk = audio.Stop();
+
+	// includes waiting for the trace writer to catch up
+	bool traceOk = tracer.Close();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	printf("%llu %s frames, %llu cycles in %.3f seconds (%.2f MHz)\n", (unsigned long long)console.GetFrameCount(), Region::Name,
+		(unsigned long long)cpu.GetCycles(), seconds, seconds > 0.0 ? cpu.GetCycles() / seconds / 1000000.0 : 0.0);
+	if (cpu.GetFusedCount() != 0)
+		printf("%llu instruction pairs fused\n", (unsigned long long)cpu.GetFusedCount());
+
+	if (options.traceFile != nullptr)
+	{
+		if (!traceOk)
+		{
+			printf("failed to write %s\n", options.traceFile);
+			return 1;
+		}
+		printf("%llu instructions traced, %.1f MB -> %s\n", (unsigned long long)tracer.GetEntryCount(),
+			tracer.GetBytesWritten() / (1024.0 * 1024.0), options.traceFile);
+	}
+
+	if (options.pacing != PACING_UNTHROTTLED)
+		printf("%llu frames not drawn\n", (unsigned long long)pacer.GetSkippedFrames());
+
+	if (options.audioFile != nullptr)
+	{
+		if (!audioOk)
+		{
+			printf("failed to write %s\n", options.audioFile);
+			return 1;
+		}
+		printf("audio: latency %.1f ms average, %.1f ms max, %llu samples of underrun, %llu dropped, rate ratio %.4f -> %s\n",
+			audio.GetAverageLatencyMs(), audio.GetMaxLatencyMs(), (unsigned long long)audio.GetUnderrunSamples(),
+			(unsigned long long)audio.GetDroppedSamples(), audio.GetLastRatio(), options.audioFile);
+	}
+
+	if (options.hashFile != nullptr)
+	{
+		if (!hashLog.Save(options.hashFile))
+		{
+			printf("failed to write %s\n", options.hashFile);
+			return 1;
+		}
+		printf("%u state hashes -> %s\n", (unsigned int)hashLog.GetEntries().size(), options.hashFile);
+	}
+
+	if (options.heatmapFile != nullptr)
+	{
+		std::string prefix = options.heatmapFile;
+		std::string files[3] = { prefix + ".bin", prefix + "-cpu.ppm", prefix + "-ppu.ppm" };
+		if (!heatmap.WriteBinary(files[0].c_str()) || !heatmap.WriteCpuPpm(files[1].c_str(), false) || !heatmap.WritePpuPpm(files[2].c_str(), false))
+		{
+			printf("failed to write %s.*\n", options.heatmapFile);
+			return 1;
+		}
+
+		heatmap.WriteReport(stdout);
+		printf("heatmaps -> %s, %s, %s\n", files[0].c_str(), files[1].c_str(), files[2].c_str());
+	}
+
+#if NES_CPU_PROFILER
+	profiler.WriteReport(stdout);
+	if (!profiler.WriteCsv(options.profileCsvFile))
+		printf("failed to write %s\n", options.profileCsvFile);
+
+	if (debugInfo.IsLoaded())
+	{
+		Cc65SourceProfile sourceProfile;
+		sourceProfile.Build(debugInfo, profiler);
+		printf("\n");
+		sourceProfile.WriteReport(stdout, console.GetFrameCount(), NesCyclesPerFrame<Region>());
+	}
+#endif
+
+	if (options.callStackFile != nullptr)
+	{
+		if (!callStackProfiler.WriteFolded(options.callStackFile))
+		{
+			printf("failed to write %s\n", options.callStackFile);
+			return 1;
+		}
+		printf("%llu samples -> %s\n", (unsigned long long)callStackProfiler.GetTotalSamples(), options.callStackFile);
+	}
+
+	return 0;
+}
+
+//=============================================================================
+// CPU tests
+//=============================================================================
+int RunCpuTest(int argc, char **argv, const char *testFile)
+{
+	Mos6502TestOptions options;
+	options.loadAddress = (uint16_t)strtoul(CmdLineOption(argc, argv, "--load", "0"), nullptr, 16);
+	options.startPc = (int32_t)strtol(CmdLineOption(argc, argv, "--start", "-1"), nullptr, 16);
+	options.successPc = (int32_t)strtol(CmdLineOption(argc, argv, "--success", "-1"), nullptr, 16);
+	options.maxInstructions = strtoull(CmdLineOption(argc, argv, "--max-instructions", "200000000"), nullptr, 10);
+	options.decimalMode = CmdLineFlag(argc, argv, "--decimal");
+
+	Mos6502TestRunner runner;
+	if (const char *goldenLog = CmdLineOption(argc, argv, "--golden"))
+	{
+		if (!runner.LoadGoldenLog(goldenLog))
+			return 1;
+	}
+
+	Mos6502TestResult result;
+	std::string file = testFile;
+	if (file.length() >= 4 && (file.substr(file.length() - 4) == ".nes" || file.substr(file.length() - 4) == ".NES"))
+	{
+		NesCartridge rom;
+		if (!rom.LoadFromFile(testFile) || !runner.RunNesRom(rom, options, result))
+			return 1;
+	}
+	else if (!runner.RunFlatBinary(testFile, options, result))
+		return 1;
+
+	printf("%s: %s, %s\n", testFile, result.passed ? "PASS" : "FAIL", result.message.c_str());
+	printf("%llu instructions, %llu cycles in %.3f seconds (%.1f M instructions/s, %.2f MHz)\n",
+		(unsigned long long)result.instructions, (unsigned long long)result.cycles, result.seconds,
+		result.seconds > 0.0 ? result.instructions / result.seconds / 1000000.0 : 0.0,
+		result.seconds > 0.0 ? result.cycles / result.seconds / 1000000.0 : 0.0);
+
+	return result.passed ? 0 : 2;
+}
+
+//=============================================================================
+// Debugger
+//=============================================================================
+static bool ParseDebugAddress(const char *&text, uint16_t &address)
+{
+	// $C123, 0xC123 or C123
+	while (*text == ' ')
+		text++;
+	if (*text == '$')
+		text++;
+
+	char *end;
+	unsigned long value = strtoul(text, &end, 16);
+	if (end == text || value > 0xFFFF)
+		return false;
+
+	address = (uint16_t)value;
+	text = end;
+	return true;
+}
+
+static const char *DebugCondition(const char *text)
+{
+	// everything after "if", or an empty condition
+	while (*text == ' ')
+		text++;
+	return strncmp(text, "if ", 3) == 0 ? text + 3 : text;
+}
+
+bool AddDebugPoints(NesDebugger &debugger, const RunOptions &options)
+{
+	std::string error;
+
+	for (const char *breakpoint : options.breakpoints)
+	{
+		const char *text = breakpoint;
+		uint16_t address;
+		if (!ParseDebugAddress(text, address) || !debugger.AddBreakpoint(address, DebugCondition(text), error))
+		{
+			printf("bad breakpoint \"%s\": %s\n", breakpoint, error.empty() ? "expected an address" : error.c_str());
+			return false;
+		}
+	}
+
+	for (const char *watchpoint : options.watchpoints)
+	{
+		const char *text = watchpoint;
+		uint8_t kinds = 0;
+		for (; *text == 'r' || *text == 'w'; text++)
+			kinds |= *text == 'r' ? WATCH_READ : WATCH_WRITE;
+
+		uint16_t first = 0, last;
+		bool ok = kinds != 0 && ParseDebugAddress(text, first);
+		last = first;
+		if (ok && *text == '-')
+			ok = ParseDebugAddress(++text, last);
+
+		if (!ok || !debugger.AddWatchpoint(first, last, kinds, DebugCondition(text), error))
+		{
+			printf("bad watchpoint \"%s\": %s\n", watchpoint, error.empty() ? "expected r, w or rw and an address" : error.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename Region>
+void PrintDebugHit(NesConsoleT<Region> &console, NesDebugger &debugger)
+{
+	const NesDebugHit &hit = debugger.GetHit();
+	if (hit.kind == 0)
+		printf("breakpoint %u at $%04X, frame %llu\n", hit.index, hit.address, (unsigned long long)console.GetFrameCount());
+	else
+	{
+		printf("watchpoint %u: %s $%04X = $%02X by $%04X, frame %llu\n", hit.index, hit.kind == WATCH_READ ? "read" : "write",
+			hit.address, hit.value, hit.pc, (unsigned long long)console.GetFrameCount());
+	}
+
+	// registers before the breakpoint instruction, or after the instruction that hit the watchpoint
+	Mos6502TraceEntry entry;
+	console.CaptureTraceEntry(entry);
+
+	Mos6502Disassembler line(256);
+	Mos6502TraceReader::FormatNestestLine(entry, line);
+	printf("  %.*s", (int)line.GetLength(), line.GetText());
+}
+
+//=============================================================================
+// Trace export
+//=============================================================================
+int ExportTrace(const char *traceFile, const char *logFile)
+{
+	Mos6502TraceReader reader;
+	if (!reader.Open(traceFile))
+		return 1;
+
+	FILE *output = logFile != nullptr ? fopen(logFile, "wb") : stdout;
+	if (output == nullptr)
+	{
+		printf("failed to open %s for writing\n", logFile);
+		return 1;
+	}
+
+	bool ok = reader.WriteNestestLog(output);
+
+	if (output != stdout && fclose(output) != 0)
+		ok = false;
+
+	return ok ? 0 : 1;
+}
+
+//=============================================================================
+// Divergence search
+//=============================================================================
+int BisectStateHashes(const char *hashFileA, const char *hashFileB)
+{
+	NesStateHashLog a, b;
+	if (!a.Load(hashFileA) || !b.Load(hashFileB))
+		return 1;
+
+	if (a.GetInstructionInterval() != b.GetInstructionInterval())
+	{
+		printf("the runs were recorded with different hash intervals (%u and %u)\n", a.GetInstructionInterval(), b.GetInstructionInterval());
+		return 1;
+	}
+
+	const std::vector<StateHashEntry> &entriesA = a.GetEntries();
+	const std::vector<StateHashEntry> &entriesB = b.GetEntries();
+	size_t index = NesStateHashLog::FindDivergence(a, b);
+
+	if (index == entriesA.size() && index == entriesB.size())
+	{
+		printf("no divergence in %u state hashes\n", (unsigned int)index);
+		return 0;
+	}
+
+	if (index == entriesA.size() || index == entriesB.size())
+	{
+		printf("the runs match for all %u hashes of the shorter run\n", (unsigned int)index);
+		return 0;
+	}
+
+	// the window starts at the last state both runs agree on
+	uint64_t firstCycle = index > 0 ? entriesA[index - 1].cycles : 0;
+	uint64_t lastCycle = std::max(entriesA[index].cycles, entriesB[index].cycles);
+	uint64_t frames = std::max(entriesA[index].frame, entriesB[index].frame) + 1;
+
+	printf("runs diverge at hash %u of %u\n", (unsigned int)index, (unsigned int)std::min(entriesA.size(), entriesB.size()));
+	if (index > 0)
+		printf("  last match:  frame %llu, cycle %llu\n", (unsigned long long)entriesA[index - 1].frame, (unsigned long long)firstCycle);
+	printf("  first diff:  frame %llu / %llu, cycle %llu / %llu\n",
+		(unsigned long long)entriesA[index].frame, (unsigned long long)entriesB[index].frame,
+		(unsigned long long)entriesA[index].cycles, (unsigned long long)entriesB[index].cycles);
+	printf("\ntrace the window with each build, then compare the traces:\n");
+	printf("  --run %llu --trace <file> --trace-from %llu --trace-to %llu\n", (unsigned long long)frames,
+		(unsigned long long)firstCycle, (unsigned long long)lastCycle);
+	printf("  --trace-diff <file> --with <file>\n");
+
+	return 2;
+}
+
+int DiffTraces(const char *traceFileA, const char *traceFileB)
+{
+	Mos6502TraceReader a, b;
+	if (!a.Open(traceFileA) || !b.Open(traceFileB))
+		return 1;
+
+	Mos6502Disassembler line(256);
+	Mos6502TraceEntry entryA, entryB, previous;
+	memset(&previous, 0, sizeof(previous));
+
+	for (uint64_t index = 0; ; index++)
+	{
+		bool hasA = a.Next(entryA);
+		bool hasB = b.Next(entryB);
+
+		// a damaged trace can not be compared past the damage
+		if (a.HasFailed() || b.HasFailed())
+		{
+			printf("%s is damaged after %llu instructions\n", a.HasFailed() ? traceFileA : traceFileB, (unsigned long long)index);
+			return 1;
+		}
+
+		if (!hasA || !hasB)
+		{
+			if (hasA != hasB)
+				printf("traces match for %llu instructions, %s is longer\n", (unsigned long long)index, hasA ? traceFileA : traceFileB);
+			else
+				printf("traces match, %llu instructions\n", (unsigned long long)index);
+			return hasA != hasB ? 2 : 0;
+		}
+
+		if (memcmp(&entryA, &entryB, sizeof(entryA)) == 0)
+		{
+			previous = entryA;
+			continue;
+		}
+
+		printf("first difference at instruction %llu\n", (unsigned long long)index);
+		if (index > 0)
+		{
+			Mos6502TraceReader::FormatNestestLine(previous, line);
+			printf("  %.*s", (int)line.GetLength(), line.GetText());
+		}
+		Mos6502TraceReader::FormatNestestLine(entryA, line);
+		printf("- %.*s", (int)line.GetLength(), line.GetText());
+		Mos6502TraceReader::FormatNestestLine(entryB, line);
+		printf("+ %.*s", (int)line.GetLength(), line.GetText());
+		return 2;
+	}
+}